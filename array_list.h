@@ -4,7 +4,8 @@
 // DATE: September, 2020
 // DESC: Implements a resizable array version of the list
 //       class. Elements are added by default to the last available
-//       index in the array.
+//       index in the array. Spare capacity is left uninitialized, so
+//       items are only constructed when they are added.
 //----------------------------------------------------------------------
 
 #ifndef ARRAY_LIST_H
@@ -14,6 +15,9 @@
 #include "linked_list.h"
 
 #include <iostream>
+#include <new>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
@@ -22,49 +26,114 @@ class ArrayList : public List<T>
 {
 public:
   ArrayList();
+  // create an empty list with room for initial_capacity items
+  explicit ArrayList(size_t initial_capacity);
   ArrayList(const ArrayList<T>& rhs);
+  ArrayList(ArrayList<T>&& rhs);
   ~ArrayList();
   ArrayList& operator=(const ArrayList<T>& rhs);
+  ArrayList& operator=(ArrayList<T>&& rhs);
 
   void add(const T& item);
+  void add(T&& item);
+  // construct a new item in place at the end of the list
+  template<typename... Args>
+  void emplace(Args&&... args);
   bool add(size_t index, const T& item);
+  bool add(size_t index, T&& item);
   bool get(size_t index, T& return_item) const;
   bool set(size_t index, const T& new_item);
   bool remove(size_t index);
   size_t size() const;
+  // access to an item without copying it (index must be valid)
+  const T& operator[](size_t index) const;
+  T& operator[](size_t index);
+  // number of items the list can hold before it must grow
+  size_t capacity() const;
+  // grow the capacity to at least new_capacity items
+  void reserve(size_t new_capacity);
+  // release any spare capacity
+  void shrink_to_fit();
+  // capacity multiplier used when the list is full (must be > 1)
+  void set_growth_factor(double factor);
   void selection_sort();
   void insertion_sort();
+  // stable, merges through one scratch buffer allocated per call
   void merge_sort();
   void quick_sort();
+  void heap_sort();
+  // quick sort with ninther (median of medians) pivots that finishes
+  // short ranges with insertion sort and falls back to heap sort if
+  // partitioning goes badly, so it is O(n log n) in the worst case
+  void intro_sort();
+  // sorts with intro_sort
   void sort();
+  // intro sorts thread_count slices at once and then merges them in
+  // parallel rounds (0 threads = one per hardware thread); each thread
+  // is given at least sequential_cutoff items, so short lists are just
+  // intro sorted on the calling thread
+  void parallel_sort(size_t thread_count = 0,
+                     size_t sequential_cutoff = PARALLEL_SORT_CUTOFF);
   
   // helper functions for merge and quick sort
   void merge_sort(size_t start, size_t end);
   void quick_sort(size_t start, size_t end);
 
 
+  // default fewest items per thread for parallel_sort
+  static const size_t PARALLEL_SORT_CUTOFF = 8192;
+
 private:
   T* items;
-  size_t capacity;
+  size_t allocated; // number of item slots in the array
   size_t length; // Equivalent to the indexes + 1
+  double growth_factor;
 
-  // helper to resize items array
+  // helper to grow the items array when it is full
   void resize();
+  // helper to move the items into a new array of the given capacity
+  void reallocate(size_t new_capacity);
+  // helper to destroy every item and free the array
+  void release();
+  // helper shared by the add at index functions
+  template<typename U>
+  bool insert(size_t index, U&& item);
+
+  // ranges this short are insertion sorted by intro and merge sort
+  static const size_t INSERTION_SORT_CUTOFF = 16;
+  // ranges longer than this use a ninther rather than median of three
+  static const size_t NINTHER_THRESHOLD = 128;
+  // sort helpers, ranges are [start, end)
+  void insertion_sort(size_t start, size_t end);
+  void merge_sort(size_t start, size_t end, T* buffer);
+  void merge(size_t start, size_t mid, size_t end, T* buffer);
+  void heap_sort(size_t start, size_t end);
+  void sift_down(size_t start, size_t root, size_t count);
+  void intro_sort(size_t start, size_t end, size_t depth_limit);
+  void sort3(size_t a, size_t b, size_t c);
+  size_t partition(size_t start, size_t end);
 };
 
 
 template<typename T>
 ArrayList<T>::ArrayList()
-  : capacity(10), length(0)
+  : items(nullptr), allocated(0), length(0), growth_factor(2.0)
 {
-  items = new T[capacity];
-  
+  // the array is allocated by the first add
+}
+
+
+template<typename T>
+ArrayList<T>::ArrayList(size_t initial_capacity)
+  : items(nullptr), allocated(0), length(0), growth_factor(2.0)
+{
+  reserve(initial_capacity);
 }
 
 
 template<typename T>
 ArrayList<T>::ArrayList(const ArrayList<T>& rhs)
-  : capacity(10), length(0), items(nullptr)
+  : items(nullptr), allocated(0), length(0), growth_factor(rhs.growth_factor)
 {
   // defer to assignment operator
   *this = rhs;
@@ -72,11 +141,23 @@ ArrayList<T>::ArrayList(const ArrayList<T>& rhs)
 }
 
 
+template<typename T>
+ArrayList<T>::ArrayList(ArrayList<T>&& rhs)
+  : items(rhs.items), allocated(rhs.allocated), length(rhs.length),
+    growth_factor(rhs.growth_factor)
+{
+  // take rhs's array and leave it empty
+  rhs.allocated = 0;
+  rhs.length = 0;
+  rhs.items = nullptr;
+}
+
+
 template<typename T> 
 ArrayList<T>::~ArrayList()
 {
 	// Deletes the entire array
-	delete [] items;
+	release();
 }
 
 
@@ -85,60 +166,95 @@ ArrayList<T>& ArrayList<T>::operator=(const ArrayList<T>& rhs)
 {
 	
 	if (this != &rhs) { // protects against self-assignment case
-	  length = 0;
-	  delete [] items;
-	  capacity = rhs.capacity;
-	  length = rhs.length;
-	  items = new T[capacity];
+	  release();
+	  reserve(rhs.length);
 	  
-	  // Fill array with elements from rhs
+	  // Copy construct the elements from rhs into the new array
 	  for (size_t i = 0; i < rhs.length; i++) {
-			items[i] = rhs.items[i];
+			new (items + i) T(rhs.items[i]);
 	  }
-	// Assign the new memory to the object
+	  length = rhs.length;
+	  growth_factor = rhs.growth_factor;
 	}
 	
 	return *this;
 }
 
+template<typename T>
+ArrayList<T>& ArrayList<T>::operator=(ArrayList<T>&& rhs)
+{
+	if (this != &rhs) { // protects against self-assignment case
+	  // Give our array to rhs (to free) and take its array
+	  std::swap(items, rhs.items);
+	  std::swap(allocated, rhs.allocated);
+	  std::swap(length, rhs.length);
+	  std::swap(growth_factor, rhs.growth_factor);
+	}
+	return *this;
+}
+
 template<typename T>
 void ArrayList<T>::add(const T& item) { 
+	emplace(item);
+}
+
+template<typename T>
+void ArrayList<T>::add(T&& item) { 
+	emplace(std::move(item));
+}
+
+template<typename T>
+template<typename... Args>
+void ArrayList<T>::emplace(Args&&... args) { 
 	// Adjusts array's occupied spaces
 	// Stores the newly added element in next open space
-	if (capacity == length) { // Max elements in the array, more room needed
+	if (allocated == length) { // Max elements in the array, more room needed
+	  // build the item first, args may refer to an item in this list
+	  T item(std::forward<Args>(args)...);
 	  resize();
+	  new (items + length) T(std::move(item));
+	}
+	else {
+	  new (items + length) T(std::forward<Args>(args)...);
 	}
-	items[length] = item;
 
 	length = length + 1;
 }
 
 template<typename T> 
 bool ArrayList<T>::add(size_t index, const T& item) {
-  if (capacity == length) { // Max elements in the array, more room needed
-	 resize();
-  }
-  
+  return insert(index, item);
+}
+
+template<typename T> 
+bool ArrayList<T>::add(size_t index, T&& item) {
+  return insert(index, std::move(item));
+}
+
+template<typename T>
+template<typename U>
+bool ArrayList<T>::insert(size_t index, U&& item) {
   if (index > length || index < 0) { // Invalid index
     return false;
   }
-  else { // Insertion of element, within the array
-    if (length == 0) {
-	  // No current elements
-	  items[0] = item;
-    }
-    else if (length == index) {
-      // Add to end case
-	 items[index] = item;
-    }
-    else {
-      for (size_t i = length; i > index; --i) { 
-	    // Leaves a space at the given index value for a new element
-	    items[i] = items[i - 1];
-	  }
-	  items[index] = item;
+  if (allocated == length) { // Max elements in the array, more room needed
+	 T new_item(std::forward<U>(item));
+	 resize();
+	 return insert(index, std::move(new_item));
+  }
+  if (index == length) {
+    // Add to end case, the slot is still unconstructed
+    new (items + length) T(std::forward<U>(item));
+  }
+  else {
+    // The last item moves into the unconstructed slot past the end
+    new (items + length) T(std::move(items[length - 1]));
+    for (size_t i = length - 1; i > index; --i) { 
+      // Leaves a space at the given index value for a new element
+      items[i] = std::move(items[i - 1]);
     }
-  }	
+    items[index] = std::forward<U>(item);
+  }
   length = length + 1;
   return true;
 }
@@ -175,10 +291,11 @@ bool ArrayList<T>:: remove(size_t index) {
 	else {
 		// Valid index number, so remove value
 		for (size_t i = index + 1; i < length; i++) {
-			items[i - 1] = items[i];
+			items[i - 1] = std::move(items[i]);
 		}
 		// Re-evaluate the size of the array
 		length = length - 1;
+		items[length].~T();
 		return true;
 	}
 }
@@ -190,27 +307,95 @@ size_t ArrayList<T>:: size() const {
 }
 
 
+template<typename T>
+const T& ArrayList<T>::operator[](size_t index) const {
+  return items[index];
+}
+
+
+template<typename T>
+T& ArrayList<T>::operator[](size_t index) {
+  return items[index];
+}
+
+
+template<typename T>
+size_t ArrayList<T>::capacity() const {
+  return allocated;
+}
+
+
+template<typename T>
+void ArrayList<T>::reserve(size_t new_capacity) {
+  if (new_capacity > allocated) {
+    reallocate(new_capacity);
+  }
+}
+
+
+template<typename T>
+void ArrayList<T>::shrink_to_fit() {
+  if (length < allocated) {
+    reallocate(length);
+  }
+}
+
+
+template<typename T>
+void ArrayList<T>::set_growth_factor(double factor) {
+  if (factor > 1.0) {
+    growth_factor = factor;
+  }
+}
+
+
 template<typename T>
 void ArrayList<T>:: resize() {
-  // Creates new array of double capacity, and storing the items
-  T * newArr = new T[capacity * 2];
+  // Grows the array by the growth factor (by at least one item)
+  size_t new_capacity = allocated * growth_factor;
+  if (new_capacity < 10) {
+    new_capacity = 10;
+  }
+  else if (new_capacity <= allocated) {
+    new_capacity = allocated + 1;
+  }
+  reallocate(new_capacity);
+}
+
+
+template<typename T>
+void ArrayList<T>::reallocate(size_t new_capacity) {
+  // Raw storage, items are only constructed as they are added
+  T * newArr = nullptr;
+  if (new_capacity > 0) {
+    newArr = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+  }
   for (size_t i = 0; i < length; i++) {
-    newArr[i] = items[i];
+    new (newArr + i) T(std::move(items[i]));
+    items[i].~T();
   }
   // Deleting the old array
-  delete [] items;
+  ::operator delete(items);
   // Resetting the capacity
-  capacity = capacity * 2;
-  // Creating a new array with the new capacity
-  items = new T[capacity];
-  // Readding the array values
+  allocated = new_capacity;
   items = newArr;
 }
+
+
+template<typename T>
+void ArrayList<T>::release() {
+  for (size_t i = 0; i < length; i++) {
+    items[i].~T();
+  }
+  ::operator delete(items);
+  items = nullptr;
+  allocated = 0;
+  length = 0;
+}
 		
 template<typename T> 
 void ArrayList<T>::selection_sort() {
 	
-  T temp;
   int index = 0;
   for (int j = 0; j < length - 1; j++) {
 	// Outerloop which places the minimum at the front of the sorted portion
@@ -225,9 +410,7 @@ void ArrayList<T>::selection_sort() {
 		  }
 	  }
 	  // Swap the min element and first element in unsorted portion
-      temp = items[j];
-      items[j] = items[index];
-      items[index] = temp;
+      std::swap(items[j], items[index]);
     }
 	else {
 	  // Case of getting out of range in the performance tests
@@ -238,25 +421,15 @@ void ArrayList<T>::selection_sort() {
 
 template<typename T> 
 void ArrayList<T>::insertion_sort() {
-	T tmpT;
-	size_t i;
-	for (size_t j = 1; j < length; ++j) {
-		// Outerloop which always is the first element of the unsorted region
-		i = j; // resets inner loop to the beginning of unsorted region
-		while (items[i - 1] > items[i] && i > 0) {
-			// Inner loop swaps with elements in sorted region until no the element is sorted
-			tmpT = items[i];
-			items[i] = items[i - 1];
-			items[i - 1] = tmpT;
-			--i;
-		}
-	}
+	insertion_sort(0, length);
 }	
 
 template<typename T>
 void ArrayList<T>::merge_sort() {
-	size_t i = 0, k = length - 1;
-	merge_sort(i, k);
+	if (length <= 1) {
+	  return;
+	}
+	merge_sort(0, length - 1);
 	
 }
 
@@ -269,59 +442,256 @@ void ArrayList<T>::quick_sort() {
 	quick_sort(i, k);
 }
 
+template<typename T>
+void ArrayList<T>::heap_sort() {
+	heap_sort(0, length);
+}
+
+template<typename T>
+void ArrayList<T>::intro_sort() {
+	// Allow 2 log2(n) levels of partitioning before giving up on quick sort
+	size_t depth_limit = 0;
+	for (size_t n = length; n > 1; n = n / 2) {
+	  depth_limit += 2;
+	}
+	intro_sort(0, length, depth_limit);
+}
+
+template<typename T>
+void ArrayList<T>::parallel_sort(size_t thread_count, size_t sequential_cutoff) {
+	if (thread_count == 0) {
+	  thread_count = std::thread::hardware_concurrency();
+	}
+	if (sequential_cutoff == 0) {
+	  sequential_cutoff = 1;
+	}
+	size_t runs = length / sequential_cutoff;
+	if (runs > thread_count) {
+	  runs = thread_count;
+	}
+	if (runs <= 1) {
+	  intro_sort();
+	  return;
+	}
+	size_t depth_limit = 0;
+	for (size_t n = length / runs; n > 1; n = n / 2) {
+	  depth_limit += 2;
+	}
+	// Slice i is [bounds[i], bounds[i+1]); every slice is sorted by its own thread
+	size_t * bounds = new size_t[runs + 1];
+	for (size_t i = 0; i <= runs; ++i) {
+	  bounds[i] = length * i / runs;
+	}
+	std::thread * workers = new std::thread[runs];
+	for (size_t i = 0; i < runs; ++i) {
+	  workers[i] = std::thread([this, bounds, i, depth_limit]() {
+	    intro_sort(bounds[i], bounds[i + 1], depth_limit);
+	  });
+	}
+	for (size_t i = 0; i < runs; ++i) {
+	  workers[i].join();
+	}
+	// Merge neighboring slices pairwise, each merge of a round on its own
+	// thread, through disjoint parts of one shared scratch buffer
+	T * buffer = static_cast<T*>(::operator new(length * sizeof(T)));
+	for (size_t width = 1; width < runs; width = width * 2) {
+	  size_t merges = 0;
+	  for (size_t i = 0; i + width < runs; i += 2 * width) {
+	    size_t start = bounds[i], mid = bounds[i + width];
+	    size_t end = bounds[i + 2 * width < runs ? i + 2 * width : runs];
+	    workers[merges] = std::thread([this, start, mid, end, buffer]() {
+	      merge(start, mid, end, buffer + start);
+	    });
+	    ++merges;
+	  }
+	  for (size_t i = 0; i < merges; ++i) {
+	    workers[i].join();
+	  }
+	}
+	::operator delete(buffer);
+	delete [] workers;
+	delete [] bounds;
+}
+
 template<typename T>
 void ArrayList<T>::merge_sort(size_t start, size_t end) {
-	size_t mid = 0;
+	if (start >= end || end >= length) {
+	  return;
+	}
+	// One raw scratch buffer shared by every merge
+	T * buffer = static_cast<T*>(::operator new((end - start + 1) * sizeof(T)));
+	merge_sort(start, end + 1, buffer);
+	::operator delete(buffer);
+}
 
-	if (start < end) {
-		mid = (start + end) / 2; // Finds the midpoint in the partition
-	
-		// Recursively sort left and right partitions
-		merge_sort(start, mid);
-		merge_sort(mid + 1, end);
-		
-		// Merge left and right partition in sorted order
-		size_t mergedSize = end - start + 1; // Size of merged partition
-		size_t mergePos = 0; // Position to insert merged items
-		size_t leftPos = 0; // Position of elements in left partition
-		size_t rightPos = 0; // Position of elements in right partition
-		
-		T * mergedItems = new T[mergedSize]; // Dynamic temp array 
-		
-		leftPos = start; // Initialize left partition to beginning of list
-		rightPos = mid + 1; // Initialize right partition position to beginning
-		
-		// Add smallest element from left or right partition to merged numebrs
-		while (leftPos <= mid && rightPos <= end) { 
-			if (items[leftPos] <= items[rightPos]) {
-				mergedItems[mergePos] = items[leftPos]; // Adding to left
-				++leftPos;
-			}
-			else {
-				mergedItems[mergePos] = items[rightPos]; // Adding to right
-				++rightPos;
-			}
-			++mergePos;
-		}
-		
-		// If the left partition is not empty, add remaining elements to merged items
-		while (leftPos <= mid) {
-			mergedItems[mergePos] = items[leftPos];
-			++leftPos;
-			++mergePos;
+template<typename T>
+void ArrayList<T>::insertion_sort(size_t start, size_t end) {
+	for (size_t j = start + 1; j < end; ++j) {
+		// Outerloop which always is the first element of the unsorted region
+		if (!(items[j] < items[j - 1])) {
+		  continue;
 		}
-		
-		// If right partition is not empty, add remaining elements to merged numbers
-		while (rightPos <= end) {
-			mergedItems[mergePos] = items[rightPos];
+		// Shift larger sorted items right and drop the item into the hole
+		T tmpT = std::move(items[j]);
+		size_t i = j;
+		do {
+		  items[i] = std::move(items[i - 1]);
+		  --i;
+		} while (i > start && tmpT < items[i - 1]);
+		items[i] = std::move(tmpT);
+	}
+}
+
+template<typename T>
+void ArrayList<T>::merge_sort(size_t start, size_t end, T* buffer) {
+	if (end - start <= INSERTION_SORT_CUTOFF) {
+	  // insertion sort is stable too, and faster on short ranges
+	  insertion_sort(start, end);
+	  return;
+	}
+	size_t mid = start + (end - start) / 2; // Finds the midpoint in the partition
+	
+	// Recursively sort left and right partitions
+	merge_sort(start, mid, buffer);
+	merge_sort(mid, end, buffer);
+	merge(start, mid, end, buffer);
+}
+
+template<typename T>
+void ArrayList<T>::merge(size_t start, size_t mid, size_t end, T* buffer) {
+	if (start == mid || mid == end || !(items[mid] < items[mid - 1])) {
+	  // Partitions are already in order
+	  return;
+	}
+	
+	// Merge left and right partition in sorted order into the buffer,
+	// taking from the left on ties to keep the sort stable
+	size_t mergePos = 0, leftPos = start, rightPos = mid;
+	while (leftPos < mid && rightPos < end) { 
+		if (items[rightPos] < items[leftPos]) {
+			new (buffer + mergePos) T(std::move(items[rightPos]));
 			++rightPos;
-			++mergePos;
 		}
-		// Copy merge items back into the regular array
-		for (mergePos = 0; mergePos < mergedSize; ++mergePos) {
-			items[start + mergePos] = mergedItems[mergePos];
+		else {
+			new (buffer + mergePos) T(std::move(items[leftPos]));
+			++leftPos;
 		}
+		++mergePos;
+	}
+	while (leftPos < mid) {
+		new (buffer + mergePos) T(std::move(items[leftPos]));
+		++leftPos;
+		++mergePos;
+	}
+	// Anything left in the right partition is already in place
+	for (size_t i = 0; i < mergePos; ++i) {
+		items[start + i] = std::move(buffer[i]);
+		buffer[i].~T();
+	}
+}
+
+template<typename T>
+void ArrayList<T>::heap_sort(size_t start, size_t end) {
+	size_t count = end - start;
+	// Build a max heap, then repeatedly move its root to the back
+	for (size_t i = count / 2; i > 0; --i) {
+	  sift_down(start, i - 1, count);
+	}
+	for (size_t i = count; i > 1; --i) {
+	  std::swap(items[start], items[start + i - 1]);
+	  sift_down(start, 0, i - 1);
+	}
+}
+
+template<typename T>
+void ArrayList<T>::sift_down(size_t start, size_t root, size_t count) {
+	T value = std::move(items[start + root]);
+	size_t child = 2 * root + 1;
+	while (child < count) {
+	  if (child + 1 < count && items[start + child] < items[start + child + 1]) {
+	    // Larger of the two children
+	    ++child;
+	  }
+	  if (!(value < items[start + child])) {
+	    break;
+	  }
+	  items[start + root] = std::move(items[start + child]);
+	  root = child;
+	  child = 2 * root + 1;
+	}
+	items[start + root] = std::move(value);
+}
+
+template<typename T>
+void ArrayList<T>::intro_sort(size_t start, size_t end, size_t depth_limit) {
+	while (end - start > INSERTION_SORT_CUTOFF) {
+	  if (depth_limit == 0) {
+	    // Too many unbalanced partitions, heap sort is O(n log n) always
+	    heap_sort(start, end);
+	    return;
+	  }
+	  --depth_limit;
+	  size_t mid = partition(start, end);
+	  // Recurse into the smaller side and loop on the larger one, which
+	  // bounds the stack depth by log2(n)
+	  if (mid - start < end - mid) {
+	    intro_sort(start, mid, depth_limit);
+	    start = mid + 1;
+	  }
+	  else {
+	    intro_sort(mid + 1, end, depth_limit);
+	    end = mid;
+	  }
+	}
+	insertion_sort(start, end);
+}
+
+template<typename T>
+void ArrayList<T>::sort3(size_t a, size_t b, size_t c) {
+	// Order items[a] <= items[b] <= items[c]
+	if (items[b] < items[a]) {
+	  std::swap(items[a], items[b]);
+	}
+	if (items[c] < items[b]) {
+	  std::swap(items[b], items[c]);
+	  if (items[b] < items[a]) {
+	    std::swap(items[a], items[b]);
+	  }
+	}
+}
+
+template<typename T>
+size_t ArrayList<T>::partition(size_t start, size_t end) {
+	// Move the pivot (median of three, or a ninther on long ranges) to start
+	size_t count = end - start, mid = start + count / 2;
+	if (count > NINTHER_THRESHOLD) {
+	  sort3(start, mid, end - 1);
+	  sort3(start + 1, mid - 1, end - 2);
+	  sort3(start + 2, mid + 1, end - 3);
+	  sort3(mid - 1, mid, mid + 1);
+	  std::swap(items[start], items[mid]);
+	}
+	else {
+	  sort3(mid, start, end - 1);
+	}
+	// Hoare partition around items[start]; both scans stop on keys equal
+	// to the pivot, which keeps runs of equal keys balanced
+	size_t left = start, right = end;
+	while (true) {
+	  do {
+	    ++left;
+	  } while (left < end && items[left] < items[start]);
+	  do {
+	    --right;
+	  } while (items[start] < items[right]);
+	  if (left >= right) {
+	    break;
+	  }
+	  std::swap(items[left], items[right]);
 	}
+	// Put the pivot between the two partitions
+	std::swap(items[start], items[right]);
+	return right;
 }
 
 template <typename T>
@@ -335,12 +705,11 @@ void ArrayList<T>::quick_sort(size_t start, size_t end) {
 	
 	// Partition data within array , value mid is returned as last element in lower partition
 	size_t pStart = 0, pEnd = 0, pMid = 0;
-	T pivot, tmp;
 	bool done = false;
 	
 	// Pick middle element as pivot
 	pMid = start + (end - start) / 2;
-	pivot = items[pMid];
+	T pivot = items[pMid];
 	
 	// Set the partition starting value and ending value
 	pStart = start;
@@ -362,9 +731,7 @@ void ArrayList<T>::quick_sort(size_t start, size_t end) {
 		}
 		else {
 			// Swap the values of items[start] and numbers[end], update start and end
-			tmp = items[pStart];
-			items[pStart] = items[pEnd];
-			items[pEnd] = tmp;
+			std::swap(items[pStart], items[pEnd]);
 			
 			++pStart;
 			--pEnd;
@@ -381,6 +748,6 @@ void ArrayList<T>::quick_sort(size_t start, size_t end) {
 
 template <typename T>
 void ArrayList<T>::sort() {
-  quick_sort();
+  intro_sort();
 }
 #endif
\ No newline at end of file
@@ -13,36 +13,65 @@
 #include "array_list.h"
 #include "linked_list.h"
 #include "collection.h"
+#include "radix_sort.h"
 
 template<typename K, typename V>
-class ArrayListCollection : public Collection<K,V>
+class ArrayListCollection final : public Collection<K,V>
 {
 public:
   void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
   void remove(const K& a_key);
   bool find(const K& search_key, V& the_val) const;
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;
+  // make room for n key-value pairs up front
+  void reserve(size_t n);
+  // iteration in list order (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
   
 private:
 	ArrayList<std::pair<K,V>> kv_list;
 
+  // cursor over the list positions
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    Cursor(const ArrayList<std::pair<K,V>>& a_list, size_t an_index)
+      : list(a_list), index(an_index) {}
+    bool valid() const { return index < list.size(); }
+    const K& key() const { return list[index].first; }
+    const V& value() const { return list[index].second; }
+    void next() { ++index; }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const ArrayList<std::pair<K,V>>& list;
+    size_t index;
+  };
+
 };
 
 template<typename K, typename V>
 void ArrayListCollection<K,V>::add(const K& a_key, const V& a_val) 
 {
-  pair<K,V> p;
-  p.first = a_key;
-  p.second = a_val;
-  kv_list.add(p);
+  COLLECTION_TIME(OP_ADD);
+  kv_list.emplace(a_key, a_val);
+}
+
+template<typename K, typename V>
+void ArrayListCollection<K,V>::add(K&& a_key, V&& a_val) 
+{
+  COLLECTION_TIME(OP_ADD);
+  kv_list.emplace(std::move(a_key), std::move(a_val));
 }
 
 template<typename K, typename V>
 void ArrayListCollection<K,V>::remove(const K& a_key) 
 {
+  COLLECTION_TIME(OP_REMOVE);
   pair<K,V> p;
   for (size_t i = 0; i < kv_list.size(); ++i) {
 	// Checking each K value in the list to see if it equals the a_key
@@ -58,6 +87,7 @@ void ArrayListCollection<K,V>::remove(const K& a_key)
 template<typename K, typename V>
 bool ArrayListCollection<K,V>::find(const K& search_key, V& the_val) const
 {
+  COLLECTION_TIME(OP_FIND);
   pair<K,V> p;
   for (size_t i = 0; i < kv_list.size(); ++i) {
 	// Traversal of the key value list
@@ -74,6 +104,7 @@ bool ArrayListCollection<K,V>::find(const K& search_key, V& the_val) const
 template<typename K, typename V>
 void ArrayListCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
+  COLLECTION_TIME(OP_FIND_RANGE);
   pair<K,V> p;	
 	
   for (size_t i = 0; i < kv_list.size(); ++i) {
@@ -98,8 +129,9 @@ void ArrayListCollection<K,V>::keys(ArrayList<K>& all_keys) const
 template<typename K, typename V>
 void ArrayListCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
-  all_keys_sorted.quick_sort();
+  sort_keys(all_keys_sorted);
 }
 
 template<typename K, typename V>
@@ -110,5 +142,30 @@ size_t ArrayListCollection<K,V>::size() const
   return array_size;
 }
 
+template<typename K, typename V>
+CollectionIterator<K,V> ArrayListCollection<K,V>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(kv_list, 0));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> ArrayListCollection<K,V>::lower_bound(const K& k) const
+{
+  // Unsorted, so every pair has to be checked against the bound
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(kv_list, 0), k, false));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> ArrayListCollection<K,V>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(kv_list, 0), k, true));
+}
+
+template<typename K, typename V>
+void ArrayListCollection<K,V>::reserve(size_t n)
+{
+  kv_list.reserve(n);
+}
+
 #endif
 	
\ No newline at end of file
@@ -12,24 +12,61 @@
 
 #include "array_list.h"
 #include "collection.h"
+#include "node_pool.h"
+#include "bulk_load.h"
+#include "tree_cursor.h"
+#include "batch.h"
 
-template<typename K, typename V>
-class AVLCollection : public Collection<K,V> 
+template<typename K, typename V, template<typename> class Alloc = HeapAllocator>
+class AVLCollection final : public Collection<K,V> 
 {
 public:
   AVLCollection();
-  AVLCollection(const AVLCollection<K,V>& rhs);
+  explicit AVLCollection(const ArrayList<std::pair<K,V>>& kv_pairs);
+  AVLCollection(const AVLCollection<K,V,Alloc>& rhs);
+  AVLCollection(AVLCollection<K,V,Alloc>&& rhs);
   ~AVLCollection();
-  AVLCollection& operator=(const AVLCollection<K,V>& rhs);
+  AVLCollection& operator=(const AVLCollection<K,V,Alloc>& rhs);
+  AVLCollection& operator=(AVLCollection<K,V,Alloc>&& rhs);
   
   void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
   void remove(const K& a_key);
   bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // call visit(key, value) for each pair with k1 <= key <= k2, in key
+  // order and without buffering; stops early once visit returns false
+  template<typename F>
+  void scan(const K& k1, const K& k2, F&& visit) const;
+  // batch operations over keys[0..n), without a virtual call per key.
+  // find_batch stores each key's value in vals[i] and whether it was
+  // found in found[i], returning the number found; its searches go down
+  // the tree together so their cache misses overlap (see batch.h)
+  void add_batch(const K* keys, const V* vals, size_t n);
+  size_t find_batch(const K* keys, size_t n, V* vals, bool* found) const;
+  void remove_batch(const K* keys, size_t n);
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;  
+  // in-order iteration over the pairs (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
   size_t height() const;
+  // order statistics, each O(log n) using the subtree sizes:
+  // number of keys less than a_key
+  size_t rank(const K& a_key) const;
+  // the i-th smallest key (counting from 0), false if i >= size()
+  bool select(size_t i, K& the_key) const;
+  // number of keys >= k1 and <= k2
+  size_t count(const K& k1, const K& k2) const;
+  // replace the contents with a balanced tree built from the pairs
+  // (linear time when the pairs are already sorted by key)
+  void bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs);
   
 private:
   // tree node
@@ -37,6 +74,8 @@ private:
     K key;
     V value;
 	int height; 
+    // number of nodes in the subtree rooted here
+    size_t subtree_size;
     Node* left;
     Node* right;
   };
@@ -44,20 +83,38 @@ private:
   Node* root;
   // number of k-v pairs stored in the collection
   size_t node_count;
+  // node allocator (HeapAllocator or NodePool)
+  Alloc<Node> node_alloc;
   // remove all elements in the bst
   void make_empty(Node* subtree_root);
+  // remove every node, handing their memory back to the allocator
+  void clear();
   // copy helper
   void copy(Node* lhs_subtree_root, const Node* rhs_subtree_root);
-  // add helper
-  Node* add(Node* subtree_root, const K& a_key, const V& a_val);
+  // add helpers, the key and value are copied or moved into the new node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  template<typename KK, typename VV>
+  Node* add(Node* subtree_root, KK&& a_key, VV&& a_val);
   // remove helper
   Node* remove(Node* subtree_root, const K& a_key);
   // helper to recursively build up key list
   void find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // scan helper, returns false once visit has asked to stop
+  template<typename F>
+  bool scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const;
   // helper to recursively build sorted list of keys
   void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
+  // bulk load helper, builds a balanced subtree from items[start, end)
+  Node* build(const std::pair<K,V>* items, size_t start, size_t end);
   // helper to recursively find height of the tree
   size_t height(const Node* subtree_root) const;
+  // number of nodes below (and including) subtree_root
+  static size_t subtree_size(const Node* subtree_root);
+  // recompute a node's height and size from its children
+  void update(Node* subtree_root);
+  // number of keys less than (or equal to, if inclusive) a_key
+  size_t rank(const K& a_key, bool inclusive) const;
   // rotate right helper
   Node* rotate_right(Node* k2);
   // rotate left helper
@@ -72,43 +129,55 @@ private:
 
 
 // Function Definitions
-template<typename K, typename V>
-AVLCollection<K,V>::AVLCollection()
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>::AVLCollection()
   : root(nullptr), node_count(0)
 {
 
 }
-template<typename K, typename V>
-AVLCollection<K,V>::AVLCollection(const AVLCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>::AVLCollection(const ArrayList<std::pair<K,V>>& kv_pairs)
+  : root(nullptr), node_count(0)
+{
+  bulk_load(kv_pairs);
+}
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>::AVLCollection(const AVLCollection<K,V,Alloc>& rhs)
   : root(nullptr), node_count(0)
 {
   // Defer to the assignment operator
   *this = rhs;
 }
-template<typename K, typename V>
-AVLCollection<K,V>::~AVLCollection()
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>::AVLCollection(AVLCollection<K,V,Alloc>&& rhs)
+  : root(nullptr), node_count(0)
 {
-  make_empty(root); 
-  root = nullptr;
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>::~AVLCollection()
+{
+  clear();
 }
-template<typename K, typename V>
-AVLCollection<K,V>& AVLCollection<K,V>::operator=(const AVLCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>& AVLCollection<K,V,Alloc>::operator=(const AVLCollection<K,V,Alloc>& rhs)
 {
   if (this != &rhs) { // protects against the self assignment case 
     node_count = 0;
 	if (root != nullptr) {
-	  make_empty(root);
-	  root = nullptr;
+	  clear();
 	}
 	// Assignment made to make the binary trees identical, with unique memory addresses
 	node_count = rhs.node_count;
 	
 	if (rhs.root != nullptr) {
 	  // Create the root node for the copy assignment
-	  root = new Node;
+	  root = node_alloc.allocate();
 	  root->key = rhs.root->key;
 	  root->value = rhs.root->value;
 	  root->height = rhs.root->height;
+	  root->subtree_size = rhs.root->subtree_size;
 	  root->left = nullptr;
 	  root->right = nullptr; 
 	  copy(root,rhs.root); 
@@ -117,36 +186,71 @@ AVLCollection<K,V>& AVLCollection<K,V>::operator=(const AVLCollection<K,V>& rhs)
   return *this; 
     
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::add(const K& a_key, const V& a_val)
+template<typename K, typename V, template<typename> class Alloc>
+AVLCollection<K,V,Alloc>& AVLCollection<K,V,Alloc>::operator=(AVLCollection<K,V,Alloc>&& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case 
+    // Empty this tree, then trade nodes (and their allocator) with rhs
+    clear();
+    std::swap(root, rhs.root);
+    std::swap(node_count, rhs.node_count);
+    node_alloc.swap(rhs.node_alloc);
+  }
+  return *this;
+}
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::add(K&& a_key, V&& a_val)
 {
+  add_impl(std::move(a_key), std::move(a_val));
+}
+template<typename K, typename V, template<typename> class Alloc>
+template<typename KK, typename VV>
+void AVLCollection<K,V,Alloc>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
   if (!root) {
 	// SPECIAL CASE: First node being added
-	Node * newNode = new Node;
-	newNode->key = a_key;
-	newNode->value = a_val;
+	Node * newNode = node_alloc.allocate();
+	newNode->key = std::forward<KK>(a_key);
+	newNode->value = std::forward<VV>(a_val);
 	newNode->right = nullptr;
 	newNode->left = nullptr;
 	newNode->height = 1;
+	newNode->subtree_size = 1;
 	++node_count;
 	root = newNode;
   }
   else {
 	// REGULAR CASE: Nodes being added to a tree with a root
-    add(root,a_key,a_val);
+    root = add(root,std::forward<KK>(a_key),std::forward<VV>(a_val));
   }
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::remove(const K& a_key)
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::remove(const K& a_key)
 {
-  remove(root,a_key); 
+  COLLECTION_TIME(OP_REMOVE);
+  root = remove(root,a_key); 
 }
-template<typename K, typename V>
-bool AVLCollection<K,V>::find(const K& search_key, V& the_val) const
+template<typename K, typename V, template<typename> class Alloc>
+bool AVLCollection<K,V,Alloc>::find(const K& search_key, V& the_val) const
 {
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename Q, typename>
+bool AVLCollection<K,V,Alloc>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
   Node * curr_ptr = root;
   
   while (curr_ptr != NULL) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
     // Search down a path in the binary tree to find the node
 	if (curr_ptr->key == search_key) {
       // Key has been located
@@ -165,37 +269,174 @@ bool AVLCollection<K,V>::find(const K& search_key, V& the_val) const
   // This point is only reached if the node searched for is not found
   return false;
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
+  COLLECTION_TIME(OP_FIND_RANGE);
   find(root,k1,k2,keys);
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::keys(ArrayList<K>& all_keys) const
 {
   keys(root,all_keys); 
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::sort(ArrayList<K>& all_keys_sorted) const
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
 }
-template<typename K, typename V>
-size_t AVLCollection<K,V>::size() const
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::size() const
 {
   return node_count;
 }	
 
-template<typename K, typename V>
-size_t AVLCollection<K,V>::height() const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::add_batch(const K* keys, const V* vals, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    add_impl(keys[i], vals[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::find_batch(const K* keys, size_t n, V* vals, bool* found) const
+{
+  return tree_find_batch(root, keys, n, vals, found);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::remove_batch(const K* keys, size_t n)
+{
+  // Each remove restructures the tree the next one searches, so these
+  // run one at a time (the qualified call skips the virtual dispatch)
+  for (size_t i = 0; i < n; ++i) {
+    AVLCollection<K,V,Alloc>::remove(keys[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::height() const
 {
   return height(root);
 }
 
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::rank(const K& a_key) const
+{
+  return rank(a_key, false);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+bool AVLCollection<K,V,Alloc>::select(size_t i, K& the_key) const
+{
+  Node * curr_ptr = root;
+  while (curr_ptr != nullptr) {
+    // The left subtree holds the smallest keys, so skip over it (and
+    // this node) when i is past them
+    size_t left_size = subtree_size(curr_ptr->left);
+    if (i < left_size) {
+      curr_ptr = curr_ptr->left;
+    }
+    else if (i == left_size) {
+      the_key = curr_ptr->key;
+      return true;
+    }
+    else {
+      i -= left_size + 1;
+      curr_ptr = curr_ptr->right;
+    }
+  }
+  // Only reached when i >= size()
+  return false;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::count(const K& k1, const K& k2) const
+{
+  if (k2 < k1) {
+    return 0;
+  }
+  // keys <= k2 minus the keys < k1
+  return rank(k2, true) - rank(k1, false);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+void AVLCollection<K,V,Alloc>::scan(const K& k1, const K& k2, F&& visit) const
+{
+  scan(root, k1, k2, visit);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+bool AVLCollection<K,V,Alloc>::scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const
+{
+  if (subtree_root == nullptr) {
+    return true;
+  }
+  // Smaller keys first, then this one, then larger keys, skipping any
+  // subtree that lies outside the range
+  if (k1 < subtree_root->key && !scan(subtree_root->left, k1, k2, visit)) {
+    return false;
+  }
+  if (!(subtree_root->key < k1) && !(k2 < subtree_root->key) &&
+      !visit(subtree_root->key, subtree_root->value)) {
+    return false;
+  }
+  if (subtree_root->key < k2) {
+    return scan(subtree_root->right, k1, k2, visit);
+  }
+  return true;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> AVLCollection<K,V,Alloc>::begin() const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> AVLCollection<K,V,Alloc>::lower_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, false));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> AVLCollection<K,V,Alloc>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, true));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs)
+{
+  clear();
+  size_t n = 0;
+  std::pair<K,V>* items = sorted_unique_pairs(kv_pairs, n);
+  root = build(items, 0, n);
+  node_count = n;
+  delete [] items;
+}
+
 // HELPER FUNCTIONS
 
-template<typename K, typename V>
-void AVLCollection<K,V>::make_empty(Node* subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::clear()
+{
+  if (!Alloc<Node>::BULK_RELEASE || !std::is_trivially_destructible<Node>::value) {
+    // Each node has to be visited to run its destructor
+    make_empty(root);
+  }
+  // A pool frees all of its slabs at once here
+  node_alloc.release();
+  root = nullptr;
+  node_count = 0;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::make_empty(Node* subtree_root)
 {
   if (!subtree_root) {
     // BASE CASE: leaf nodes hit
@@ -205,12 +446,32 @@ void AVLCollection<K,V>::make_empty(Node* subtree_root)
   make_empty(subtree_root->right); 
   subtree_root->right = nullptr;
   subtree_root->left = nullptr;
-  delete subtree_root;
+  node_alloc.deallocate(subtree_root);
   
 }
 
-template<typename K, typename V>
-void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::build(const std::pair<K,V>* items, size_t start, size_t end)
+{
+  if (start >= end) {
+    // BASE CASE: empty range
+    return nullptr;
+  }
+  // The middle pair becomes the subtree root, so the two sides differ
+  // in size (and so in height) by at most one
+  size_t mid = start + (end - start) / 2;
+  Node * newNode = node_alloc.allocate();
+  newNode->key = items[mid].first;
+  newNode->value = items[mid].second;
+  newNode->left = build(items, start, mid);
+  newNode->right = build(items, mid + 1, end);
+  update(newNode);
+  return newNode;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
 {
   if(!rhs_subtree_root) { 
     // BASE CASE: all leaf nodes hit
@@ -218,39 +479,43 @@ void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
   }
   
   if (rhs_subtree_root->left != nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->left->key;
     newNode->value = rhs_subtree_root->left->value;
 	newNode->height = rhs_subtree_root->left->height;
+	newNode->subtree_size = rhs_subtree_root->left->subtree_size;
     newNode->left = nullptr;
     newNode->right = nullptr; 
     lhs_subtree_root->left = newNode;
 	copy(lhs_subtree_root->left,rhs_subtree_root->left);
   }
   if (rhs_subtree_root->right!= nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->right->key;
     newNode->value = rhs_subtree_root->right->value;
 	newNode->height = rhs_subtree_root->right->height;
+	newNode->subtree_size = rhs_subtree_root->right->subtree_size;
     newNode->left = nullptr;
     newNode->right = nullptr; 
     lhs_subtree_root->right = newNode;
 	copy(lhs_subtree_root->right,rhs_subtree_root->right);
   }
 }
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node *
-AVLCollection<K,V>::add(Node* subtree_root, const K& a_key, const V& a_val)
+template<typename K, typename V, template<typename> class Alloc>
+template<typename KK, typename VV>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::add(Node* subtree_root, KK&& a_key, VV&& a_val)
 {
   if (!subtree_root) {
 	// Inserting new node at the lead node down a specific path
     // Create the node with a a_key and an a_val
-	Node * newNode = new Node;
-	newNode->key = a_key;
-	newNode->value = a_val;
+	Node * newNode = node_alloc.allocate();
+	newNode->key = std::forward<KK>(a_key);
+	newNode->value = std::forward<VV>(a_val);
 	newNode->right = nullptr;
 	newNode->left = nullptr;
 	newNode->height = 1;
+	newNode->subtree_size = 1;
 	++node_count;
 	return newNode;
   }
@@ -258,42 +523,21 @@ AVLCollection<K,V>::add(Node* subtree_root, const K& a_key, const V& a_val)
     // Adding some node not to the root
 	if (a_key < subtree_root->key) {
 	  // If the added key is less than the current node key then go left
-	  subtree_root->left = add(subtree_root->left,a_key,a_val);
+	  subtree_root->left = add(subtree_root->left,std::forward<KK>(a_key),std::forward<VV>(a_val));
 	}
 	else {
 	  // Otherwise the key is larger than the current node so add to the right
-	  subtree_root->right = add(subtree_root->right,a_key,a_val);
-	}
-  }
-  // Backtracking actions: add one to every node back up the path to the root
-  if (subtree_root->right && subtree_root->left) {
-    // If both subtrees exist then we check both of their heights
-	if (subtree_root->right->height == subtree_root->height || subtree_root->left->height == subtree_root->height) {
-      // If this is true then we know we need to add one to the height
-	  ++subtree_root->height;
-	}
-  }
-  else if (subtree_root->right) {
-    // Only the right subtree exists so lets check its height
-	if (subtree_root->right->height == subtree_root->height) {
-	  ++subtree_root->height;
-	}
-  }
-  else if (subtree_root->left) {
-    // Only the left subtree exists so lets check its height
-	if (subtree_root->left->height == subtree_root->height) {
-	  ++subtree_root->height;
+	  subtree_root->right = add(subtree_root->right,std::forward<KK>(a_key),std::forward<VV>(a_val));
 	}
   }
-  else {
-    // Base case of a leaf node
-	// This node has initially been given a height of 1 so we are good
-  }
+  // Backtracking actions: the new node is below, so recompute the height
+  // and size of every node back up the path to the root
+  update(subtree_root);
   return rebalance(subtree_root);
 }
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node *
-AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
+template<typename K, typename V, template<typename> class Alloc>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::remove(Node* subtree_root, const K& a_key)
 {
   Node * tmp = nullptr;
   if (subtree_root == nullptr) {
@@ -312,13 +556,13 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
   }
   else if (subtree_root != nullptr && (a_key == subtree_root->key)) {
     // The element to remove has been reached
-	if (height(subtree_root) == 1) {
+	if (!subtree_root->left && !subtree_root->right) {
 	  // CASE 1: Leaf Node
 	  if (subtree_root == root) {
 	    // Special Case of root removed
 		root = tmp;
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count;
       // Assigning value to subtree_root to get reconnected to end of tree
 	  subtree_root = tmp;
@@ -336,7 +580,7 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	  if (subtree_root == root) { 
 	    root = tmp; 
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count; 
 	  // Assigning value to subtree_root to get reconnected to end of tree
 	  subtree_root = tmp;
@@ -349,7 +593,7 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	    // Case of the root being removed
 		root = subtree_root->right;
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count;
 	  subtree_root = tmp;
 	}
@@ -358,10 +602,8 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	  // Initially go to the right
 	  tmp = subtree_root->right; 
 	  // Traverse left until the left most node is reached
-	  if (tmp == nullptr) {
-	    while (tmp->left != nullptr) {
-	      tmp = tmp->left;
-	    }
+	  while (tmp->left != nullptr) {
+	    tmp = tmp->left;
 	  }
 	  // Copy over the values of this node
 	  subtree_root->key = tmp->key;
@@ -370,40 +612,17 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	  subtree_root->right = remove(subtree_root->right,tmp->key); 
 	}
   }
-  // Backtracking actions: add one to every node back up the path to the root
-  if (!subtree_root) {
-    // Case of the deleted node, so do nothing
-  }
-  else if (subtree_root->right && subtree_root->left) {
-    // If both subtrees exist then we check both of their heights
-	if (subtree_root->right->height == subtree_root->height || subtree_root->left->height == subtree_root->height) {
-      // If this is true then we know we need to add one to the height
-	  --subtree_root->height;
-	}
-  }
-  else if (subtree_root->right) {
-    // Only the right subtree exists so lets check its height
-	if (subtree_root->right->height == subtree_root->height) {
-	  --subtree_root->height;
-	}
-  }
-  else if (subtree_root->left) {
-    // Only the left subtree exists so lets check its height
-	if (subtree_root->left->height == subtree_root->height) {
-	  --subtree_root->height;
-	}
-  }
-  else {
-    // Base case of a leaf node
-	// This is the node that is now becoming a leaf node so set the height to one
-	subtree_root->height = 1;
+  // Backtracking actions: recompute the height and size of every node
+  // back up the path to the root
+  if (subtree_root) {
+    update(subtree_root);
   }
   
   return rebalance(subtree_root);
 
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   if (!subtree_root) {
     // Empty tree base case for leaf nodes
@@ -422,8 +641,8 @@ void AVLCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2
     find(subtree_root->left,k1,k2,keys); 
   }
 }
-template<typename K, typename V>
-void AVLCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
 {
   if (!subtree_root) {
     // Base case for the leaf nodes
@@ -433,8 +652,8 @@ void AVLCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys)
   all_keys.add(subtree_root->key);
   keys(subtree_root->right,all_keys);
 }
-template<typename K, typename V>
-size_t AVLCollection<K,V>::height(const Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::height(const Node* subtree_root) const
 {
   size_t left, right;
 
@@ -448,17 +667,56 @@ size_t AVLCollection<K,V>::height(const Node* subtree_root) const
   }
 }
 
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::subtree_size(const Node* subtree_root)
+{
+  return subtree_root ? subtree_root->subtree_size : 0;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::update(Node* subtree_root)
+{
+  // Both children are already up to date, so this is O(1)
+  int left_height = subtree_root->left ? subtree_root->left->height : 0;
+  int right_height = subtree_root->right ? subtree_root->right->height : 0;
+  subtree_root->height = max(left_height, right_height) + 1;
+  subtree_root->subtree_size = subtree_size(subtree_root->left) +
+    subtree_size(subtree_root->right) + 1;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t AVLCollection<K,V,Alloc>::rank(const K& a_key, bool inclusive) const
+{
+  size_t smaller = 0;
+  Node * curr_ptr = root;
+  while (curr_ptr != nullptr) {
+    if (curr_ptr->key < a_key || (inclusive && curr_ptr->key == a_key)) {
+      // This node and its whole left subtree come before a_key
+      smaller += subtree_size(curr_ptr->left) + 1;
+      curr_ptr = curr_ptr->right;
+    }
+    else {
+      curr_ptr = curr_ptr->left;
+    }
+  }
+  return smaller;
+}
+
 
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node *
-AVLCollection<K,V>::rotate_right(Node* k2)
+template<typename K, typename V, template<typename> class Alloc>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::rotate_right(Node* k2)
 {
+  COLLECTION_COUNT(ROTATIONS, 1);
   // Placing k1 into the k2 position
   Node * k1 = k2->left;
   // Making the k2 left subtree assigned with the k1 right subtree
   k2->left = k1->right;
   // Making the k1 right subtree now everything from k2
   k1->right = k2;
+  // k2 is now below k1, so fix it first
+  update(k2);
+  update(k1);
   
   if (k2 == root) {
     // If k2 is the root then we must adjust the root to k1
@@ -468,14 +726,17 @@ AVLCollection<K,V>::rotate_right(Node* k2)
 }
 
 
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node *
-AVLCollection<K,V>::rotate_left(Node* k2)
+template<typename K, typename V, template<typename> class Alloc>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::rotate_left(Node* k2)
 {
+  COLLECTION_COUNT(ROTATIONS, 1);
   // Same exact process as the right rotation exxept on the opposite side
   Node * k1 = k2->right;
   k2->right = k1->left;
   k1->left = k2;
+  update(k2);
+  update(k1);
   
   if (k2 == root) {
     // If k2 is the root then we must adjust the root to k1
@@ -485,9 +746,9 @@ AVLCollection<K,V>::rotate_left(Node* k2)
 }
 
 
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node *
-AVLCollection<K,V>::rebalance(Node* subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+typename AVLCollection<K,V,Alloc>::Node *
+AVLCollection<K,V,Alloc>::rebalance(Node* subtree_root)
 {
   if (!subtree_root) {
     // Base Case: for the leaf nodes
@@ -514,10 +775,6 @@ AVLCollection<K,V>::rebalance(Node* subtree_root)
 	}
 	// Do rotation right no matter what
 	subtree_root = rotate_right(subtree_root);
-	// Finally adjust the height
-	subtree_root->height = height(subtree_root);
-	subtree_root->left->height = height(subtree_root->left);
-	subtree_root->right->height = height(subtree_root->right);
   }
   else if (!lptr && rptr && rptr->height > 1) {
     // SPECIAL CASE: right but no left pointer
@@ -536,10 +793,6 @@ AVLCollection<K,V>::rebalance(Node* subtree_root)
 	}
 	// Do rotation left no matter what
 	subtree_root = rotate_left(subtree_root);
-	// Adjust the height
-	subtree_root->height = height(subtree_root);
-	subtree_root->right->height = height(subtree_root->right); 
-	subtree_root->left->height = height(subtree_root->left);
   }
   else if (lptr && rptr && lptr->height > rptr->height + 1) {
     // REGULAR CASE: left and right pointer exist and subtree is left heavy
@@ -558,10 +811,6 @@ AVLCollection<K,V>::rebalance(Node* subtree_root)
 	}
 	// Do rotation right no matter what
 	subtree_root = rotate_right(subtree_root);
-	// Adjust the height
-	subtree_root->height = height(subtree_root);
-	subtree_root->left->height = height(subtree_root->left);
-	subtree_root->right->height = height(subtree_root->right); 
   }
   else if (lptr && rptr && rptr->height > lptr->height + 1) {
     // REGULAR CASE: left and right pointer exist and subtree is right heavy
@@ -580,16 +829,12 @@ AVLCollection<K,V>::rebalance(Node* subtree_root)
 	}
 	// Do rotation left no matter what
 	subtree_root = rotate_left(subtree_root);
-	// Adjust the height
-	subtree_root->height = height(subtree_root);
-	subtree_root->right->height = height(subtree_root->right); 
-	subtree_root->left->height = height(subtree_root->left);
   }
   return subtree_root;
 }
 
-template<typename K, typename V>
-void AVLCollection<K,V>::print_tree(std::string indent, Node* subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+void AVLCollection<K,V,Alloc>::print_tree(std::string indent, Node* subtree_root)
 {
   if (!subtree_root) {
     return;
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------
+// FILE: batch.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Helpers shared by the batch (many keys per call) operations.
+//  A lookup spends most of its time waiting on cache misses, one per
+//  bucket or tree node. Working on a group of keys at once lets us ask
+//  for the memory each key needs next (a prefetch) and then work on the
+//  other keys while it arrives, instead of waiting on each miss in turn.
+//----------------------------------------------------------------------
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+
+
+// number of keys whose memory accesses are overlapped at a time
+const size_t BATCH_WIDTH = 16;
+
+
+// hint that addr will be read (or written, if for_write) soon
+inline void prefetch(const void* addr, bool for_write = false)
+{
+#ifdef __GNUC__
+  if (for_write) {
+    __builtin_prefetch(addr, 1);
+  }
+  else {
+    __builtin_prefetch(addr, 0);
+  }
+#else
+  (void) addr;
+  (void) for_write;
+#endif
+}
+
+
+// Find each of keys[0..n) in the binary search tree at root, storing
+// the value in vals[i] and whether it was there in found[i]. Returns
+// the number of keys found. The searches for BATCH_WIDTH keys go down
+// the tree together, one level per round, prefetching the next node of
+// each search so the rounds overlap their cache misses. Node needs
+// key, value, left, and right members.
+template<typename K, typename V, typename Node>
+size_t tree_find_batch(const Node* root, const K* keys, size_t n, V* vals, bool* found)
+{
+  size_t found_count = 0;
+  const Node* ptrs[BATCH_WIDTH];
+  for (size_t start = 0; start < n; start += BATCH_WIDTH) {
+    size_t width = n - start < BATCH_WIDTH ? n - start : BATCH_WIDTH;
+    for (size_t j = 0; j < width; ++j) {
+      ptrs[j] = root;
+      found[start + j] = false;
+    }
+    // each round moves every unfinished search down one level
+    size_t active = width;
+    while (active > 0) {
+      active = 0;
+      for (size_t j = 0; j < width; ++j) {
+        const Node* ptr = ptrs[j];
+        if (ptr == nullptr) {
+          continue;
+        }
+        const K& key = keys[start + j];
+        if (key < ptr->key) {
+          ptr = ptr->left;
+        }
+        else if (ptr->key < key) {
+          ptr = ptr->right;
+        }
+        else {
+          // found, so this search is done
+          vals[start + j] = ptr->value;
+          found[start + j] = true;
+          ++found_count;
+          ptr = nullptr;
+        }
+        if (ptr != nullptr) {
+          prefetch(ptr);
+          ++active;
+        }
+        ptrs[j] = ptr;
+      }
+    }
+  }
+  return found_count;
+}
+
+
+#endif
@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------
+// FILE: benchmark.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Benchmark harness for the performance tests. A single
+//  operation is often shorter than the clock can resolve, so each
+//  sample times a batch of operations (the batch size is calibrated
+//  until a sample takes long enough to measure). After some warm-up
+//  samples, samples are taken until the 95% confidence interval of the
+//  mean is within a set fraction of it (or a sample or time limit is
+//  hit), and the mean, median, 99th percentile, standard deviation, and
+//  throughput of the per-operation times are reported.
+//----------------------------------------------------------------------
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdint.h>
+#include "array_list.h"
+
+
+// per-operation statistics over the samples, times in nanoseconds
+struct BenchmarkResult
+{
+  double mean = 0;
+  double median = 0;
+  double p99 = 0;
+  double stddev = 0;
+  double ops_per_sec = 0;
+  // half width of the 95% confidence interval of the mean
+  double ci = 0;
+  size_t samples = 0;
+  // operations timed per sample
+  size_t batch = 0;
+};
+
+
+class Benchmark
+{
+public:
+  // sampling stops once the confidence interval is within rel_error of
+  // the mean (but not before min_samples), or at max_samples, or once
+  // time_limit seconds have been spent sampling
+  explicit Benchmark(double rel_error = 0.02, size_t min_samples = 10,
+                     size_t max_samples = 1000, double time_limit = 0.25,
+                     size_t warm_up = 3);
+
+  // Time op(i), for i = 0 to batch-1, as one sample, with batch at
+  // most max_batch. reset() runs (untimed) after every sample, to put
+  // back whatever the operations changed.
+  template<typename Op, typename Reset>
+  BenchmarkResult run(Op op, Reset reset, size_t max_batch) const;
+
+  // for operations that change nothing
+  template<typename Op>
+  BenchmarkResult run(Op op, size_t max_batch) const;
+
+  // nanoseconds on the monotonic clock
+  static uint64_t now();
+
+private:
+  // shortest sample (in nanoseconds) the batch size is grown to reach
+  static const uint64_t MIN_SAMPLE = 100000;
+
+  double rel_error;
+  size_t min_samples;
+  size_t max_samples;
+  double time_limit;
+  size_t warm_up;
+
+  // two-sided 95% Student's t value for a sample of size n
+  static double t_value(size_t n);
+
+  // fill in the statistics for the (per-operation) sample times
+  static BenchmarkResult summarize(ArrayList<double>& times, size_t batch);
+};
+
+
+inline Benchmark::Benchmark(double rel_error, size_t min_samples, size_t max_samples,
+                            double time_limit, size_t warm_up)
+  : rel_error(rel_error), min_samples(min_samples < 2 ? 2 : min_samples),
+    max_samples(max_samples), time_limit(time_limit), warm_up(warm_up)
+{
+}
+
+inline uint64_t Benchmark::now()
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+template<typename Op, typename Reset>
+BenchmarkResult Benchmark::run(Op op, Reset reset, size_t max_batch) const
+{
+  if (max_batch == 0) {
+    // nothing to time
+    return BenchmarkResult();
+  }
+  auto sample = [&op, &reset](size_t batch) {
+    uint64_t start = now();
+    for (size_t i = 0; i < batch; ++i) {
+      op(i);
+    }
+    uint64_t elapsed = now() - start;
+    reset();
+    return elapsed;
+  };
+  // Calibrate the batch size (these samples also warm up the caches)
+  size_t batch = 1;
+  while (batch < max_batch && sample(batch) < MIN_SAMPLE) {
+    batch = std::min(batch * 2, max_batch);
+  }
+  for (size_t i = 0; i < warm_up; ++i) {
+    sample(batch);
+  }
+  // Sample until the mean is known well enough
+  ArrayList<double> times;
+  double total = 0, total_squares = 0;
+  uint64_t deadline = now() + static_cast<uint64_t>(time_limit * 1e9);
+  while (times.size() < max_samples) {
+    double t = sample(batch) / static_cast<double>(batch);
+    times.add(t);
+    total += t;
+    total_squares += t * t;
+    size_t n = times.size();
+    if (n >= min_samples) {
+      double mean = total / n;
+      double variance = std::max(0.0, (total_squares - n * mean * mean) / (n - 1));
+      double ci = t_value(n) * std::sqrt(variance / n);
+      if (ci <= rel_error * mean || now() > deadline) {
+        break;
+      }
+    }
+  }
+  return summarize(times, batch);
+}
+
+template<typename Op>
+BenchmarkResult Benchmark::run(Op op, size_t max_batch) const
+{
+  return run(op, [] {}, max_batch);
+}
+
+inline double Benchmark::t_value(size_t n)
+{
+  // indexed by degrees of freedom (n - 1), up to 30
+  static const double T[] = {
+    0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  size_t df = n - 1;
+  return df <= 30 ? T[df] : 1.96;
+}
+
+inline BenchmarkResult Benchmark::summarize(ArrayList<double>& times, size_t batch)
+{
+  BenchmarkResult result;
+  size_t n = times.size();
+  result.samples = n;
+  result.batch = batch;
+  double total = 0;
+  for (size_t i = 0; i < n; ++i) {
+    total += times[i];
+  }
+  result.mean = total / n;
+  double squares = 0;
+  for (size_t i = 0; i < n; ++i) {
+    squares += (times[i] - result.mean) * (times[i] - result.mean);
+  }
+  result.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+  result.ci = n > 1 ? t_value(n) * result.stddev / std::sqrt(n) : 0;
+  times.sort();
+  result.median = n % 2 ? times[n/2] : (times[n/2 - 1] + times[n/2]) / 2;
+  // nearest rank
+  size_t rank = static_cast<size_t>(std::ceil(0.99 * n));
+  result.p99 = times[rank > 0 ? rank - 1 : 0];
+  result.ops_per_sec = result.mean > 0 ? 1e9 / result.mean : 0;
+  return result;
+}
+
+
+#endif
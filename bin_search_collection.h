@@ -8,35 +8,73 @@
 
 
 template<typename K, typename V>
-class BinSearchCollection : public Collection<K,V> 
+class BinSearchCollection final : public Collection<K,V> 
 {
 public:
   void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
   void remove(const K& a_key);
   bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;
+  // make room for n key-value pairs up front
+  void reserve(size_t n);
+  // iteration in ascending key order (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
 private:
   ArrayList<std::pair<K,V>> kv_list;
-  // binary search helper function
-  bool bin_search(const K& key, size_t& index) const;
+  // cursor over the (sorted) list positions
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    Cursor(const ArrayList<std::pair<K,V>>& a_list, size_t an_index)
+      : list(a_list), index(an_index) {}
+    bool valid() const { return index < list.size(); }
+    const K& key() const { return list[index].first; }
+    const V& value() const { return list[index].second; }
+    void next() { ++index; }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const ArrayList<std::pair<K,V>>& list;
+    size_t index;
+  };
+  // add helper that copies or moves the key and value into the list
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // binary search helper function (reads pairs in place, no copies)
+  template<typename Q>
+  bool bin_search(const Q& key, size_t& index) const;
 };
 
 template<typename K, typename V>
 void BinSearchCollection<K,V>::add(const K& a_key, const V& a_val)
 {
-  pair<K,V> p;
+  add_impl(a_key, a_val);
+}
+template<typename K, typename V>
+void BinSearchCollection<K,V>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+template<typename K, typename V>
+template<typename KK, typename VV>
+void BinSearchCollection<K,V>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
   size_t index;
   bool found;
   
   found = bin_search(a_key,index);
-  p.first = a_key;
-  p.second = a_val;
   
   if (found == false) {
-    kv_list.add(index,p);
+    kv_list.add(index,pair<K,V>(std::forward<KK>(a_key),std::forward<VV>(a_val)));
   }
   else {
     // Key already there, do nothing
@@ -45,6 +83,7 @@ void BinSearchCollection<K,V>::add(const K& a_key, const V& a_val)
 template<typename K, typename V>
 void BinSearchCollection<K,V>::remove(const K& a_key)
 {
+  COLLECTION_TIME(OP_REMOVE);
   size_t index;
   bool found;
   
@@ -59,9 +98,16 @@ void BinSearchCollection<K,V>::remove(const K& a_key)
   }
 }
 template<typename K, typename V>
-bool BinSearchCollection<K,V>::find(const K& search_key, V& the_val) const 
+bool BinSearchCollection<K,V>::find(const K& search_key, V& the_val) const
 {
-  pair<K,V> p;
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V>
+template<typename Q, typename>
+bool BinSearchCollection<K,V>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
   size_t index;
   bool found;
   
@@ -69,8 +115,7 @@ bool BinSearchCollection<K,V>::find(const K& search_key, V& the_val) const
   
   if (found == true) {
     // Element is found
-	kv_list.get(index,p);
-	the_val = p.second;
+	the_val = kv_list[index].second;
 	return true;
   }
   else {
@@ -81,6 +126,7 @@ bool BinSearchCollection<K,V>::find(const K& search_key, V& the_val) const
 template<typename K, typename V>
 void BinSearchCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const 
 {
+  COLLECTION_TIME(OP_FIND_RANGE);
   pair<K,V> p;
   size_t index;
   
@@ -106,6 +152,7 @@ void BinSearchCollection<K,V>::keys(ArrayList<K>& all_keys) const
 template<typename K, typename V>
 void BinSearchCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const 
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
 }
 template<typename K, typename V>
@@ -115,22 +162,53 @@ size_t BinSearchCollection<K,V>::size() const
   array_size = kv_list.size();
   return array_size;
 }
+
 template<typename K, typename V>
-bool BinSearchCollection<K,V>::bin_search(const K& key, size_t& index) const
+CollectionIterator<K,V> BinSearchCollection<K,V>::begin() const
 {
-  size_t left = 0, right = kv_list.size() - 1;
-  pair<K,V> p;
-  index = (right + left) / 2;
-  kv_list.get(index,p);
-  
-  if (right == -1) {
+  return CollectionIterator<K,V>(new Cursor(kv_list, 0));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> BinSearchCollection<K,V>::lower_bound(const K& k) const
+{
+  // bin_search leaves index at the key or where it would be added
+  size_t index;
+  bin_search(k, index);
+  return CollectionIterator<K,V>(new Cursor(kv_list, index));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> BinSearchCollection<K,V>::upper_bound(const K& k) const
+{
+  size_t index;
+  if (bin_search(k, index)) {
+    ++index;
+  }
+  return CollectionIterator<K,V>(new Cursor(kv_list, index));
+}
+
+template<typename K, typename V>
+void BinSearchCollection<K,V>::reserve(size_t n)
+{
+  kv_list.reserve(n);
+}
+template<typename K, typename V>
+template<typename Q>
+bool BinSearchCollection<K,V>::bin_search(const Q& key, size_t& index) const
+{
+  if (kv_list.size() == 0) {
     // No elements in the list 
 	index = 0;
 	return false;
   }
-  while (p.first != key && right != left) {
+  size_t left = 0, right = kv_list.size() - 1;
+  index = (right + left) / 2;
+  const K* curr_key = &kv_list[index].first;
+  
+  while (*curr_key != key && right != left) {
 	// Runs until index is at the value
-    if (key < p.first) {
+    if (key < *curr_key) {
       // Key pair is greater than current position
 	  right = index;
     }
@@ -139,14 +217,14 @@ bool BinSearchCollection<K,V>::bin_search(const K& key, size_t& index) const
 	  left = index + 1;
 	}
 	index = (right + left) / 2;
-    kv_list.get(index,p);
+    curr_key = &kv_list[index].first;
   }
   
-  if (p.first == key) {
+  if (*curr_key == key) {
     // Found the key
 	return true;
   }
-  else if (key > p.first) {
+  else if (key > *curr_key) {
     // No key found, so set position to the right
 	index = index + 1;
 	return false;
@@ -0,0 +1,815 @@
+//----------------------------------------------------------------------
+// FILE: bplus_tree_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: B+ tree implementation of the key-value collection. Nodes are
+//  wide (by default the keys of a node span about four cache lines), all
+//  key-value pairs live in the leaves, and the leaves are linked
+//  together in key order. A range search is one descent to the leaf
+//  holding k1 followed by a sequential scan along the leaves, and
+//  sorting is a walk across the leaf level.
+//----------------------------------------------------------------------
+
+#ifndef BPLUS_TREE_COLLECTION_H
+#define BPLUS_TREE_COLLECTION_H
+
+#include "array_list.h"
+#include "collection.h"
+
+
+template<typename K, typename V,
+         size_t ORDER = (256 / sizeof(K) < 4 ? 4 : 256 / sizeof(K))>
+class BPlusTreeCollection final : public Collection<K,V>
+{
+public:
+  BPlusTreeCollection();
+  BPlusTreeCollection(const BPlusTreeCollection<K,V,ORDER>& rhs);
+  BPlusTreeCollection(BPlusTreeCollection<K,V,ORDER>&& rhs);
+  ~BPlusTreeCollection();
+  BPlusTreeCollection& operator=(const BPlusTreeCollection<K,V,ORDER>& rhs);
+  BPlusTreeCollection& operator=(BPlusTreeCollection<K,V,ORDER>&& rhs);
+
+  void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
+  void remove(const K& a_key);
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // call visit(key, value) for each pair with k1 <= key <= k2, in key
+  // order and without buffering; stops early once visit returns false
+  template<typename F>
+  void scan(const K& k1, const K& k2, F&& visit) const;
+  void keys(ArrayList<K>& all_keys) const;
+  void sort(ArrayList<K>& all_keys_sorted) const;
+  size_t size() const;
+  // number of levels in the tree (0 if empty)
+  size_t height() const;
+  // iteration along the leaf level, in ascending key order (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+  // for testing: check key order, node fill, and the leaf links
+  bool valid_bplus_tree() const;
+
+private:
+  // common part of the leaf and interior nodes
+  struct Node {
+    bool leaf;
+    size_t count;
+    K keys[ORDER];
+  };
+  // leaves hold the values and link to their neighbors
+  struct Leaf : Node {
+    V values[ORDER];
+    Leaf* prev;
+    Leaf* next;
+  };
+  // interior node keys[i] is the smallest key in children[i+1]
+  struct Inner : Node {
+    Node* children[ORDER + 1];
+  };
+
+  // root node of the tree
+  Node* root;
+  // number of k-v pairs stored in the collection
+  size_t node_count;
+
+  // node constructors
+  Leaf* new_leaf();
+  Inner* new_inner();
+  // remove all nodes in the subtree
+  void make_empty(Node* subtree_root);
+  // copy helper (prev_leaf threads the leaf links in key order)
+  Node* copy(const Node* rhs_subtree_root, Leaf*& prev_leaf);
+  // add helpers, the key and value are copied or moved into a leaf
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // returns the new right sibling if subtree_root split
+  template<typename KK, typename VV>
+  Node* add(Node* subtree_root, KK&& a_key, VV&& a_val, K& split_key);
+  // remove helper, returns true if a key was removed
+  bool remove(Node* subtree_root, const K& a_key);
+  // refill children[index] of parent after it dropped below min_keys
+  void rebalance(Inner* parent, size_t index);
+  // leaf that would hold the key
+  template<typename Q>
+  const Leaf* find_leaf(const Q& key) const;
+  // leftmost leaf
+  const Leaf* first_leaf() const;
+  // fewest keys allowed in a non-root node (an interior node splits
+  // around the key it pushes up, so it can end up one key lighter)
+  static size_t min_keys(const Node* node);
+  // index of the first key >= key
+  template<typename Q>
+  static size_t lower_bound(const Node* node, const Q& key);
+  // index of the first key > key (the child to descend into)
+  template<typename Q>
+  static size_t upper_bound(const Node* node, const Q& key);
+  // validate helper
+  bool valid_bplus_tree(const Node* subtree_root, size_t depth, size_t& leaf_depth,
+                        const K* low, const K* high) const;
+
+  // cursor over a leaf's slots, following the links between leaves
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    Cursor(const Leaf* a_leaf, size_t an_index)
+      : leaf(a_leaf), index(an_index) { skip_to_key(); }
+    bool valid() const { return leaf != nullptr; }
+    const K& key() const { return leaf->keys[index]; }
+    const V& value() const { return leaf->values[index]; }
+    void next() { ++index; skip_to_key(); }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const Leaf* leaf;
+    size_t index;
+    // step to the next leaf when past the end of this one
+    void skip_to_key() {
+      while (leaf != nullptr && index >= leaf->count) {
+        leaf = leaf->next;
+        index = 0;
+      }
+    }
+  };
+};
+
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>::BPlusTreeCollection()
+  : root(nullptr), node_count(0)
+{
+}
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>::BPlusTreeCollection(const BPlusTreeCollection<K,V,ORDER>& rhs)
+  : root(nullptr), node_count(0)
+{
+  // Defer to the assignment operator
+  *this = rhs;
+}
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>::BPlusTreeCollection(BPlusTreeCollection<K,V,ORDER>&& rhs)
+  : root(nullptr), node_count(0)
+{
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>::~BPlusTreeCollection()
+{
+  make_empty(root);
+  root = nullptr;
+}
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>&
+BPlusTreeCollection<K,V,ORDER>::operator=(const BPlusTreeCollection<K,V,ORDER>& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case
+    make_empty(root);
+    root = nullptr;
+    Leaf* prev_leaf = nullptr;
+    if (rhs.root != nullptr) {
+      root = copy(rhs.root, prev_leaf);
+    }
+    node_count = rhs.node_count;
+  }
+  return *this;
+}
+
+template<typename K, typename V, size_t ORDER>
+BPlusTreeCollection<K,V,ORDER>&
+BPlusTreeCollection<K,V,ORDER>::operator=(BPlusTreeCollection<K,V,ORDER>&& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case
+    // Trade nodes with rhs, which then frees ours
+    std::swap(root, rhs.root);
+    std::swap(node_count, rhs.node_count);
+  }
+  return *this;
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename KK, typename VV>
+void BPlusTreeCollection<K,V,ORDER>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  if (!root) {
+    // SPECIAL CASE: First pair goes into a single leaf
+    root = new_leaf();
+  }
+  K split_key;
+  Node* right = add(root, std::forward<KK>(a_key), std::forward<VV>(a_val), split_key);
+  if (right) {
+    // The root split, so the tree grows a level
+    Inner* new_root = new_inner();
+    new_root->count = 1;
+    new_root->keys[0] = std::move(split_key);
+    new_root->children[0] = root;
+    new_root->children[1] = right;
+    root = new_root;
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  if (!root || !remove(root, a_key)) {
+    // Key not found, so do nothing
+    return;
+  }
+  if (root->count == 0) {
+    if (root->leaf) {
+      // Removed the last pair
+      delete static_cast<Leaf*>(root);
+      root = nullptr;
+    }
+    else {
+      // The root's only child becomes the new root
+      Inner* old_root = static_cast<Inner*>(root);
+      root = old_root->children[0];
+      delete old_root;
+    }
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+bool BPlusTreeCollection<K,V,ORDER>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename Q, typename>
+bool BPlusTreeCollection<K,V,ORDER>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  const Leaf* leaf = find_leaf(search_key);
+  if (!leaf) {
+    return false;
+  }
+  size_t i = lower_bound(leaf, search_key);
+  if (i < leaf->count && leaf->keys[i] == search_key) {
+    // Key has been located
+    the_val = leaf->values[i];
+    return true;
+  }
+  return false;
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  // One descent to the first candidate, then scan the linked leaves
+  const Leaf* leaf = find_leaf(k1);
+  if (!leaf) {
+    return;
+  }
+  size_t i = lower_bound(leaf, k1);
+  while (leaf) {
+    for (; i < leaf->count; ++i) {
+      if (leaf->keys[i] > k2) {
+        return;
+      }
+      keys.add(leaf->keys[i]);
+    }
+    leaf = leaf->next;
+    i = 0;
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::keys(ArrayList<K>& all_keys) const
+{
+  for (const Leaf* leaf = first_leaf(); leaf; leaf = leaf->next) {
+    for (size_t i = 0; i < leaf->count; ++i) {
+      all_keys.add(leaf->keys[i]);
+    }
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  // The leaf level is already in order
+  keys(all_keys_sorted);
+}
+
+template<typename K, typename V, size_t ORDER>
+size_t BPlusTreeCollection<K,V,ORDER>::size() const
+{
+  return node_count;
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename F>
+void BPlusTreeCollection<K,V,ORDER>::scan(const K& k1, const K& k2, F&& visit) const
+{
+  // Same walk as the range find, handing each pair to visit instead
+  const Leaf* leaf = find_leaf(k1);
+  if (!leaf) {
+    return;
+  }
+  size_t i = lower_bound(leaf, k1);
+  while (leaf) {
+    for (; i < leaf->count; ++i) {
+      if (k2 < leaf->keys[i] || !visit(leaf->keys[i], leaf->values[i])) {
+        return;
+      }
+    }
+    leaf = leaf->next;
+    i = 0;
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+CollectionIterator<K,V> BPlusTreeCollection<K,V,ORDER>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(first_leaf(), 0));
+}
+
+template<typename K, typename V, size_t ORDER>
+CollectionIterator<K,V> BPlusTreeCollection<K,V,ORDER>::lower_bound(const K& k) const
+{
+  // The first key >= k is in k's leaf or (if past its end) the next one
+  const Leaf* leaf = find_leaf(k);
+  return CollectionIterator<K,V>(new Cursor(leaf, leaf ? lower_bound(leaf, k) : 0));
+}
+
+template<typename K, typename V, size_t ORDER>
+CollectionIterator<K,V> BPlusTreeCollection<K,V,ORDER>::upper_bound(const K& k) const
+{
+  const Leaf* leaf = find_leaf(k);
+  return CollectionIterator<K,V>(new Cursor(leaf, leaf ? upper_bound(leaf, k) : 0));
+}
+
+template<typename K, typename V, size_t ORDER>
+size_t BPlusTreeCollection<K,V,ORDER>::height() const
+{
+  // Every leaf is at the same depth, so follow the leftmost path
+  size_t levels = 0;
+  for (const Node* node = root; node; ++levels) {
+    node = node->leaf ? nullptr : static_cast<const Inner*>(node)->children[0];
+  }
+  return levels;
+}
+
+template<typename K, typename V, size_t ORDER>
+bool BPlusTreeCollection<K,V,ORDER>::valid_bplus_tree() const
+{
+  if (!root) {
+    return node_count == 0;
+  }
+  size_t leaf_depth = 0;
+  if (!valid_bplus_tree(root, 1, leaf_depth, nullptr, nullptr)) {
+    return false;
+  }
+  // The leaf chain must visit every pair in ascending order
+  size_t count = 0;
+  const Leaf* prev = nullptr;
+  for (const Leaf* leaf = first_leaf(); leaf; leaf = leaf->next) {
+    if (leaf->prev != prev) {
+      return false;
+    }
+    for (size_t i = 0; i < leaf->count; ++i) {
+      if (count > 0 && i == 0 && !(prev->keys[prev->count - 1] < leaf->keys[0])) {
+        return false;
+      }
+      ++count;
+    }
+    prev = leaf;
+  }
+  return count == node_count;
+}
+
+
+// HELPER FUNCTIONS
+
+template<typename K, typename V, size_t ORDER>
+typename BPlusTreeCollection<K,V,ORDER>::Leaf*
+BPlusTreeCollection<K,V,ORDER>::new_leaf()
+{
+  Leaf* leaf = new Leaf;
+  leaf->leaf = true;
+  leaf->count = 0;
+  leaf->prev = nullptr;
+  leaf->next = nullptr;
+  return leaf;
+}
+
+template<typename K, typename V, size_t ORDER>
+typename BPlusTreeCollection<K,V,ORDER>::Inner*
+BPlusTreeCollection<K,V,ORDER>::new_inner()
+{
+  Inner* inner = new Inner;
+  inner->leaf = false;
+  inner->count = 0;
+  return inner;
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::make_empty(Node* subtree_root)
+{
+  if (!subtree_root) {
+    // BASE CASE
+    return;
+  }
+  if (subtree_root->leaf) {
+    delete static_cast<Leaf*>(subtree_root);
+    return;
+  }
+  Inner* inner = static_cast<Inner*>(subtree_root);
+  for (size_t i = 0; i <= inner->count; ++i) {
+    make_empty(inner->children[i]);
+  }
+  delete inner;
+}
+
+template<typename K, typename V, size_t ORDER>
+typename BPlusTreeCollection<K,V,ORDER>::Node*
+BPlusTreeCollection<K,V,ORDER>::copy(const Node* rhs_subtree_root, Leaf*& prev_leaf)
+{
+  if (rhs_subtree_root->leaf) {
+    const Leaf* rhs_leaf = static_cast<const Leaf*>(rhs_subtree_root);
+    Leaf* leaf = new_leaf();
+    leaf->count = rhs_leaf->count;
+    for (size_t i = 0; i < rhs_leaf->count; ++i) {
+      leaf->keys[i] = rhs_leaf->keys[i];
+      leaf->values[i] = rhs_leaf->values[i];
+    }
+    // Leaves are copied left to right, so link to the previous one
+    leaf->prev = prev_leaf;
+    if (prev_leaf) {
+      prev_leaf->next = leaf;
+    }
+    prev_leaf = leaf;
+    return leaf;
+  }
+  const Inner* rhs_inner = static_cast<const Inner*>(rhs_subtree_root);
+  Inner* inner = new_inner();
+  inner->count = rhs_inner->count;
+  for (size_t i = 0; i < rhs_inner->count; ++i) {
+    inner->keys[i] = rhs_inner->keys[i];
+  }
+  for (size_t i = 0; i <= rhs_inner->count; ++i) {
+    inner->children[i] = copy(rhs_inner->children[i], prev_leaf);
+  }
+  return inner;
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename KK, typename VV>
+typename BPlusTreeCollection<K,V,ORDER>::Node*
+BPlusTreeCollection<K,V,ORDER>::add(Node* subtree_root, KK&& a_key, VV&& a_val, K& split_key)
+{
+  if (subtree_root->leaf) {
+    Leaf* leaf = static_cast<Leaf*>(subtree_root);
+    size_t pos = lower_bound(leaf, a_key);
+    if (pos < leaf->count && leaf->keys[pos] == a_key) {
+      // Key already exists in the tree.. so do nothing
+      return nullptr;
+    }
+    Leaf* right = nullptr;
+    if (leaf->count == ORDER) {
+      // Full leaf: move the upper half into a new right sibling
+      right = new_leaf();
+      size_t mid = ORDER / 2;
+      for (size_t i = mid; i < ORDER; ++i) {
+        right->keys[i - mid] = std::move(leaf->keys[i]);
+        right->values[i - mid] = std::move(leaf->values[i]);
+      }
+      right->count = ORDER - mid;
+      leaf->count = mid;
+      right->next = leaf->next;
+      if (right->next) {
+        right->next->prev = right;
+      }
+      right->prev = leaf;
+      leaf->next = right;
+      if (pos > mid) {
+        // The new pair belongs in the right half
+        leaf = right;
+        pos = pos - mid;
+      }
+    }
+    // Shift larger keys over to make room
+    for (size_t i = leaf->count; i > pos; --i) {
+      leaf->keys[i] = std::move(leaf->keys[i - 1]);
+      leaf->values[i] = std::move(leaf->values[i - 1]);
+    }
+    leaf->keys[pos] = std::forward<KK>(a_key);
+    leaf->values[pos] = std::forward<VV>(a_val);
+    ++leaf->count;
+    ++node_count;
+    if (right) {
+      split_key = right->keys[0];
+    }
+    return right;
+  }
+
+  Inner* inner = static_cast<Inner*>(subtree_root);
+  size_t pos = upper_bound(inner, a_key);
+  K child_split_key;
+  Node* child_right = add(inner->children[pos], std::forward<KK>(a_key), std::forward<VV>(a_val), child_split_key);
+  if (!child_right) {
+    return nullptr;
+  }
+  Inner* right = nullptr;
+  if (inner->count == ORDER) {
+    // Full interior node: keys[mid] moves up, the rest is split
+    right = new_inner();
+    size_t mid = ORDER / 2;
+    split_key = std::move(inner->keys[mid]);
+    for (size_t i = mid + 1; i < ORDER; ++i) {
+      right->keys[i - mid - 1] = std::move(inner->keys[i]);
+    }
+    for (size_t i = mid + 1; i <= ORDER; ++i) {
+      right->children[i - mid - 1] = inner->children[i];
+    }
+    right->count = ORDER - mid - 1;
+    inner->count = mid;
+    if (pos > mid) {
+      // The child that split is now in the right half
+      inner = right;
+      pos = pos - mid - 1;
+    }
+  }
+  // Insert the child's separator and new sibling after the child
+  for (size_t i = inner->count; i > pos; --i) {
+    inner->keys[i] = std::move(inner->keys[i - 1]);
+    inner->children[i + 1] = inner->children[i];
+  }
+  inner->keys[pos] = std::move(child_split_key);
+  inner->children[pos + 1] = child_right;
+  ++inner->count;
+  return right;
+}
+
+template<typename K, typename V, size_t ORDER>
+bool BPlusTreeCollection<K,V,ORDER>::remove(Node* subtree_root, const K& a_key)
+{
+  if (subtree_root->leaf) {
+    Leaf* leaf = static_cast<Leaf*>(subtree_root);
+    size_t pos = lower_bound(leaf, a_key);
+    if (pos == leaf->count || !(leaf->keys[pos] == a_key)) {
+      return false;
+    }
+    for (size_t i = pos + 1; i < leaf->count; ++i) {
+      leaf->keys[i - 1] = leaf->keys[i];
+      leaf->values[i - 1] = leaf->values[i];
+    }
+    --leaf->count;
+    --node_count;
+    return true;
+  }
+  Inner* inner = static_cast<Inner*>(subtree_root);
+  size_t pos = upper_bound(inner, a_key);
+  if (!remove(inner->children[pos], a_key)) {
+    return false;
+  }
+  if (inner->children[pos]->count < min_keys(inner->children[pos])) {
+    rebalance(inner, pos);
+  }
+  return true;
+}
+
+template<typename K, typename V, size_t ORDER>
+void BPlusTreeCollection<K,V,ORDER>::rebalance(Inner* parent, size_t index)
+{
+  Node* child = parent->children[index];
+  Node* left = index > 0 ? parent->children[index - 1] : nullptr;
+  Node* right = index < parent->count ? parent->children[index + 1] : nullptr;
+
+  if (child->leaf) {
+    Leaf* leaf = static_cast<Leaf*>(child);
+    if (left && left->count > min_keys(left)) {
+      // CASE 1: Borrow the largest pair of the left sibling
+      Leaf* sibling = static_cast<Leaf*>(left);
+      for (size_t i = leaf->count; i > 0; --i) {
+        leaf->keys[i] = leaf->keys[i - 1];
+        leaf->values[i] = leaf->values[i - 1];
+      }
+      leaf->keys[0] = sibling->keys[sibling->count - 1];
+      leaf->values[0] = sibling->values[sibling->count - 1];
+      ++leaf->count;
+      --sibling->count;
+      parent->keys[index - 1] = leaf->keys[0];
+    }
+    else if (right && right->count > min_keys(right)) {
+      // CASE 2: Borrow the smallest pair of the right sibling
+      Leaf* sibling = static_cast<Leaf*>(right);
+      leaf->keys[leaf->count] = sibling->keys[0];
+      leaf->values[leaf->count] = sibling->values[0];
+      ++leaf->count;
+      for (size_t i = 1; i < sibling->count; ++i) {
+        sibling->keys[i - 1] = sibling->keys[i];
+        sibling->values[i - 1] = sibling->values[i];
+      }
+      --sibling->count;
+      parent->keys[index] = sibling->keys[0];
+    }
+    else {
+      // CASE 3: Merge with a sibling (always right into left)
+      if (left) {
+        leaf = static_cast<Leaf*>(left);
+        --index;
+      }
+      Leaf* victim = static_cast<Leaf*>(parent->children[index + 1]);
+      for (size_t i = 0; i < victim->count; ++i) {
+        leaf->keys[leaf->count + i] = victim->keys[i];
+        leaf->values[leaf->count + i] = victim->values[i];
+      }
+      leaf->count += victim->count;
+      leaf->next = victim->next;
+      if (leaf->next) {
+        leaf->next->prev = leaf;
+      }
+      delete victim;
+      // Drop the separator and the merged child from the parent
+      for (size_t i = index + 1; i < parent->count; ++i) {
+        parent->keys[i - 1] = parent->keys[i];
+        parent->children[i] = parent->children[i + 1];
+      }
+      --parent->count;
+    }
+    return;
+  }
+
+  Inner* inner = static_cast<Inner*>(child);
+  if (left && left->count > min_keys(left)) {
+    // CASE 1: Rotate the left sibling's last child through the parent
+    Inner* sibling = static_cast<Inner*>(left);
+    for (size_t i = inner->count; i > 0; --i) {
+      inner->keys[i] = inner->keys[i - 1];
+    }
+    for (size_t i = inner->count + 1; i > 0; --i) {
+      inner->children[i] = inner->children[i - 1];
+    }
+    inner->keys[0] = parent->keys[index - 1];
+    inner->children[0] = sibling->children[sibling->count];
+    ++inner->count;
+    parent->keys[index - 1] = sibling->keys[sibling->count - 1];
+    --sibling->count;
+  }
+  else if (right && right->count > min_keys(right)) {
+    // CASE 2: Rotate the right sibling's first child through the parent
+    Inner* sibling = static_cast<Inner*>(right);
+    inner->keys[inner->count] = parent->keys[index];
+    inner->children[inner->count + 1] = sibling->children[0];
+    ++inner->count;
+    parent->keys[index] = sibling->keys[0];
+    for (size_t i = 1; i < sibling->count; ++i) {
+      sibling->keys[i - 1] = sibling->keys[i];
+    }
+    for (size_t i = 1; i <= sibling->count; ++i) {
+      sibling->children[i - 1] = sibling->children[i];
+    }
+    --sibling->count;
+  }
+  else {
+    // CASE 3: Merge with a sibling, pulling the separator down
+    if (left) {
+      inner = static_cast<Inner*>(left);
+      --index;
+    }
+    Inner* victim = static_cast<Inner*>(parent->children[index + 1]);
+    inner->keys[inner->count] = parent->keys[index];
+    for (size_t i = 0; i < victim->count; ++i) {
+      inner->keys[inner->count + 1 + i] = victim->keys[i];
+    }
+    for (size_t i = 0; i <= victim->count; ++i) {
+      inner->children[inner->count + 1 + i] = victim->children[i];
+    }
+    inner->count += victim->count + 1;
+    delete victim;
+    for (size_t i = index + 1; i < parent->count; ++i) {
+      parent->keys[i - 1] = parent->keys[i];
+      parent->children[i] = parent->children[i + 1];
+    }
+    --parent->count;
+  }
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename Q>
+const typename BPlusTreeCollection<K,V,ORDER>::Leaf*
+BPlusTreeCollection<K,V,ORDER>::find_leaf(const Q& key) const
+{
+  const Node* node = root;
+  while (node && !node->leaf) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
+    const Inner* inner = static_cast<const Inner*>(node);
+    node = inner->children[upper_bound(inner, key)];
+  }
+  return static_cast<const Leaf*>(node);
+}
+
+template<typename K, typename V, size_t ORDER>
+const typename BPlusTreeCollection<K,V,ORDER>::Leaf*
+BPlusTreeCollection<K,V,ORDER>::first_leaf() const
+{
+  const Node* node = root;
+  while (node && !node->leaf) {
+    node = static_cast<const Inner*>(node)->children[0];
+  }
+  return static_cast<const Leaf*>(node);
+}
+
+template<typename K, typename V, size_t ORDER>
+size_t BPlusTreeCollection<K,V,ORDER>::min_keys(const Node* node)
+{
+  return node->leaf ? ORDER / 2 : (ORDER - 1) / 2;
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename Q>
+size_t BPlusTreeCollection<K,V,ORDER>::lower_bound(const Node* node, const Q& key)
+{
+  // Binary search within the node's keys
+  size_t left = 0, right = node->count;
+  while (left < right) {
+    size_t mid = (left + right) / 2;
+    if (node->keys[mid] < key) {
+      left = mid + 1;
+    }
+    else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+template<typename K, typename V, size_t ORDER>
+template<typename Q>
+size_t BPlusTreeCollection<K,V,ORDER>::upper_bound(const Node* node, const Q& key)
+{
+  size_t left = 0, right = node->count;
+  while (left < right) {
+    size_t mid = (left + right) / 2;
+    if (key < node->keys[mid]) {
+      right = mid;
+    }
+    else {
+      left = mid + 1;
+    }
+  }
+  return left;
+}
+
+template<typename K, typename V, size_t ORDER>
+bool BPlusTreeCollection<K,V,ORDER>::valid_bplus_tree(const Node* subtree_root, size_t depth,
+                                                      size_t& leaf_depth, const K* low,
+                                                      const K* high) const
+{
+  if (subtree_root != root && subtree_root->count < min_keys(subtree_root)) {
+    return false;
+  }
+  // Keys must be ascending and within [low, high)
+  for (size_t i = 0; i < subtree_root->count; ++i) {
+    if (i > 0 && !(subtree_root->keys[i - 1] < subtree_root->keys[i])) {
+      return false;
+    }
+    if ((low && subtree_root->keys[i] < *low) || (high && !(subtree_root->keys[i] < *high))) {
+      return false;
+    }
+  }
+  if (subtree_root->leaf) {
+    // All leaves have to be at the same depth
+    if (leaf_depth == 0) {
+      leaf_depth = depth;
+    }
+    return leaf_depth == depth;
+  }
+  const Inner* inner = static_cast<const Inner*>(subtree_root);
+  for (size_t i = 0; i <= inner->count; ++i) {
+    const K* child_low = i == 0 ? low : &inner->keys[i - 1];
+    const K* child_high = i == inner->count ? high : &inner->keys[i];
+    if (!valid_bplus_tree(inner->children[i], depth + 1, leaf_depth, child_low, child_high)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+#endif
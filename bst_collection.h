@@ -10,25 +10,55 @@
 
 #include "array_list.h"
 #include "collection.h"
+#include "node_pool.h"
+#include "bulk_load.h"
+#include "tree_cursor.h"
+#include "batch.h"
 
 
-template<typename K, typename V>
-class BSTCollection : public Collection<K,V> 
+template<typename K, typename V, template<typename> class Alloc = HeapAllocator>
+class BSTCollection final : public Collection<K,V> 
 {
 public:
   BSTCollection();
-  BSTCollection(const BSTCollection<K,V>& rhs);
+  explicit BSTCollection(const ArrayList<std::pair<K,V>>& kv_pairs);
+  BSTCollection(const BSTCollection<K,V,Alloc>& rhs);
+  BSTCollection(BSTCollection<K,V,Alloc>&& rhs);
   ~BSTCollection();
-  BSTCollection& operator=(const BSTCollection<K,V>& rhs);
+  BSTCollection& operator=(const BSTCollection<K,V,Alloc>& rhs);
+  BSTCollection& operator=(BSTCollection<K,V,Alloc>&& rhs);
 
   void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
   void remove(const K& a_key);
   bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // call visit(key, value) for each pair with k1 <= key <= k2, in key
+  // order and without buffering; stops early once visit returns false
+  template<typename F>
+  void scan(const K& k1, const K& k2, F&& visit) const;
+  // batch operations over keys[0..n), without a virtual call per key.
+  // find_batch stores each key's value in vals[i] and whether it was
+  // found in found[i], returning the number found; its searches go down
+  // the tree together so their cache misses overlap (see batch.h)
+  void add_batch(const K* keys, const V* vals, size_t n);
+  size_t find_batch(const K* keys, size_t n, V* vals, bool* found) const;
+  void remove_batch(const K* keys, size_t n);
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;  
+  // in-order iteration over the pairs (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
   size_t height() const;
+  // replace the contents with a balanced tree built from the pairs
+  // (linear time when the pairs are already sorted by key)
+  void bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs);
   
 private:
   // tree node
@@ -42,56 +72,79 @@ private:
   Node* root;
   // number of k-v pairs stored in the collection
   size_t node_count;
+  // node allocator (HeapAllocator or NodePool)
+  Alloc<Node> node_alloc;
   // remove all elements in the bst
   void make_empty(Node* subtree_root);
+  // remove every node, handing their memory back to the allocator
+  void clear();
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
   // copy helper
   void copy(Node* lhs_subtree_root, const Node* rhs_subtree_root);
   // remove helper
   Node* remove(Node* subtree_root, const K& a_key);
   // helper to recursively build up key list
   void find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // scan helper, returns false once visit has asked to stop
+  template<typename F>
+  bool scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const;
   // helper to recursively build sorted list of keys
   void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
+  // bulk load helper, builds a balanced subtree from items[start, end)
+  Node* build(const std::pair<K,V>* items, size_t start, size_t end);
   // helper to recursively find height of the tree
   size_t height(const Node* subtree_root) const;
   
 };
 
 // Function Definitions
-template<typename K, typename V>
-BSTCollection<K,V>::BSTCollection()
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>::BSTCollection()
   : root(nullptr), node_count(0)
 {
 
 }
-template<typename K, typename V>
-BSTCollection<K,V>::BSTCollection(const BSTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>::BSTCollection(const ArrayList<std::pair<K,V>>& kv_pairs)
+  : root(nullptr), node_count(0)
+{
+  bulk_load(kv_pairs);
+}
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>::BSTCollection(const BSTCollection<K,V,Alloc>& rhs)
   : root(nullptr), node_count(0)
 {
   // Defer to the assignment operator
   *this = rhs;
 }
-template<typename K, typename V>
-BSTCollection<K,V>::~BSTCollection()
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>::BSTCollection(BSTCollection<K,V,Alloc>&& rhs)
+  : root(nullptr), node_count(0)
+{
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>::~BSTCollection()
 {
-  make_empty(root); 
-  root = nullptr;
+  clear();
 }
-template<typename K, typename V>
-BSTCollection<K,V>& BSTCollection<K,V>::operator=(const BSTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>& BSTCollection<K,V,Alloc>::operator=(const BSTCollection<K,V,Alloc>& rhs)
 {
   if (this != &rhs) { // protects against the self assignment case 
     node_count = 0;
 	if (root != nullptr) {
-	  make_empty(root);
-	  root = nullptr;
+	  clear();
 	}
 	// Assignment made to make the binary trees identical, with unique memory addresses
 	node_count = rhs.node_count;
 	
 	if (rhs.root != nullptr) {
 	  // Create the root node for the copy assignment
-	  root = new Node;
+	  root = node_alloc.allocate();
 	  root->key = rhs.root->key;
 	  root->value = rhs.root->value;
 	  root->left = nullptr;
@@ -102,14 +155,38 @@ BSTCollection<K,V>& BSTCollection<K,V>::operator=(const BSTCollection<K,V>& rhs)
   return *this; 
     
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::add(const K& a_key, const V& a_val)
+template<typename K, typename V, template<typename> class Alloc>
+BSTCollection<K,V,Alloc>& BSTCollection<K,V,Alloc>::operator=(BSTCollection<K,V,Alloc>&& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case 
+    // Empty this tree, then trade nodes (and their allocator) with rhs
+    clear();
+    std::swap(root, rhs.root);
+    std::swap(node_count, rhs.node_count);
+    node_alloc.swap(rhs.node_alloc);
+  }
+  return *this;
+}
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+template<typename K, typename V, template<typename> class Alloc>
+template<typename KK, typename VV>
+void BSTCollection<K,V,Alloc>::add_impl(KK&& a_key, VV&& a_val)
 {
+  COLLECTION_TIME(OP_ADD);
   // Creating the new node
   Node * curr_ptr = root;
-  Node * newNode = new Node;
-  newNode->key = a_key;
-  newNode->value = a_val;
+  Node * newNode = node_alloc.allocate();
+  newNode->key = std::forward<KK>(a_key);
+  newNode->value = std::forward<VV>(a_val);
   newNode->left = nullptr;
   newNode->right = nullptr;
 		
@@ -125,7 +202,7 @@ void BSTCollection<K,V>::add(const K& a_key, const V& a_val)
   
   // Traversing down a path to the end 
   while (curr_ptr != nullptr) {
-    if (a_key > curr_ptr->key) {
+    if (newNode->key > curr_ptr->key) {
 	  if (curr_ptr->right == nullptr) {
 	    // leaf node has been reached
 		curr_ptr->right = newNode;
@@ -135,7 +212,7 @@ void BSTCollection<K,V>::add(const K& a_key, const V& a_val)
 	  // The key value being added is larger than the current node in the list, so go right
 	  curr_ptr = curr_ptr->right;
 	}
-    else if (a_key < curr_ptr->key) {
+    else if (newNode->key < curr_ptr->key) {
 	  if (curr_ptr->left == nullptr) {
 	    // leaf node has been reached
 		curr_ptr->left = newNode;
@@ -147,21 +224,32 @@ void BSTCollection<K,V>::add(const K& a_key, const V& a_val)
 	}
 	else {
 	  // Value already exists in the list.. so do nothing
+	  node_alloc.deallocate(newNode);
 	  return;
 	}
   }
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::remove(const K& a_key)
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::remove(const K& a_key)
 {
+  COLLECTION_TIME(OP_REMOVE);
   remove(root,a_key); 
 }
-template<typename K, typename V>
-bool BSTCollection<K,V>::find(const K& search_key, V& the_val) const
+template<typename K, typename V, template<typename> class Alloc>
+bool BSTCollection<K,V,Alloc>::find(const K& search_key, V& the_val) const
 {
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename Q, typename>
+bool BSTCollection<K,V,Alloc>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
   Node * curr_ptr = root;
   
   while (curr_ptr != NULL) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
     // Search down a path in the binary tree to find the node
 	if (curr_ptr->key == search_key) {
       // Key has been located
@@ -180,37 +268,134 @@ bool BSTCollection<K,V>::find(const K& search_key, V& the_val) const
   // This point is only reached if the node searched for is not found
   return false;
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
+  COLLECTION_TIME(OP_FIND_RANGE);
   find(root,k1,k2,keys);
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::keys(ArrayList<K>& all_keys) const
 {
   keys(root,all_keys); 
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::sort(ArrayList<K>& all_keys_sorted) const
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
 }
-template<typename K, typename V>
-size_t BSTCollection<K,V>::size() const
+template<typename K, typename V, template<typename> class Alloc>
+size_t BSTCollection<K,V,Alloc>::size() const
 {
   return node_count;
 }	
 
-template<typename K, typename V>
-size_t BSTCollection<K,V>::height() const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::add_batch(const K* keys, const V* vals, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    add_impl(keys[i], vals[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t BSTCollection<K,V,Alloc>::find_batch(const K* keys, size_t n, V* vals, bool* found) const
+{
+  return tree_find_batch(root, keys, n, vals, found);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::remove_batch(const K* keys, size_t n)
+{
+  // Each remove restructures the tree the next one searches, so these
+  // run one at a time (the qualified call skips the virtual dispatch)
+  for (size_t i = 0; i < n; ++i) {
+    BSTCollection<K,V,Alloc>::remove(keys[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t BSTCollection<K,V,Alloc>::height() const
 {
   return height(root);
 }
 
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+void BSTCollection<K,V,Alloc>::scan(const K& k1, const K& k2, F&& visit) const
+{
+  scan(root, k1, k2, visit);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+bool BSTCollection<K,V,Alloc>::scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const
+{
+  if (subtree_root == nullptr) {
+    return true;
+  }
+  // Smaller keys first, then this one, then larger keys, skipping any
+  // subtree that lies outside the range
+  if (k1 < subtree_root->key && !scan(subtree_root->left, k1, k2, visit)) {
+    return false;
+  }
+  if (!(subtree_root->key < k1) && !(k2 < subtree_root->key) &&
+      !visit(subtree_root->key, subtree_root->value)) {
+    return false;
+  }
+  if (subtree_root->key < k2) {
+    return scan(subtree_root->right, k1, k2, visit);
+  }
+  return true;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> BSTCollection<K,V,Alloc>::begin() const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> BSTCollection<K,V,Alloc>::lower_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, false));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> BSTCollection<K,V,Alloc>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, true));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs)
+{
+  clear();
+  size_t n = 0;
+  std::pair<K,V>* items = sorted_unique_pairs(kv_pairs, n);
+  root = build(items, 0, n);
+  node_count = n;
+  delete [] items;
+}
+
 // HELPER FUNCTIONS
 
-template<typename K, typename V>
-void BSTCollection<K,V>::make_empty(Node* subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::clear()
+{
+  if (!Alloc<Node>::BULK_RELEASE || !std::is_trivially_destructible<Node>::value) {
+    // Each node has to be visited to run its destructor
+    make_empty(root);
+  }
+  // A pool frees all of its slabs at once here
+  node_alloc.release();
+  root = nullptr;
+  node_count = 0;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::make_empty(Node* subtree_root)
 {
   if (!subtree_root) {
     // BASE CASE
@@ -220,12 +405,30 @@ void BSTCollection<K,V>::make_empty(Node* subtree_root)
   make_empty(subtree_root->right); 
   subtree_root->right = nullptr;
   subtree_root->left = nullptr;
-  delete subtree_root;
+  node_alloc.deallocate(subtree_root);
   
 }
 
-template<typename K, typename V>
-void BSTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+typename BSTCollection<K,V,Alloc>::Node *
+BSTCollection<K,V,Alloc>::build(const std::pair<K,V>* items, size_t start, size_t end)
+{
+  if (start >= end) {
+    // BASE CASE: empty range
+    return nullptr;
+  }
+  // The middle pair becomes the subtree root so both sides are balanced
+  size_t mid = start + (end - start) / 2;
+  Node * newNode = node_alloc.allocate();
+  newNode->key = items[mid].first;
+  newNode->value = items[mid].second;
+  newNode->left = build(items, start, mid);
+  newNode->right = build(items, mid + 1, end);
+  return newNode;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
 {
   if(!rhs_subtree_root) { 
     // BASE CASE
@@ -233,7 +436,7 @@ void BSTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
   }
   
   if (rhs_subtree_root->left != nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->left->key;
     newNode->value = rhs_subtree_root->left->value;
     newNode->left = nullptr;
@@ -242,7 +445,7 @@ void BSTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
 	copy(lhs_subtree_root->left,rhs_subtree_root->left);
   }
   if (rhs_subtree_root->right!= nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->right->key;
     newNode->value = rhs_subtree_root->right->value;
     newNode->left = nullptr;
@@ -255,9 +458,9 @@ void BSTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
   
 }
 
-template<typename K, typename V>
-typename BSTCollection<K,V>::Node *
-BSTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
+template<typename K, typename V, template<typename> class Alloc>
+typename BSTCollection<K,V,Alloc>::Node *
+BSTCollection<K,V,Alloc>::remove(Node* subtree_root, const K& a_key)
 {
   Node * tmp = nullptr;
   if (subtree_root == nullptr) {
@@ -282,7 +485,7 @@ BSTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	    // Special Case of root removed
 		root = tmp;
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count;
       // Assigning value to subtree_root to get reconnected to end of tree
 	  subtree_root = tmp;
@@ -300,7 +503,7 @@ BSTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	  if (subtree_root == root) { 
 	    root = tmp; 
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count; 
 	  // Assigning value to subtree_root to get reconnected to end of tree
 	  subtree_root = tmp;
@@ -313,7 +516,7 @@ BSTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
 	    // Case of the root being removed
 		root = subtree_root->right;
 	  }
-	  delete subtree_root;
+	  node_alloc.deallocate(subtree_root);
 	  --node_count;
 	  subtree_root = tmp;
 	}
@@ -334,8 +537,8 @@ BSTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
   }
   return subtree_root;
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   if (!subtree_root) {
     // Empty tree base case
@@ -354,8 +557,8 @@ void BSTCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2
     find(subtree_root->left,k1,k2,keys); 
   }
 }
-template<typename K, typename V>
-void BSTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void BSTCollection<K,V,Alloc>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
 {
   if (!subtree_root) {
     // Base case
@@ -365,8 +568,8 @@ void BSTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys)
   all_keys.add(subtree_root->key);
   keys(subtree_root->right,all_keys);
 }
-template<typename K, typename V>
-size_t BSTCollection<K,V>::height(const Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+size_t BSTCollection<K,V,Alloc>::height(const Node* subtree_root) const
 {
   size_t left, right;
   
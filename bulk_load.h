@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------
+// FILE: bulk_load.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Helper shared by the tree bulk-load functions. Turns a list of
+//  key-value pairs into an array sorted by key with duplicate keys
+//  removed, which the trees then build from bottom-up.
+//----------------------------------------------------------------------
+
+#ifndef BULK_LOAD_H
+#define BULK_LOAD_H
+
+#include <utility>
+#include "array_list.h"
+
+
+// Returns a new array (to be deleted by the caller) holding the pairs
+// sorted by key, keeping the first pair for any repeated key. Already
+// sorted input is copied in one pass, anything else is sorted first.
+template<typename K, typename V>
+std::pair<K,V>* sorted_unique_pairs(const ArrayList<std::pair<K,V>>& kv_pairs, size_t& n)
+{
+  n = kv_pairs.size();
+  std::pair<K,V>* items = new std::pair<K,V>[n];
+  bool sorted = true;
+  for (size_t i = 0; i < n; ++i) {
+    kv_pairs.get(i, items[i]);
+    if (i > 0 && items[i].first < items[i - 1].first) {
+      sorted = false;
+    }
+  }
+  if (!sorted) {
+    // Sort (key, position) pairs so equal keys keep their original
+    // order and the first one listed wins, then reorder the items
+    ArrayList<std::pair<K,size_t>> by_key(n);
+    for (size_t i = 0; i < n; ++i) {
+      by_key.add(std::make_pair(items[i].first, i));
+    }
+    by_key.sort();
+    std::pair<K,V>* sorted_items = new std::pair<K,V>[n];
+    std::pair<K,size_t> p;
+    for (size_t i = 0; i < n; ++i) {
+      by_key.get(i, p);
+      sorted_items[i] = items[p.second];
+    }
+    delete [] items;
+    items = sorted_items;
+  }
+  // Squeeze out repeated keys
+  size_t unique = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (unique == 0 || items[unique - 1].first < items[i].first) {
+      if (unique != i) {
+        items[unique] = items[i];
+      }
+      ++unique;
+    }
+  }
+  n = unique;
+  return items;
+}
+
+
+#endif
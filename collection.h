@@ -26,7 +26,104 @@
 #ifndef COLLECTION_H
 #define COLLECTION_H
 
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include "array_list.h"
+#include "instrumentation.h"
+
+
+// true when an ordered collection keyed on K can be searched with a Q
+// directly (the heterogeneous find): Q is K, or the keys are strings
+// and Q converts to a string_view. Any other Q goes through find(const
+// K&), converting as it always has.
+template<typename K, typename Q>
+struct OrderedLookup
+  : std::integral_constant<bool, std::is_same<K, Q>::value ||
+                                 (std::is_same<K, std::string>::value &&
+                                  std::is_convertible<const Q&, std::string_view>::value)> {};
+
+
+// A position in a collection. Each collection type supplies its own
+// cursor, which reads the keys and values in place (nothing is copied).
+template<typename K, typename V>
+class CollectionCursor
+{
+public:
+  virtual ~CollectionCursor() {}
+
+  // false once the cursor has moved past the last pair
+  virtual bool valid() const = 0;
+
+  // the current pair (only while valid)
+  virtual const K& key() const = 0;
+  virtual const V& value() const = 0;
+
+  // move to the next pair
+  virtual void next() = 0;
+
+  // a new cursor at the same position
+  virtual CollectionCursor<K,V>* clone() const = 0;
+};
+
+
+// Iterator over the pairs of a collection (wraps a cursor). An
+// iterator with no cursor is the end position, and two iterators are
+// equal when both are at the end or both refer to the same stored key.
+template<typename K, typename V>
+class CollectionIterator
+{
+public:
+  // the end position
+  CollectionIterator();
+  // takes over the cursor, which may already be past the end
+  explicit CollectionIterator(CollectionCursor<K,V>* a_cursor);
+  CollectionIterator(const CollectionIterator<K,V>& rhs);
+  CollectionIterator(CollectionIterator<K,V>&& rhs);
+  ~CollectionIterator();
+  CollectionIterator& operator=(CollectionIterator<K,V> rhs);
+
+  const K& key() const;
+  const V& value() const;
+  std::pair<const K&, const V&> operator*() const;
+  CollectionIterator& operator++();
+  bool operator==(const CollectionIterator<K,V>& rhs) const;
+  bool operator!=(const CollectionIterator<K,V>& rhs) const;
+
+private:
+  // null at the end
+  CollectionCursor<K,V>* cursor;
+};
+
+
+// Cursor over the pairs of another cursor whose keys are >= bound (or
+// > bound when strict). The unsorted collections build lower_bound and
+// upper_bound from it.
+template<typename K, typename V>
+class BoundedCursor : public CollectionCursor<K,V>
+{
+public:
+  // takes over a_cursor
+  BoundedCursor(CollectionCursor<K,V>* a_cursor, const K& a_bound, bool a_strict);
+  BoundedCursor(const BoundedCursor<K,V>& rhs);
+  ~BoundedCursor();
+
+  bool valid() const;
+  const K& key() const;
+  const V& value() const;
+  void next();
+  CollectionCursor<K,V>* clone() const;
+
+private:
+  CollectionCursor<K,V>* cursor;
+  K bound;
+  bool strict;
+
+  // move the cursor forward to the next key inside the bound
+  void skip();
+  BoundedCursor& operator=(const BoundedCursor<K,V>& rhs);
+};
 
 
 template<typename K, typename V>
@@ -34,12 +131,21 @@ class Collection
 {
 public:
 
+  // the key and value types, so code templated on a collection type
+  // can name them (see static_collection.h)
+  typedef K key_type;
+  typedef V value_type;
+
   // default destructor
   virtual ~Collection() {};
   
   // add a new key-value pair into the collection 
   virtual void add(const K& a_key, const V& a_val) = 0;
 
+  // add a new key-value pair, moving the key and value into the
+  // collection instead of copying them
+  virtual void add(K&& a_key, V&& a_val) = 0;
+
   // remove a key-value pair from the collection
   virtual void remove(const K& a_key) = 0;
 
@@ -59,7 +165,179 @@ public:
   // return the number of key-value pairs in the collection
   virtual size_t size() const = 0;
 
+  // iterate over the key-value pairs without copying them. The sorted
+  // collections (binary search list and the trees) go in ascending key
+  // order, the others in storage order. Adding or removing a pair
+  // invalidates every iterator.
+  virtual CollectionIterator<K,V> begin() const = 0;
+  CollectionIterator<K,V> end() const { return CollectionIterator<K,V>(); }
+
+  // first pair with key >= k (lower_bound) or key > k (upper_bound),
+  // after which iteration continues as from begin(); unsorted
+  // collections just skip every pair outside the bound
+  virtual CollectionIterator<K,V> lower_bound(const K& k) const = 0;
+  virtual CollectionIterator<K,V> upper_bound(const K& k) const = 0;
+
+#ifdef COLLECTION_INSTRUMENTATION
+  // operation latencies and structural counters (see instrumentation.h)
+  const CollectionStats& statistics() const { return collection_stats; }
+  void reset_statistics() { collection_stats.reset(); }
+
+protected:
+  // recorded to from const operations (e.g., find) too
+  mutable CollectionStats collection_stats;
+#endif
+
 };
 
 
+template<typename K, typename V>
+CollectionIterator<K,V>::CollectionIterator()
+  : cursor(nullptr)
+{
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>::CollectionIterator(CollectionCursor<K,V>* a_cursor)
+  : cursor(a_cursor)
+{
+  if (cursor != nullptr && !cursor->valid()) {
+    // Already past the end, so this is the end position
+    delete cursor;
+    cursor = nullptr;
+  }
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>::CollectionIterator(const CollectionIterator<K,V>& rhs)
+  : cursor(rhs.cursor != nullptr ? rhs.cursor->clone() : nullptr)
+{
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>::CollectionIterator(CollectionIterator<K,V>&& rhs)
+  : cursor(rhs.cursor)
+{
+  rhs.cursor = nullptr;
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>::~CollectionIterator()
+{
+  delete cursor;
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>& CollectionIterator<K,V>::operator=(CollectionIterator<K,V> rhs)
+{
+  // rhs is already a copy (or was moved), so just trade cursors
+  std::swap(cursor, rhs.cursor);
+  return *this;
+}
+
+template<typename K, typename V>
+const K& CollectionIterator<K,V>::key() const
+{
+  return cursor->key();
+}
+
+template<typename K, typename V>
+const V& CollectionIterator<K,V>::value() const
+{
+  return cursor->value();
+}
+
+template<typename K, typename V>
+std::pair<const K&, const V&> CollectionIterator<K,V>::operator*() const
+{
+  return std::pair<const K&, const V&>(cursor->key(), cursor->value());
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V>& CollectionIterator<K,V>::operator++()
+{
+  cursor->next();
+  if (!cursor->valid()) {
+    delete cursor;
+    cursor = nullptr;
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+bool CollectionIterator<K,V>::operator==(const CollectionIterator<K,V>& rhs) const
+{
+  if (cursor == nullptr || rhs.cursor == nullptr) {
+    return cursor == rhs.cursor;
+  }
+  return &cursor->key() == &rhs.cursor->key();
+}
+
+template<typename K, typename V>
+bool CollectionIterator<K,V>::operator!=(const CollectionIterator<K,V>& rhs) const
+{
+  return !(*this == rhs);
+}
+
+
+template<typename K, typename V>
+BoundedCursor<K,V>::BoundedCursor(CollectionCursor<K,V>* a_cursor, const K& a_bound, bool a_strict)
+  : cursor(a_cursor), bound(a_bound), strict(a_strict)
+{
+  skip();
+}
+
+template<typename K, typename V>
+BoundedCursor<K,V>::BoundedCursor(const BoundedCursor<K,V>& rhs)
+  : cursor(rhs.cursor->clone()), bound(rhs.bound), strict(rhs.strict)
+{
+}
+
+template<typename K, typename V>
+BoundedCursor<K,V>::~BoundedCursor()
+{
+  delete cursor;
+}
+
+template<typename K, typename V>
+bool BoundedCursor<K,V>::valid() const
+{
+  return cursor->valid();
+}
+
+template<typename K, typename V>
+const K& BoundedCursor<K,V>::key() const
+{
+  return cursor->key();
+}
+
+template<typename K, typename V>
+const V& BoundedCursor<K,V>::value() const
+{
+  return cursor->value();
+}
+
+template<typename K, typename V>
+void BoundedCursor<K,V>::next()
+{
+  cursor->next();
+  skip();
+}
+
+template<typename K, typename V>
+CollectionCursor<K,V>* BoundedCursor<K,V>::clone() const
+{
+  return new BoundedCursor<K,V>(*this);
+}
+
+template<typename K, typename V>
+void BoundedCursor<K,V>::skip()
+{
+  while (cursor->valid() &&
+         (strict ? !(bound < cursor->key()) : cursor->key() < bound)) {
+    cursor->next();
+  }
+}
+
+
 #endif
@@ -0,0 +1,425 @@
+//----------------------------------------------------------------------
+// FILE: compact_hash_table_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Implements a chained hash table laid out for a small memory
+//  footprint. HashTableCollection allocates a node (key, value, and
+//  next pointer, plus the allocator's header) per pair, and its bucket
+//  array is an array of pointers. Here each bucket holds its first
+//  pair inline, and the rest of its chain is packed into one
+//  contiguous overflow block per bucket (grown by doubling), so there
+//  are no next pointers and only one allocation per crowded bucket.
+//  Because a chain costs no more than the pairs it holds, the table
+//  runs at a higher load (up to 3 pairs per bucket on average) than
+//  the node-based table does, which spreads the cost of the inline
+//  entries of empty buckets over more pairs.
+//----------------------------------------------------------------------
+
+#ifndef COMPACT_HASH_TABLE_COLLECTION_H
+#define COMPACT_HASH_TABLE_COLLECTION_H
+
+#include <stdint.h>
+#include "array_list.h"
+#include "collection.h"
+#include "radix_sort.h"
+#include "key_hash.h"
+
+
+// Hash and Index are the same policies HashTableCollection takes
+template<typename K, typename V, typename Hash = KeyHash<K>, typename Index = ModuloIndex>
+class CompactHashTableCollection final : public Collection<K,V>
+{
+public:
+  CompactHashTableCollection();
+  CompactHashTableCollection(const CompactHashTableCollection<K,V,Hash,Index>& rhs);
+  CompactHashTableCollection(CompactHashTableCollection<K,V,Hash,Index>&& rhs);
+  ~CompactHashTableCollection();
+  CompactHashTableCollection& operator=(const CompactHashTableCollection<K,V,Hash,Index>& rhs);
+  CompactHashTableCollection& operator=(CompactHashTableCollection<K,V,Hash,Index>&& rhs);
+
+  void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
+  void remove(const K& a_key);
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<HashedLookup<Hash,K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  void keys(ArrayList<K>& all_keys) const;
+  void sort(ArrayList<K>& all_keys_sorted) const;
+  size_t size() const;
+
+  // "statistics" functions
+
+  // number of buckets
+  size_t capacity() const;
+  size_t max_chain_length() const;
+  // bytes held by the bucket array and overflow blocks (not counting
+  // anything the keys and values themselves allocate)
+  size_t memory_bytes() const;
+
+  // iteration in bucket order (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+private:
+  struct Entry {
+    K key;
+    V value;
+  };
+
+  // the chain of a bucket is first, then overflow[0..count-1)
+  struct Bucket {
+    Entry first;
+    Entry* overflow = nullptr;
+    uint32_t count = 0;
+    uint32_t overflow_capacity = 0;
+  };
+
+  // The bucket array
+  Bucket* buckets;
+  // Number of buckets (a power of two)
+  size_t table_capacity;
+  // Number of key-value pairs stored
+  size_t length;
+  // Average chain length the table grows at
+  double load_factor_threshold = 3.0;
+
+  Hash hash_fun; // K- based hash function object
+  Index index_fun; // hash code to bucket index function object
+
+  // the ith pair of a bucket's chain
+  static Entry& entry(Bucket& bucket, size_t i);
+  static const Entry& entry(const Bucket& bucket, size_t i);
+  // add a pair to the end of a bucket's chain (no load check)
+  template<typename KK, typename VV>
+  static void append(Bucket& bucket, KK&& a_key, VV&& a_val);
+  // add helper that copies or moves the key and value into the table
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // move every pair into a new bucket array of the given capacity
+  void resize_and_rehash(size_t new_capacity);
+  // free the overflow blocks and the bucket array
+  static void make_empty(Bucket* table, size_t capacity);
+
+  // cursor over each bucket's chain in turn
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    explicit Cursor(const CompactHashTableCollection<K,V,Hash,Index>& a_table)
+      : table(a_table), index(0), i(0) { skip_empty(); }
+    bool valid() const { return index < table.table_capacity; }
+    const K& key() const { return entry(table.buckets[index], i).key; }
+    const V& value() const { return entry(table.buckets[index], i).value; }
+    void next() { ++i; skip_empty(); }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const CompactHashTableCollection<K,V,Hash,Index>& table;
+    size_t index; // bucket
+    size_t i;     // position in the bucket's chain
+    // move to the next bucket once past the end of this one's chain
+    void skip_empty() {
+      while (index < table.table_capacity && i >= table.buckets[index].count) {
+        ++index;
+        i = 0;
+      }
+    }
+  };
+};
+
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>::CompactHashTableCollection()
+  : buckets(new Bucket[16]), table_capacity(16), length(0)
+{
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>::CompactHashTableCollection(const CompactHashTableCollection<K,V,Hash,Index>& rhs)
+  : CompactHashTableCollection()
+{
+  // Defer to the assignment operator
+  *this = rhs;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>::CompactHashTableCollection(CompactHashTableCollection<K,V,Hash,Index>&& rhs)
+  : CompactHashTableCollection()
+{
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>::~CompactHashTableCollection()
+{
+  make_empty(buckets, table_capacity);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>&
+CompactHashTableCollection<K,V,Hash,Index>::operator=(const CompactHashTableCollection<K,V,Hash,Index>& rhs)
+{
+  if (this != &rhs) { // protects against self-assignment case
+    make_empty(buckets, table_capacity);
+    // Same capacity, so every chain can be copied over as it is
+    table_capacity = rhs.table_capacity;
+    buckets = new Bucket[table_capacity];
+    length = rhs.length;
+    for (size_t b = 0; b < table_capacity; ++b) {
+      for (size_t i = 0; i < rhs.buckets[b].count; ++i) {
+        const Entry& e = entry(rhs.buckets[b], i);
+        append(buckets[b], e.key, e.value);
+      }
+    }
+  }
+  return *this;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CompactHashTableCollection<K,V,Hash,Index>&
+CompactHashTableCollection<K,V,Hash,Index>::operator=(CompactHashTableCollection<K,V,Hash,Index>&& rhs)
+{
+  if (this != &rhs) { // protects against self-assignment case
+    // Trade tables with rhs, which then frees ours
+    std::swap(buckets, rhs.buckets);
+    std::swap(table_capacity, rhs.table_capacity);
+    std::swap(length, rhs.length);
+  }
+  return *this;
+}
+
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename KK, typename VV>
+void CompactHashTableCollection<K,V,Hash,Index>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  if (length + 1 > load_factor_threshold * table_capacity) {
+    // The average chain length is growing too high, so rehash
+    resize_and_rehash(table_capacity * 2);
+  }
+  Bucket& bucket = buckets[index_fun(hash_fun(a_key), table_capacity)];
+  append(bucket, std::forward<KK>(a_key), std::forward<VV>(a_val));
+  ++length;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename KK, typename VV>
+void CompactHashTableCollection<K,V,Hash,Index>::append(Bucket& bucket, KK&& a_key, VV&& a_val)
+{
+  if (bucket.count > 0 && bucket.count - 1 == bucket.overflow_capacity) {
+    // The overflow block is full, so move the chain to one twice as big
+    // (starting from a single entry, since most chains are short)
+    uint32_t new_capacity = bucket.overflow_capacity ? bucket.overflow_capacity * 2 : 1;
+    Entry* block = new Entry[new_capacity];
+    for (uint32_t i = 0; i + 1 < bucket.count; ++i) {
+      block[i] = std::move(bucket.overflow[i]);
+    }
+    delete [] bucket.overflow;
+    bucket.overflow = block;
+    bucket.overflow_capacity = new_capacity;
+  }
+  Entry& e = entry(bucket, bucket.count);
+  e.key = std::forward<KK>(a_key);
+  e.value = std::forward<VV>(a_val);
+  ++bucket.count;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  Bucket& bucket = buckets[index_fun(hash_fun(a_key), table_capacity)];
+  for (size_t i = 0; i < bucket.count; ++i) {
+    if (entry(bucket, i).key == a_key) {
+      // Order within a chain doesn't matter, so the last pair of the
+      // chain fills the hole
+      size_t last = bucket.count - 1;
+      if (i != last) {
+        entry(bucket, i) = std::move(entry(bucket, last));
+      }
+      // drop whatever the vacated entry still holds
+      entry(bucket, last) = Entry();
+      --bucket.count;
+      if (bucket.count <= 1 && bucket.overflow) {
+        // Nothing left in the overflow block
+        delete [] bucket.overflow;
+        bucket.overflow = nullptr;
+        bucket.overflow_capacity = 0;
+      }
+      --length;
+      return;
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+bool CompactHashTableCollection<K,V,Hash,Index>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename Q, typename>
+bool CompactHashTableCollection<K,V,Hash,Index>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  const Bucket& bucket = buckets[index_fun(hash_fun(search_key), table_capacity)];
+  for (size_t i = 0; i < bucket.count; ++i) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
+    const Entry& e = entry(bucket, i);
+    if (e.key == search_key) {
+      // Found the search key!
+      the_val = e.value;
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  // Check every pair of every bucket
+  for (size_t b = 0; b < table_capacity; ++b) {
+    for (size_t i = 0; i < buckets[b].count; ++i) {
+      const K& key = entry(buckets[b], i).key;
+      if (key >= k1 && key <= k2) {
+        keys.add(key);
+      }
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::keys(ArrayList<K>& all_keys) const
+{
+  for (size_t b = 0; b < table_capacity; ++b) {
+    for (size_t i = 0; i < buckets[b].count; ++i) {
+      all_keys.add(entry(buckets[b], i).key);
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  keys(all_keys_sorted);
+  sort_keys(all_keys_sorted);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t CompactHashTableCollection<K,V,Hash,Index>::size() const
+{
+  return length;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t CompactHashTableCollection<K,V,Hash,Index>::capacity() const
+{
+  return table_capacity;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t CompactHashTableCollection<K,V,Hash,Index>::max_chain_length() const
+{
+  size_t max_chain = 0;
+  for (size_t b = 0; b < table_capacity; ++b) {
+    if (buckets[b].count > max_chain) {
+      max_chain = buckets[b].count;
+    }
+  }
+  return max_chain;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t CompactHashTableCollection<K,V,Hash,Index>::memory_bytes() const
+{
+  size_t bytes = table_capacity * sizeof(Bucket);
+  for (size_t b = 0; b < table_capacity; ++b) {
+    bytes += buckets[b].overflow_capacity * sizeof(Entry);
+  }
+  return bytes;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> CompactHashTableCollection<K,V,Hash,Index>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(*this));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> CompactHashTableCollection<K,V,Hash,Index>::lower_bound(const K& k) const
+{
+  // Unordered, so every pair has to be checked against the bound
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, false));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> CompactHashTableCollection<K,V,Hash,Index>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, true));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+typename CompactHashTableCollection<K,V,Hash,Index>::Entry&
+CompactHashTableCollection<K,V,Hash,Index>::entry(Bucket& bucket, size_t i)
+{
+  return i == 0 ? bucket.first : bucket.overflow[i - 1];
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+const typename CompactHashTableCollection<K,V,Hash,Index>::Entry&
+CompactHashTableCollection<K,V,Hash,Index>::entry(const Bucket& bucket, size_t i)
+{
+  return i == 0 ? bucket.first : bucket.overflow[i - 1];
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::resize_and_rehash(size_t new_capacity)
+{
+  COLLECTION_COUNT(REHASHES, 1);
+  Bucket* old_buckets = buckets;
+  size_t old_capacity = table_capacity;
+  buckets = new Bucket[new_capacity];
+  table_capacity = new_capacity;
+  for (size_t b = 0; b < old_capacity; ++b) {
+    for (size_t i = 0; i < old_buckets[b].count; ++i) {
+      Entry& e = entry(old_buckets[b], i);
+      size_t index = index_fun(hash_fun(e.key), table_capacity);
+      append(buckets[index], std::move(e.key), std::move(e.value));
+    }
+  }
+  make_empty(old_buckets, old_capacity);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void CompactHashTableCollection<K,V,Hash,Index>::make_empty(Bucket* table, size_t capacity)
+{
+  if (table == nullptr) {
+    return;
+  }
+  for (size_t b = 0; b < capacity; ++b) {
+    delete [] table[b].overflow;
+  }
+  delete [] table;
+}
+
+
+#endif
@@ -0,0 +1,444 @@
+//----------------------------------------------------------------------
+// FILE: concurrent_hash_table_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: A chained hash table that many threads can use at once. The
+//  buckets are split into lock stripes (bucket i belongs to stripe
+//  i % stripe count), so threads working in different stripes never
+//  wait on each other and finds in the same stripe share its lock.
+//  Growing the table takes every stripe lock, in order, and relinks
+//  the nodes into a table twice as large.
+//----------------------------------------------------------------------
+
+#ifndef CONCURRENT_HASH_TABLE_COLLECTION_H
+#define CONCURRENT_HASH_TABLE_COLLECTION_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include "array_list.h"
+#include "collection.h"
+#include "key_hash.h"
+#include "radix_sort.h"
+
+
+template<typename K,typename V>
+class ConcurrentHashTableCollection final : public Collection<K,V>
+{
+public:
+  // the table starts with two buckets per stripe and always keeps a
+  // multiple of stripe_count buckets, so a key's stripe never changes
+  explicit ConcurrentHashTableCollection(size_t stripe_count = 64);
+  ~ConcurrentHashTableCollection();
+
+  void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
+  void remove(const K& a_key);
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (see KeyHash)
+  template<typename Q, typename = typename std::enable_if<HashedLookup<KeyHash<K>,K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  void keys(ArrayList<K>& all_keys) const;
+  void sort(ArrayList<K>& all_keys_sorted) const;
+  size_t size() const;
+
+  // number of buckets
+  size_t capacity() const;
+
+  // iteration in bucket order (see Collection). An iterator (and any
+  // copy of it) holds every stripe lock shared until it is destroyed,
+  // so adds and removes wait for it. The thread holding it can still
+  // find, iterate, and so on (those notice the stripes are already held
+  // and skip locking them again), but must not add or remove, and must
+  // destroy the iterator itself.
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+private:
+  // the chain (linked list) nodes
+  struct Node {
+    K key;
+    V value;
+    Node * next;
+  };
+
+  // The (resizeable) hash table, only replaced while every stripe
+  // lock is held
+  Node* * hash_table;
+  size_t table_capacity;
+  // Number of pairs, updated without any lock held
+  std::atomic<size_t> length;
+  // Average chain length that triggers a resize
+  double load_factor_threshold = 0.75;
+  // Stripe locks: shared for finds, exclusive for adds and removes
+  mutable std::shared_mutex* stripes;
+  size_t stripe_total;
+
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // Take or release a shared lock on every stripe, in stripe order.
+  // Only the outermost hold of a thread locks (or unlocks) anything,
+  // since locking a shared_mutex the thread already holds is undefined.
+  void lock_all_shared() const;
+  void unlock_all_shared() const;
+  // true while this thread holds every stripe of this table
+  bool holds_all_stripes() const;
+  // the tables this thread holds every stripe of, once per hold
+  static ArrayList<const ConcurrentHashTableCollection<K,V>*>& held_tables();
+  // Double the table unless another thread already grew it past
+  // seen_capacity
+  void resize_and_rehash(size_t seen_capacity);
+
+  KeyHash<K> hash_fun; // K- based hash function object
+
+  // shared locks on every stripe, released with the last cursor copy
+  struct StripeLocks {
+    explicit StripeLocks(const ConcurrentHashTableCollection<K,V>& a_table)
+      : table(a_table) { table.lock_all_shared(); }
+    ~StripeLocks() { table.unlock_all_shared(); }
+    const ConcurrentHashTableCollection<K,V>& table;
+  };
+
+  // cursor over the chains, bucket by bucket
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    explicit Cursor(const ConcurrentHashTableCollection<K,V>& a_table);
+    bool valid() const { return ptr != nullptr; }
+    const K& key() const { return ptr->key; }
+    const V& value() const { return ptr->value; }
+    void next();
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    std::shared_ptr<StripeLocks> locks;
+    size_t index; // next bucket to visit
+    const Node* ptr;
+    // move to the first node of the next non-empty bucket
+    void next_bucket();
+  };
+
+  // the locks cannot be copied, so neither can the table
+  ConcurrentHashTableCollection(const ConcurrentHashTableCollection<K,V>& rhs);
+  ConcurrentHashTableCollection& operator=(const ConcurrentHashTableCollection<K,V>& rhs);
+};
+
+
+template<typename K,typename V>
+ConcurrentHashTableCollection<K,V>::ConcurrentHashTableCollection(size_t stripe_count)
+  : table_capacity(0), length(0), stripe_total(stripe_count > 0 ? stripe_count : 1)
+{
+  stripes = new std::shared_mutex[stripe_total];
+  table_capacity = stripe_total * 2;
+  hash_table = new Node *[table_capacity];
+  for (size_t i = 0; i < table_capacity; ++i) {
+    hash_table[i] = nullptr;
+  }
+}
+
+template<typename K,typename V>
+ConcurrentHashTableCollection<K,V>::~ConcurrentHashTableCollection()
+{
+  for (size_t i = 0; i < table_capacity; ++i) {
+    Node * ptr = hash_table[i];
+    while (ptr != nullptr) {
+      Node * next = ptr->next;
+      delete ptr;
+      ptr = next;
+    }
+  }
+  delete [] hash_table;
+  delete [] stripes;
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K,typename V>
+template<typename KK, typename VV>
+void ConcurrentHashTableCollection<K,V>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  size_t code = hash_fun(a_key); // get int - based value for key
+  // Build the node before taking the lock
+  Node * newNode = new Node;
+  newNode->key = std::forward<KK>(a_key);
+  newNode->value = std::forward<VV>(a_val);
+
+  size_t seen_capacity;
+  {
+    // The stripe lock also keeps the table from being replaced
+    std::unique_lock<std::shared_mutex> lock(stripes[code % stripe_total]);
+    size_t index = code % table_capacity; // calculate the index
+    newNode->next = hash_table[index];
+    hash_table[index] = newNode;
+    seen_capacity = table_capacity;
+  }
+  size_t new_length = ++length;
+  if (new_length >= load_factor_threshold * seen_capacity) {
+    // The average chain length is growing too high, so rehash
+    resize_and_rehash(seen_capacity);
+  }
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  size_t code = hash_fun(a_key); // get int - based value for key
+  Node * removed = nullptr;
+  {
+    std::unique_lock<std::shared_mutex> lock(stripes[code % stripe_total]);
+    size_t index = code % table_capacity; // calculate the index
+    Node * ptr = hash_table[index];
+    Node * prev_ptr = nullptr;
+    while (ptr != nullptr) {
+      if (ptr->key == a_key) {
+        // Key value pair has been found, unlink it from the chain
+        if (prev_ptr == nullptr) {
+          hash_table[index] = ptr->next;
+        }
+        else {
+          prev_ptr->next = ptr->next;
+        }
+        removed = ptr;
+        break;
+      }
+      prev_ptr = ptr;
+      ptr = ptr->next;
+    }
+  }
+  if (removed != nullptr) {
+    // Nothing else can reach the node now, so free it outside the lock
+    delete removed;
+    --length;
+  }
+}
+
+template<typename K,typename V>
+bool ConcurrentHashTableCollection<K,V>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K,typename V>
+template<typename Q, typename>
+bool ConcurrentHashTableCollection<K,V>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  size_t code = hash_fun(search_key); // get int - based value for key
+  std::shared_lock<std::shared_mutex> lock(stripes[code % stripe_total], std::defer_lock);
+  if (!holds_all_stripes()) {
+    lock.lock();
+  }
+  Node * ptr = hash_table[code % table_capacity];
+  while (ptr != nullptr) {
+    // Traverse chain within bucket until the value is found
+    COLLECTION_COUNT(NODES_VISITED, 1);
+    if (ptr->key == search_key) {
+      // Found the search key!
+      the_val = ptr->value;
+      return true;
+    }
+    ptr = ptr->next;
+  }
+  return false;
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  // A consistent view needs every stripe
+  lock_all_shared();
+  for (size_t i = 0; i < table_capacity; ++i) {
+    for (Node * ptr = hash_table[i]; ptr != nullptr; ptr = ptr->next) {
+      if (ptr->key >= k1 && ptr->key <= k2) {
+        // Add all elements which fall in the range
+        keys.add(ptr->key);
+      }
+    }
+  }
+  unlock_all_shared();
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::keys(ArrayList<K>& all_keys) const
+{
+  lock_all_shared();
+  for (size_t i = 0; i < table_capacity; ++i) {
+    for (Node * ptr = hash_table[i]; ptr != nullptr; ptr = ptr->next) {
+      all_keys.add(ptr->key);
+    }
+  }
+  unlock_all_shared();
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  keys(all_keys_sorted);
+  sort_keys(all_keys_sorted);
+}
+
+template<typename K,typename V>
+size_t ConcurrentHashTableCollection<K,V>::size() const
+{
+  return length;
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> ConcurrentHashTableCollection<K,V>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(*this));
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> ConcurrentHashTableCollection<K,V>::lower_bound(const K& k) const
+{
+  // Unordered, so every pair has to be checked against the bound
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, false));
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> ConcurrentHashTableCollection<K,V>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, true));
+}
+
+template<typename K,typename V>
+ConcurrentHashTableCollection<K,V>::Cursor::Cursor(const ConcurrentHashTableCollection<K,V>& a_table)
+  : locks(std::make_shared<StripeLocks>(a_table)), index(0), ptr(nullptr)
+{
+  next_bucket();
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::Cursor::next()
+{
+  ptr = ptr->next;
+  if (ptr == nullptr) {
+    next_bucket();
+  }
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::Cursor::next_bucket()
+{
+  const ConcurrentHashTableCollection<K,V>& table = locks->table;
+  while (ptr == nullptr && index < table.table_capacity) {
+    ptr = table.hash_table[index];
+    ++index;
+  }
+}
+
+template<typename K,typename V>
+size_t ConcurrentHashTableCollection<K,V>::capacity() const
+{
+  lock_all_shared();
+  size_t result = table_capacity;
+  unlock_all_shared();
+  return result;
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::lock_all_shared() const
+{
+  bool nested = holds_all_stripes();
+  held_tables().add(this);
+  if (nested) {
+    return;
+  }
+  // Always in stripe order, so two threads locking everything (or a
+  // resize) cannot deadlock
+  for (size_t i = 0; i < stripe_total; ++i) {
+    stripes[i].lock_shared();
+  }
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::unlock_all_shared() const
+{
+  ArrayList<const ConcurrentHashTableCollection<K,V>*>& held = held_tables();
+  for (size_t i = held.size(); i > 0; --i) {
+    if (held[i - 1] == this) {
+      held.remove(i - 1);
+      break;
+    }
+  }
+  if (holds_all_stripes()) {
+    // an outer hold still needs the locks
+    return;
+  }
+  for (size_t i = 0; i < stripe_total; ++i) {
+    stripes[i].unlock_shared();
+  }
+}
+
+template<typename K,typename V>
+bool ConcurrentHashTableCollection<K,V>::holds_all_stripes() const
+{
+  const ArrayList<const ConcurrentHashTableCollection<K,V>*>& held = held_tables();
+  for (size_t i = 0; i < held.size(); ++i) {
+    if (held[i] == this) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename K,typename V>
+ArrayList<const ConcurrentHashTableCollection<K,V>*>& ConcurrentHashTableCollection<K,V>::held_tables()
+{
+  thread_local ArrayList<const ConcurrentHashTableCollection<K,V>*> tables;
+  return tables;
+}
+
+template<typename K,typename V>
+void ConcurrentHashTableCollection<K,V>::resize_and_rehash(size_t seen_capacity)
+{
+  for (size_t i = 0; i < stripe_total; ++i) {
+    stripes[i].lock();
+  }
+  if (table_capacity == seen_capacity) {
+    // Still the table that was too full, so double it and relink
+    // (not copy) every node
+    COLLECTION_COUNT(REHASHES, 1);
+    size_t new_capacity = table_capacity * 2;
+    Node* * new_hash_table = new Node*[new_capacity];
+    for (size_t i = 0; i < new_capacity; ++i) {
+      new_hash_table[i] = nullptr;
+    }
+    for (size_t i = 0; i < table_capacity; ++i) {
+      Node * ptr = hash_table[i];
+      while (ptr != nullptr) {
+        Node * next = ptr->next;
+        size_t new_index = hash_fun(ptr->key) % new_capacity;
+        ptr->next = new_hash_table[new_index];
+        new_hash_table[new_index] = ptr;
+        ptr = next;
+      }
+    }
+    delete [] hash_table;
+    hash_table = new_hash_table;
+    table_capacity = new_capacity;
+  }
+  for (size_t i = stripe_total; i > 0; --i) {
+    stripes[i - 1].unlock();
+  }
+}
+
+
+#endif
@@ -0,0 +1,761 @@
+//----------------------------------------------------------------------
+// FILE: concurrent_rbt_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: A red-black tree (left-leaning variant) that any number of
+//  threads can read while one writer at a time changes it. Published
+//  nodes are never modified: a writer copies the nodes on its path,
+//  builds the new version of the tree off to the side, and swaps in
+//  the new root with a single atomic store. Readers only load the root
+//  and walk down, so they never wait on a lock. Nodes the writer
+//  replaced are freed once every reader that might still see them has
+//  finished (epoch-based reclamation).
+//----------------------------------------------------------------------
+
+#ifndef CONCURRENT_RBT_COLLECTION_H
+#define CONCURRENT_RBT_COLLECTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "array_list.h"
+#include "collection.h"
+#include "tree_cursor.h"
+
+
+template<typename K, typename V>
+class ConcurrentRBTCollection final : public Collection<K,V>
+{
+public:
+
+  // number of readers that can be inside the tree at the same time
+  // (more than this spin until a slot frees up)
+  static const size_t READER_SLOTS = 128;
+
+  // create an empty collection
+  ConcurrentRBTCollection();
+
+  // delete collection (no other thread may still be using it)
+  ~ConcurrentRBTCollection();
+
+  // add a new key-value pair into the collection (replaces the value
+  // if the key is already present)
+  void add(const K& a_key, const V& a_val);
+
+  // add a new key-value pair, moving the key and value into the node
+  void add(K&& a_key, V&& a_val);
+
+  // remove a key-value pair from the collection
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+
+  // find and return each key >= k1 and <= k2 (all from one version of
+  // the tree, even while writers are running)
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return the height of the tree
+  size_t height() const;
+
+  // in-order iteration (see Collection). An iterator walks the version
+  // of the tree it started in, however long it lives and whatever
+  // writers do meanwhile, but it keeps a reader slot and holds back
+  // the freeing of replaced nodes until it is destroyed.
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+  // for testing:
+
+  // check if the tree satisfies the left-leaning red-black constraints
+  bool valid_rbt() const;
+
+  // number of replaced nodes still waiting on readers to be freed
+  size_t retired_count() const;
+
+private:
+
+  // RBT node structure, never changed once it is reachable from root
+  enum color_t {RED, BLACK};
+  struct Node {
+    K key;
+    V value;
+    Node* left;
+    Node* right;
+    color_t color;
+    // write that created the node; only nodes from the current write
+    // may be changed in place
+    uint64_t version;
+  };
+
+  // an epoch a reader entered at (0 when the slot is free), padded so
+  // readers on different cores do not share a cache line
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch;
+  };
+
+  // marks the calling thread as reading for as long as it lives
+  class ReadGuard {
+  public:
+    // enters at the current epoch, or at pinned_epoch (which an
+    // existing guard must still hold) when it is not 0
+    explicit ReadGuard(const ConcurrentRBTCollection<K,V>& tree, uint64_t pinned_epoch = 0);
+    ~ReadGuard();
+    uint64_t epoch() const { return slot->epoch.load(); }
+  private:
+    ReaderSlot* slot;
+    ReadGuard(const ReadGuard& rhs);
+    ReadGuard& operator=(const ReadGuard& rhs);
+  };
+
+  // in-order cursor; the guard (a base so it is taken before the root
+  // is read) keeps every node of its version alive
+  class Cursor : private ReadGuard, public TreeCursor<K,V,Node> {
+  public:
+    explicit Cursor(const ConcurrentRBTCollection<K,V>& a_tree)
+      : ReadGuard(a_tree), TreeCursor<K,V,Node>(a_tree.root.load()), tree(a_tree) {}
+    Cursor(const ConcurrentRBTCollection<K,V>& a_tree, const K& bound, bool strict)
+      : ReadGuard(a_tree), TreeCursor<K,V,Node>(a_tree.root.load(), bound, strict),
+        tree(a_tree) {}
+    // a copy enters at the same epoch, so the copied path stays safe
+    Cursor(const Cursor& rhs)
+      : ReadGuard(rhs.tree, rhs.epoch()), TreeCursor<K,V,Node>(rhs), tree(rhs.tree) {}
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const ConcurrentRBTCollection<K,V>& tree;
+  };
+
+  // current version of the tree
+  std::atomic<Node*> root;
+
+  // number of k-v pairs stored in the collection
+  std::atomic<size_t> node_count;
+
+  // writers take turns
+  mutable std::mutex write_lock;
+
+  // version stamped on nodes made by the running write
+  uint64_t write_version;
+
+  // bumped after every write that replaced nodes
+  std::atomic<uint64_t> global_epoch;
+
+  // epochs of the readers currently in the tree
+  mutable ReaderSlot reader_slots[READER_SLOTS];
+
+  // nodes replaced by the running write (not yet published)
+  ArrayList<Node*> replaced;
+
+  // replaced nodes from earlier writes, with the epoch they were
+  // retired in, waiting until no reader can reach them
+  ArrayList<std::pair<uint64_t,Node*>> retired;
+
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+
+  // recursive add helper, returns the new subtree root
+  template<typename KK, typename VV>
+  Node* add(Node* subtree_root, KK&& a_key, VV&& a_val, bool& added);
+
+  // recursive remove helpers, return the new subtree root
+  Node* remove(Node* subtree_root, const K& a_key);
+  Node* remove_min(Node* subtree_root);
+
+  // return a node that may be changed: the node itself if this write
+  // made it, otherwise a copy (and the original is retired)
+  Node* own(Node* x);
+
+  // drop a node from the tree being built
+  void discard(Node* x);
+
+  // left-leaning red-black helpers, each owns what it changes
+  static bool is_red(const Node* x);
+  Node* rotate_left(Node* h);
+  Node* rotate_right(Node* h);
+  Node* flip_colors(Node* h);
+  Node* move_red_left(Node* h);
+  Node* move_red_right(Node* h);
+  Node* balance(Node* h);
+
+  // make the new tree visible to readers, then free whatever no
+  // reader can still be looking at
+  void publish(Node* new_root);
+  void reclaim();
+
+  // free every node in a subtree
+  void make_empty(Node* subtree_root);
+
+  // helper to recursively find range of keys
+  void find(const Node* subtree_root, const K& k1, const K& k2,
+            ArrayList<K>& keys) const;
+
+  // helper to build sorted list of keys (used by keys and sort)
+  void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
+
+  // height helper
+  size_t height(const Node* subtree_root) const;
+
+  // validate helper, returns the black height or -1 if not valid
+  int black_node_height(const Node* subtree_root) const;
+
+  // the locks cannot be copied, so neither can the tree
+  ConcurrentRBTCollection(const ConcurrentRBTCollection<K,V>& rhs);
+  ConcurrentRBTCollection& operator=(const ConcurrentRBTCollection<K,V>& rhs);
+};
+
+
+template<typename K, typename V>
+ConcurrentRBTCollection<K,V>::ReadGuard::ReadGuard(const ConcurrentRBTCollection<K,V>& tree,
+                                                   uint64_t pinned_epoch)
+{
+  // Each thread starts looking at its own slot, so readers rarely race
+  // for the same one
+  static thread_local size_t hint =
+    std::hash<std::thread::id>()(std::this_thread::get_id()) % READER_SLOTS;
+  size_t i = hint;
+  while (true) {
+    // The epoch has to be published before the root is read: a writer
+    // that does not see this slot has already swapped in its root
+    uint64_t epoch = pinned_epoch != 0 ? pinned_epoch : tree.global_epoch.load();
+    uint64_t expected = 0;
+    slot = &tree.reader_slots[i];
+    if (slot->epoch.compare_exchange_strong(expected, epoch)) {
+      hint = i;
+      return;
+    }
+    i = (i + 1) % READER_SLOTS;
+    if (i == hint) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+template<typename K, typename V>
+ConcurrentRBTCollection<K,V>::ReadGuard::~ReadGuard()
+{
+  slot->epoch.store(0);
+}
+
+template<typename K, typename V>
+ConcurrentRBTCollection<K,V>::ConcurrentRBTCollection()
+  : root(nullptr), node_count(0), write_version(0), global_epoch(1)
+{
+  for (size_t i = 0; i < READER_SLOTS; ++i) {
+    reader_slots[i].epoch.store(0);
+  }
+}
+
+template<typename K, typename V>
+ConcurrentRBTCollection<K,V>::~ConcurrentRBTCollection()
+{
+  make_empty(root.load());
+  for (size_t i = 0; i < retired.size(); ++i) {
+    delete retired[i].second;
+  }
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K, typename V>
+template<typename KK, typename VV>
+void ConcurrentRBTCollection<K,V>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  std::lock_guard<std::mutex> lock(write_lock);
+  ++write_version;
+  bool added = false;
+  Node* new_root = add(root.load(), std::forward<KK>(a_key),
+                       std::forward<VV>(a_val), added);
+  if (new_root->color == RED) {
+    new_root = own(new_root);
+    new_root->color = BLACK;
+  }
+  publish(new_root);
+  if (added) {
+    ++node_count;
+  }
+}
+
+template<typename K, typename V>
+template<typename KK, typename VV>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::add(Node* subtree_root, KK&& a_key, VV&& a_val, bool& added)
+{
+  if (subtree_root == nullptr) {
+    // Reached the bottom, so the new key goes here as a red leaf
+    Node* newNode = new Node{std::forward<KK>(a_key), std::forward<VV>(a_val),
+                             nullptr, nullptr, RED, write_version};
+    added = true;
+    return newNode;
+  }
+  Node* h = own(subtree_root);
+  if (a_key < h->key) {
+    h->left = add(h->left, std::forward<KK>(a_key), std::forward<VV>(a_val), added);
+  }
+  else if (h->key < a_key) {
+    h->right = add(h->right, std::forward<KK>(a_key), std::forward<VV>(a_val), added);
+  }
+  else {
+    // Key already present, so only the value changes
+    h->value = std::forward<VV>(a_val);
+  }
+  return balance(h);
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  std::lock_guard<std::mutex> lock(write_lock);
+  // The writer holds the lock, so nothing it reads can be freed
+  Node* x = root.load();
+  while (x != nullptr && (a_key < x->key || x->key < a_key)) {
+    x = a_key < x->key ? x->left : x->right;
+  }
+  if (x == nullptr) {
+    // The key is not in the tree, so there is nothing to change
+    return;
+  }
+  ++write_version;
+  Node* new_root = root.load();
+  if (!is_red(new_root->left) && !is_red(new_root->right)) {
+    new_root = own(new_root);
+    new_root->color = RED;
+  }
+  new_root = remove(new_root, a_key);
+  if (new_root != nullptr && new_root->color == RED) {
+    new_root = own(new_root);
+    new_root->color = BLACK;
+  }
+  publish(new_root);
+  --node_count;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::remove(Node* subtree_root, const K& a_key)
+{
+  Node* h = own(subtree_root);
+  if (a_key < h->key) {
+    // Keep a red link on the way down the left side
+    if (!is_red(h->left) && !is_red(h->left->left)) {
+      h = move_red_left(h);
+    }
+    h->left = remove(h->left, a_key);
+  }
+  else {
+    if (is_red(h->left)) {
+      h = rotate_right(h);
+    }
+    if (!(h->key < a_key) && h->right == nullptr) {
+      // Found at the bottom, so just drop it
+      discard(h);
+      return nullptr;
+    }
+    if (!is_red(h->right) && !is_red(h->right->left)) {
+      h = move_red_right(h);
+    }
+    if (!(h->key < a_key)) {
+      // Found with a right subtree, so take the successor's pair and
+      // remove the successor instead
+      Node* s = h->right;
+      while (s->left != nullptr) {
+        s = s->left;
+      }
+      h->key = s->key;
+      h->value = s->value;
+      h->right = remove_min(h->right);
+    }
+    else {
+      h->right = remove(h->right, a_key);
+    }
+  }
+  return balance(h);
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::remove_min(Node* subtree_root)
+{
+  if (subtree_root->left == nullptr) {
+    discard(subtree_root);
+    return nullptr;
+  }
+  Node* h = own(subtree_root);
+  if (!is_red(h->left) && !is_red(h->left->left)) {
+    h = move_red_left(h);
+  }
+  h->left = remove_min(h->left);
+  return balance(h);
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::own(Node* x)
+{
+  if (x->version == write_version) {
+    // Made by this write, so no reader has seen it yet
+    return x;
+  }
+  Node* copy = new Node(*x);
+  copy->version = write_version;
+  replaced.add(x);
+  return copy;
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::discard(Node* x)
+{
+  if (x->version == write_version) {
+    delete x;
+  }
+  else {
+    replaced.add(x);
+  }
+}
+
+template<typename K, typename V>
+bool ConcurrentRBTCollection<K,V>::is_red(const Node* x)
+{
+  return x != nullptr && x->color == RED;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::rotate_left(Node* h)
+{
+  COLLECTION_COUNT(ROTATIONS, 1);
+  h = own(h);
+  Node* x = own(h->right);
+  h->right = x->left;
+  x->left = h;
+  x->color = h->color;
+  h->color = RED;
+  return x;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::rotate_right(Node* h)
+{
+  COLLECTION_COUNT(ROTATIONS, 1);
+  h = own(h);
+  Node* x = own(h->left);
+  h->left = x->right;
+  x->right = h;
+  x->color = h->color;
+  h->color = RED;
+  return x;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::flip_colors(Node* h)
+{
+  h = own(h);
+  h->left = own(h->left);
+  h->right = own(h->right);
+  h->color = h->color == RED ? BLACK : RED;
+  h->left->color = h->left->color == RED ? BLACK : RED;
+  h->right->color = h->right->color == RED ? BLACK : RED;
+  return h;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::move_red_left(Node* h)
+{
+  // Make h->left or one of its children red
+  h = flip_colors(h);
+  if (is_red(h->right->left)) {
+    h->right = rotate_right(h->right);
+    h = rotate_left(h);
+    h = flip_colors(h);
+  }
+  return h;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::move_red_right(Node* h)
+{
+  // Make h->right or one of its children red
+  h = flip_colors(h);
+  if (is_red(h->left->left)) {
+    h = rotate_right(h);
+    h = flip_colors(h);
+  }
+  return h;
+}
+
+template<typename K, typename V>
+typename ConcurrentRBTCollection<K,V>::Node*
+ConcurrentRBTCollection<K,V>::balance(Node* h)
+{
+  // Restore the left-leaning constraints on the way back up
+  if (is_red(h->right) && !is_red(h->left)) {
+    h = rotate_left(h);
+  }
+  if (is_red(h->left) && is_red(h->left->left)) {
+    h = rotate_right(h);
+  }
+  if (is_red(h->left) && is_red(h->right)) {
+    h = flip_colors(h);
+  }
+  return h;
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::publish(Node* new_root)
+{
+  root.store(new_root);
+  if (replaced.size() > 0) {
+    // Readers entering from here on see new_root, so only readers in
+    // the current epoch (or older) can still hold the replaced nodes
+    uint64_t epoch = global_epoch.load();
+    for (size_t i = 0; i < replaced.size(); ++i) {
+      retired.add(std::make_pair(epoch, replaced[i]));
+    }
+    replaced = ArrayList<Node*>();
+    global_epoch.store(epoch + 1);
+  }
+  reclaim();
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::reclaim()
+{
+  if (retired.size() == 0) {
+    return;
+  }
+  // Oldest epoch any reader is still in
+  uint64_t oldest = global_epoch.load();
+  for (size_t i = 0; i < READER_SLOTS; ++i) {
+    uint64_t epoch = reader_slots[i].epoch.load();
+    if (epoch != 0 && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+  // Nodes were retired in epoch order, so free from the front until
+  // one might still be in use
+  size_t freed = 0;
+  while (freed < retired.size() && retired[freed].first < oldest) {
+    delete retired[freed].second;
+    ++freed;
+  }
+  if (freed > 0) {
+    ArrayList<std::pair<uint64_t,Node*>> remaining(retired.size() - freed);
+    for (size_t i = freed; i < retired.size(); ++i) {
+      remaining.add(retired[i]);
+    }
+    retired = std::move(remaining);
+  }
+}
+
+template<typename K, typename V>
+bool ConcurrentRBTCollection<K,V>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V>
+template<typename Q, typename>
+bool ConcurrentRBTCollection<K,V>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  ReadGuard guard(*this);
+  const Node* x = root.load();
+  while (x != nullptr) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
+    if (search_key < x->key) {
+      x = x->left;
+    }
+    else if (x->key < search_key) {
+      x = x->right;
+    }
+    else {
+      the_val = x->value;
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  ReadGuard guard(*this);
+  find(root.load(), k1, k2, keys);
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2,
+                                        ArrayList<K>& keys) const
+{
+  if (subtree_root == nullptr) {
+    return;
+  }
+  if (k1 < subtree_root->key) {
+    // Only the left subtree can hold keys below this one
+    find(subtree_root->left, k1, k2, keys);
+  }
+  if (subtree_root->key >= k1 && subtree_root->key <= k2) {
+    keys.add(subtree_root->key);
+  }
+  if (subtree_root->key < k2) {
+    find(subtree_root->right, k1, k2, keys);
+  }
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::keys(ArrayList<K>& all_keys) const
+{
+  ReadGuard guard(*this);
+  keys(root.load(), all_keys);
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+{
+  if (subtree_root == nullptr) {
+    return;
+  }
+  keys(subtree_root->left, all_keys);
+  all_keys.add(subtree_root->key);
+  keys(subtree_root->right, all_keys);
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  // An in-order walk is already sorted
+  keys(all_keys_sorted);
+}
+
+template<typename K, typename V>
+size_t ConcurrentRBTCollection<K,V>::size() const
+{
+  return node_count;
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> ConcurrentRBTCollection<K,V>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(*this));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> ConcurrentRBTCollection<K,V>::lower_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new Cursor(*this, k, false));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> ConcurrentRBTCollection<K,V>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new Cursor(*this, k, true));
+}
+
+template<typename K, typename V>
+size_t ConcurrentRBTCollection<K,V>::height() const
+{
+  ReadGuard guard(*this);
+  return height(root.load());
+}
+
+template<typename K, typename V>
+size_t ConcurrentRBTCollection<K,V>::height(const Node* subtree_root) const
+{
+  if (subtree_root == nullptr) {
+    return 0;
+  }
+  size_t left = height(subtree_root->left);
+  size_t right = height(subtree_root->right);
+  return 1 + (left > right ? left : right);
+}
+
+template<typename K, typename V>
+bool ConcurrentRBTCollection<K,V>::valid_rbt() const
+{
+  ReadGuard guard(*this);
+  const Node* r = root.load();
+  return !is_red(r) && black_node_height(r) >= 0;
+}
+
+template<typename K, typename V>
+int ConcurrentRBTCollection<K,V>::black_node_height(const Node* subtree_root) const
+{
+  if (subtree_root == nullptr) {
+    return 0;
+  }
+  const Node* l = subtree_root->left;
+  const Node* r = subtree_root->right;
+  // No right-leaning red links and no two reds in a row
+  if (is_red(r)) {
+    return -1;
+  }
+  if (is_red(subtree_root) && is_red(l)) {
+    return -1;
+  }
+  // Keys in order
+  if ((l != nullptr && !(l->key < subtree_root->key)) ||
+      (r != nullptr && !(subtree_root->key < r->key))) {
+    return -1;
+  }
+  int left_height = black_node_height(l);
+  int right_height = black_node_height(r);
+  if (left_height < 0 || left_height != right_height) {
+    return -1;
+  }
+  return left_height + (subtree_root->color == BLACK ? 1 : 0);
+}
+
+template<typename K, typename V>
+size_t ConcurrentRBTCollection<K,V>::retired_count() const
+{
+  std::lock_guard<std::mutex> lock(write_lock);
+  return retired.size();
+}
+
+template<typename K, typename V>
+void ConcurrentRBTCollection<K,V>::make_empty(Node* subtree_root)
+{
+  if (subtree_root == nullptr) {
+    return;
+  }
+  make_empty(subtree_root->left);
+  make_empty(subtree_root->right);
+  delete subtree_root;
+}
+
+
+#endif
@@ -5,6 +5,14 @@
 // DESC: Implements a hash table as a linear data structure which effectively allows 
 //  for the adding, removing, and finding of elements through the use of a hash function
 //  that established a hash code for every key and its corresponding value pair.
+//  The table can optionally grow incrementally: instead of rehashing every
+//  node at once, old and new bucket arrays stay live and each add and
+//  remove migrates a bounded number of old buckets. Finds only read
+//  (both tables), so a table can still be searched from several threads
+//  at once. The hash function and the
+//  way a hash code becomes a bucket index are template policies (see
+//  key_hash.h); the defaults are KeyHash (std::hash, through
+//  string_view for string keys) and ModuloIndex (the remainder).
 //----------------------------------------------------------------------
 
 #ifndef HASH_TABLE_COLLECTION_H
@@ -14,32 +22,73 @@
 #include "array_list_collection.h"
 #include "bin_search_collection.h"
 #include "collection.h"
+#include "radix_sort.h"
+#include "key_hash.h"
+#include "batch.h"
 
 
-template<typename K,typename V>
-class HashTableCollection : public Collection<K,V>
+// Hash is called on a key for its hash code, and Index maps a code and
+// the (power of two) table capacity to a bucket
+template<typename K, typename V, typename Hash = KeyHash<K>, typename Index = ModuloIndex>
+class HashTableCollection final : public Collection<K,V>
 { 
 public:
-  HashTableCollection();
-  HashTableCollection(const HashTableCollection<K,V>& rhs);
+  // a migration budget of 0 rehashes the whole table at once whenever
+  // it grows, otherwise every add and remove moves migration_budget
+  // old buckets into the new table (or more, if that many would not be
+  // done moving them before the table has to grow again)
+  explicit HashTableCollection(size_t migration_budget = 0);
+  HashTableCollection(const HashTableCollection<K,V,Hash,Index>& rhs);
+  HashTableCollection(HashTableCollection<K,V,Hash,Index>&& rhs);
   ~HashTableCollection();
-  HashTableCollection& operator=(const HashTableCollection<K,V>& rhs);
+  HashTableCollection& operator=(const HashTableCollection<K,V,Hash,Index>& rhs);
+  HashTableCollection& operator=(HashTableCollection<K,V,Hash,Index>&& rhs);
   
   
   void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
   void remove(const K& a_key);
   bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<HashedLookup<Hash,K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;
+
+  // batch operations over keys[0..n): the table grows (at most once)
+  // before a batch of adds instead of rechecking the load after each
+  // one, and every key is hashed before any bucket is touched so the
+  // buckets can be prefetched ahead of use
+  void add_batch(const K* keys, const V* vals, size_t n);
+  // stores each key's value in vals[i] and whether it was found in
+  // found[i], returning the number of keys found
+  size_t find_batch(const K* keys, size_t n, V* vals, bool* found) const;
+  void remove_batch(const K* keys, size_t n);
   
-  // 3 public "statistics" functions
+  // public "statistics" functions
   
   size_t min_chain_length();
   size_t max_chain_length();
   double avg_chain_length();
+  // counts[i] = number of buckets whose chain has length i, for i up
+  // to the longest chain (counts is cleared first)
+  void chain_length_histogram(ArrayList<size_t>& counts);
+  // bytes held by the bucket arrays and chain nodes (not counting the
+  // allocator's per-node overhead, or anything the keys and values
+  // themselves allocate)
+  size_t memory_bytes() const;
   
+  // true while buckets are still being moved out of the old table
+  bool migrating() const;
+
+  // iteration in bucket order (see Collection), including any buckets
+  // not yet migrated
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
   
 private:
   // the chain (linked list) nodes
@@ -57,15 +106,64 @@ private:
   size_t table_capacity;
   // Load factor on hash table
   double load_factor_threshold = 0.75;
-  // Function for resizing and rehashing
-  void resize_and_rehash();
+  // Function for resizing and rehashing (doubling the capacity until
+  // it is at least min_capacity)
+  void resize_and_rehash(size_t min_capacity = 0);
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // add, find, and remove given the key's hash code (no migration step
+  // or load check)
+  template<typename KK, typename VV>
+  void add_hashed(KK&& a_key, VV&& a_val, size_t code);
+  template<typename Q>
+  bool find_hashed(const Q& search_key, size_t code, V& the_val) const;
+  void remove_hashed(const K& a_key, size_t code);
   
-  std::hash<K>hash_fun; // K- based hash function object
+  // Incremental rehashing state. The old table is only non-null while a
+  // migration is in progress, and buckets below migrate_index have
+  // already been moved.
+  Node* * old_table;
+  size_t old_capacity;
+  size_t migrate_index;
+  // Number of old buckets moved per operation (0 = stop-the-world)
+  size_t migration_budget;
+  // Move migration_budget old buckets into the new table, or enough
+  // more to finish the migration before the table next grows
+  void migrate_step();
+  // Move every remaining old bucket into the new table
+  void finish_migration();
+  // Relink the chain of an old bucket into the current table
+  void migrate_bucket(size_t index);
+  // Delete every node in a table along with the table itself
+  void make_empty(Node* * table, size_t capacity);
+  
+  Hash hash_fun; // K- based hash function object
+  Index index_fun; // hash code to bucket index function object
+
+  // cursor over the chains of the current table, then the old table
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    explicit Cursor(const HashTableCollection<K,V,Hash,Index>& a_table);
+    bool valid() const { return ptr != nullptr; }
+    const K& key() const { return ptr->key; }
+    const V& value() const { return ptr->value; }
+    void next();
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const HashTableCollection<K,V,Hash,Index>& table;
+    int t;        // 0 = current table, 1 = old table
+    size_t index; // next bucket to visit
+    const Node* ptr;
+    // move to the first node of the next non-empty bucket
+    void next_bucket();
+  };
 };
 
-template<typename K,typename V>
-HashTableCollection<K,V>::HashTableCollection()
- : table_capacity(16), length(0)
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>::HashTableCollection(size_t migration_budget)
+ : table_capacity(16), length(0), old_table(nullptr), old_capacity(0),
+   migrate_index(0), migration_budget(migration_budget)
 {
   hash_table = new Node *[table_capacity];
   
@@ -74,46 +172,42 @@ HashTableCollection<K,V>::HashTableCollection()
   }
 }
 
-template<typename K,typename V>
-HashTableCollection<K,V>::HashTableCollection(const HashTableCollection<K,V>& rhs)
-  : table_capacity(0), length(0), hash_table(nullptr)
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>::HashTableCollection(const HashTableCollection<K,V,Hash,Index>& rhs)
+  : table_capacity(0), length(0), hash_table(nullptr), old_table(nullptr),
+    old_capacity(0), migrate_index(0), migration_budget(rhs.migration_budget)
 {
   // Defer to the assignment operator
   *this = rhs;
 }
 
-template<typename K,typename V>
-HashTableCollection<K,V>::~HashTableCollection()
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>::HashTableCollection(HashTableCollection<K,V,Hash,Index>&& rhs)
+  : HashTableCollection(rhs.migration_budget)
 {
-  for (size_t i = 0; i < table_capacity; ++i) {
-    Node * ptr = hash_table[i];
-	Node * next_ptr = NULL;
-    while (ptr != NULL) {
-	  next_ptr = ptr->next;
-	  delete ptr;
-	  ptr = next_ptr;
-	}
-  }
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>::~HashTableCollection()
+{
+  make_empty(hash_table, table_capacity);
+  make_empty(old_table, old_capacity);
 }
-template<typename K,typename V>
-HashTableCollection<K,V>& HashTableCollection<K,V>::operator=(const HashTableCollection<K,V>& rhs)
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>& HashTableCollection<K,V,Hash,Index>::operator=(const HashTableCollection<K,V,Hash,Index>& rhs)
 {
   if (this != &rhs) { // protects against self-assignment case
     length = 0;
-	if (hash_table != NULL) {
-	  // If the hash table is not already empty, then make it empty
-	  for (size_t i = 0; i < table_capacity; ++i) {
-        Node * ptr = hash_table[i];
-	    Node * next_ptr = NULL;
-        while (ptr != NULL) {
-	      next_ptr = ptr->next;
-	      delete ptr;
-	      ptr = next_ptr;
-	    }
-      }
-	  delete [] hash_table;
-	  hash_table = NULL; 
-	}
+	// If the hash table is not already empty, then make it empty
+	make_empty(hash_table, table_capacity);
+	hash_table = NULL;
+	make_empty(old_table, old_capacity);
+	old_table = NULL;
+	old_capacity = 0;
+	migrate_index = 0;
+	migration_budget = rhs.migration_budget;
     table_capacity = rhs.table_capacity;
     hash_table = new Node *[table_capacity];
 	
@@ -122,7 +216,7 @@ HashTableCollection<K,V>& HashTableCollection<K,V>::operator=(const HashTableCol
       hash_table[i] = nullptr;
     }
 	
-	// Fill array with elements from rhs
+	// Fill array with elements from rhs (including any not yet migrated)
     for (size_t i = 0; i < rhs.table_capacity; i++) {
 	  Node * ptr = rhs.hash_table[i];
 	  while (ptr != NULL) {
@@ -130,26 +224,72 @@ HashTableCollection<K,V>& HashTableCollection<K,V>::operator=(const HashTableCol
 	    ptr = ptr->next;
 	  }
     }
+    for (size_t i = rhs.migrate_index; rhs.old_table && i < rhs.old_capacity; i++) {
+	  Node * ptr = rhs.old_table[i];
+	  while (ptr != NULL) {
+		add(ptr->key,ptr->value);
+	    ptr = ptr->next;
+	  }
+    }
+  }
+  return *this;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>& HashTableCollection<K,V,Hash,Index>::operator=(HashTableCollection<K,V,Hash,Index>&& rhs)
+{
+  if (this != &rhs) { // protects against self-assignment case
+    // Trade tables with rhs, which then frees ours
+    std::swap(hash_table, rhs.hash_table);
+    std::swap(length, rhs.length);
+    std::swap(table_capacity, rhs.table_capacity);
+    std::swap(old_table, rhs.old_table);
+    std::swap(old_capacity, rhs.old_capacity);
+    std::swap(migrate_index, rhs.migrate_index);
+    std::swap(migration_budget, rhs.migration_budget);
   }
   return *this;
 }
   
   
-template<typename K,typename V>
-void HashTableCollection<K,V>::add(const K& a_key, const V& a_val)
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::add(const K& a_key, const V& a_val)
 {
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename KK, typename VV>
+void HashTableCollection<K,V,Hash,Index>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  migrate_step();
   if (avg_chain_length() >= load_factor_threshold) {
     // The average chain length is growing too high, so rehash
 	resize_and_rehash();
   }
+  // hash before the key is (possibly) moved into the node
+  size_t code = hash_fun(a_key); // get int - based value for key
+  add_hashed(std::forward<KK>(a_key), std::forward<VV>(a_val), code);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename KK, typename VV>
+void HashTableCollection<K,V,Hash,Index>::add_hashed(KK&& a_key, VV&& a_val, size_t code)
+{
+  // Find the location where to has the node to
+  size_t index = index_fun(code, table_capacity); // calculate the index
+  
   // Assigns value to new node
   Node * newNode = new Node;
-  newNode->key = a_key;
-  newNode->value = a_val;
-  
-  // Find the location where to has the node to
-  size_t code = hash_fun(a_key); // get int - based value for key
-  size_t index = code % table_capacity; // calculate the index
+  newNode->key = std::forward<KK>(a_key);
+  newNode->value = std::forward<VV>(a_val);
   
   // Now insert at the front of the linked list, adjusting all other potential elements
   if (hash_table[index] == NULL) {
@@ -163,60 +303,92 @@ void HashTableCollection<K,V>::add(const K& a_key, const V& a_val)
   length = length + 1;
 }
 
-template<typename K,typename V>
-void HashTableCollection<K,V>::remove(const K& a_key)
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::remove(const K& a_key)
 {
+  COLLECTION_TIME(OP_REMOVE);
+  migrate_step();
+  remove_hashed(a_key, hash_fun(a_key));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::remove_hashed(const K& a_key, size_t code)
+{
+  // The key is either in the current table or an unmigrated old bucket
+  for (int t = 0; t < 2; ++t) {
+    Node* * table = t == 0 ? hash_table : old_table;
+	size_t capacity = t == 0 ? table_capacity : old_capacity;
+	if (!table) {
+	  continue;
+	}
+    size_t index = index_fun(code, capacity); // calculate the index
   
-  // Find the location where to has the node to
-  size_t code = hash_fun(a_key); // get int - based value for key
-  size_t index = code % table_capacity; // calculate the index
-  
-  if (!hash_table[index]) {
-    return;
-  }
-  // Traverse the specific chain to the correct key value pair within the bucket
-  Node * ptr = hash_table[index];
-  Node * prev_ptr = NULL;
+    // Traverse the specific chain to the correct key value pair within the bucket
+    Node * ptr = table[index];
+    Node * prev_ptr = NULL;
   
-  while (ptr != NULL) {
-    if (ptr->key == a_key) {
-      // Key value pair has been found
-	  if (ptr == hash_table[index]) {
-	    // CASE 1: Key at front of the list
-		hash_table[index] = ptr->next;
-	  }
-	  else {
-	    // CASE 2: Key is anywhere else in the chain
-		prev_ptr->next = ptr->next;
+    while (ptr != NULL) {
+      if (ptr->key == a_key) {
+        // Key value pair has been found
+	    if (ptr == table[index]) {
+	      // CASE 1: Key at front of the list
+		  table[index] = ptr->next;
+	    }
+	    else {
+	      // CASE 2: Key is anywhere else in the chain
+		  prev_ptr->next = ptr->next;
+	    }
+	    delete ptr;
+	    length = length - 1;
+	    return;
 	  }
-	  delete ptr;
-	  length = length - 1;
-	  return;
-	}
-	prev_ptr = ptr;
-    ptr = ptr->next;
+	  prev_ptr = ptr;
+      ptr = ptr->next;
+    }
   }
   
   // If program reaches this point then there is nothing in the bucket
   // Thus, do nothing
 }
 
-template<typename K,typename V>
-bool HashTableCollection<K,V>::find(const K& search_key, V& the_val) const
+template<typename K, typename V, typename Hash, typename Index>
+bool HashTableCollection<K,V,Hash,Index>::find(const K& search_key, V& the_val) const
 {
-  // Find the location where to has the node to
-  size_t code = hash_fun(search_key); // get int - based value for key
-  size_t index = code % table_capacity ; // calculate the index
-  
-  Node * ptr = hash_table[index];
-  while (ptr != NULL) {
-    // Traverse chain within bucket until the value is found
-	if (ptr->key == search_key) {
-      // Found the search key!
-	  the_val = ptr->value;
-	  return true;
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename Q, typename>
+bool HashTableCollection<K,V,Hash,Index>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  return find_hashed(search_key, hash_fun(search_key), the_val);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+template<typename Q>
+bool HashTableCollection<K,V,Hash,Index>::find_hashed(const Q& search_key, size_t code, V& the_val) const
+{
+  // The key is either in the current table or an unmigrated old bucket
+  for (int t = 0; t < 2; ++t) {
+    Node* * table = t == 0 ? hash_table : old_table;
+	size_t capacity = t == 0 ? table_capacity : old_capacity;
+	if (!table) {
+	  continue;
 	}
-	ptr = ptr->next;
+    size_t index = index_fun(code, capacity); // calculate the index
+  
+    Node * ptr = table[index];
+    while (ptr != NULL) {
+      COLLECTION_COUNT(NODES_VISITED, 1);
+      // Traverse chain within bucket until the value is found
+	  if (ptr->key == search_key) {
+        // Found the search key!
+	    the_val = ptr->value;
+	    return true;
+	  }
+	  ptr = ptr->next;
+    }
   }
   
   // Program only reaches this point if no key is found in the chain
@@ -224,54 +396,204 @@ bool HashTableCollection<K,V>::find(const K& search_key, V& the_val) const
   return false;
 }
 
-template<typename K,typename V>
-void HashTableCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
-  // First key value pair has been located
-  for (size_t i = 0; i < table_capacity; ++i) {
-    Node * ptr = hash_table[i];
-    while (ptr != NULL) {
-	  // Traverse the list until the second key value pair is found
-	  if (ptr->key >= k1 && ptr->key <= k2) {
-	    // Add all elements which fall in the range
-		keys.add(ptr->key);
+  COLLECTION_TIME(OP_FIND_RANGE);
+  // Check every bucket of both tables
+  for (int t = 0; t < 2; ++t) {
+    Node* * table = t == 0 ? hash_table : old_table;
+	size_t capacity = t == 0 ? table_capacity : old_capacity;
+    for (size_t i = 0; table && i < capacity; ++i) {
+      Node * ptr = table[i];
+      while (ptr != NULL) {
+	    // Traverse the list until the second key value pair is found
+	    if (ptr->key >= k1 && ptr->key <= k2) {
+	      // Add all elements which fall in the range
+		  keys.add(ptr->key);
+	    }
+	    ptr = ptr->next;
 	  }
-	  ptr = ptr->next;
-	}
+    }
   }
 
 }
 
-template<typename K,typename V>
-void HashTableCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::keys(ArrayList<K>& all_keys) const
 {
-  // First key value pair has been located
-  for (size_t i = 0; i < table_capacity; ++i) {
-    Node * ptr = hash_table[i];
-    while (ptr != NULL) {
-	  // Traverse the list until all keys are added
-	  all_keys.add(ptr->key);
-	  ptr = ptr->next;
-	}
+  // Check every bucket of both tables
+  for (int t = 0; t < 2; ++t) {
+    Node* * table = t == 0 ? hash_table : old_table;
+	size_t capacity = t == 0 ? table_capacity : old_capacity;
+    for (size_t i = 0; table && i < capacity; ++i) {
+      Node * ptr = table[i];
+      while (ptr != NULL) {
+	    // Traverse the list until all keys are added
+	    all_keys.add(ptr->key);
+	    ptr = ptr->next;
+	  }
+    }
   }
 }
 
-template<typename K,typename V>
-void HashTableCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::sort(ArrayList<K>& all_keys_sorted) const
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
-  all_keys_sorted.sort();
+  sort_keys(all_keys_sorted);
 }
 
-template<typename K,typename V>
-size_t HashTableCollection<K,V>::size() const
+template<typename K, typename V, typename Hash, typename Index>
+size_t HashTableCollection<K,V,Hash,Index>::size() const
 {
   return length;
 }
 
-template<typename K,typename V>
-size_t HashTableCollection<K,V>::min_chain_length()
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::add_batch(const K* keys, const V* vals, size_t n)
+{
+  // The same migration work n single adds would have done
+  for (size_t i = 0; i < n && old_table; ++i) {
+    migrate_step();
+  }
+  // Grow once for the whole batch, so no add in it has to rehash
+  if (static_cast<double>(length + n) / table_capacity >= load_factor_threshold) {
+    resize_and_rehash(static_cast<size_t>((length + n) / load_factor_threshold) + 1);
+  }
+  size_t codes[BATCH_WIDTH];
+  for (size_t start = 0; start < n; start += BATCH_WIDTH) {
+    size_t width = n - start < BATCH_WIDTH ? n - start : BATCH_WIDTH;
+    // Hash the group and request each bucket it is about to write
+    for (size_t j = 0; j < width; ++j) {
+      codes[j] = hash_fun(keys[start + j]);
+      prefetch(&hash_table[index_fun(codes[j], table_capacity)], true);
+    }
+    for (size_t j = 0; j < width; ++j) {
+      add_hashed(keys[start + j], vals[start + j], codes[j]);
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t HashTableCollection<K,V,Hash,Index>::find_batch(const K* keys, size_t n, V* vals, bool* found) const
 {
+  size_t found_count = 0;
+  size_t codes[BATCH_WIDTH];
+  for (size_t start = 0; start < n; start += BATCH_WIDTH) {
+    size_t width = n - start < BATCH_WIDTH ? n - start : BATCH_WIDTH;
+    // Two passes ahead of the searches: request every bucket, then
+    // (once they have had time to arrive) the first node of each chain
+    for (size_t j = 0; j < width; ++j) {
+      codes[j] = hash_fun(keys[start + j]);
+      prefetch(&hash_table[index_fun(codes[j], table_capacity)]);
+    }
+    for (size_t j = 0; j < width; ++j) {
+      Node * head = hash_table[index_fun(codes[j], table_capacity)];
+      if (head != NULL) {
+        prefetch(head);
+      }
+    }
+    for (size_t j = 0; j < width; ++j) {
+      found[start + j] = find_hashed(keys[start + j], codes[j], vals[start + j]);
+      if (found[start + j]) {
+        ++found_count;
+      }
+    }
+  }
+  return found_count;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::remove_batch(const K* keys, size_t n)
+{
+  for (size_t i = 0; i < n && old_table; ++i) {
+    migrate_step();
+  }
+  size_t codes[BATCH_WIDTH];
+  for (size_t start = 0; start < n; start += BATCH_WIDTH) {
+    size_t width = n - start < BATCH_WIDTH ? n - start : BATCH_WIDTH;
+    for (size_t j = 0; j < width; ++j) {
+      codes[j] = hash_fun(keys[start + j]);
+      prefetch(&hash_table[index_fun(codes[j], table_capacity)], true);
+    }
+    for (size_t j = 0; j < width; ++j) {
+      Node * head = hash_table[index_fun(codes[j], table_capacity)];
+      if (head != NULL) {
+        prefetch(head);
+      }
+    }
+    for (size_t j = 0; j < width; ++j) {
+      remove_hashed(keys[start + j], codes[j]);
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> HashTableCollection<K,V,Hash,Index>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(*this));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> HashTableCollection<K,V,Hash,Index>::lower_bound(const K& k) const
+{
+  // Unordered, so every pair has to be checked against the bound
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, false));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+CollectionIterator<K,V> HashTableCollection<K,V,Hash,Index>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, true));
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+HashTableCollection<K,V,Hash,Index>::Cursor::Cursor(const HashTableCollection<K,V,Hash,Index>& a_table)
+  : table(a_table), t(0), index(0), ptr(nullptr)
+{
+  next_bucket();
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::Cursor::next()
+{
+  ptr = ptr->next;
+  if (ptr == nullptr) {
+    next_bucket();
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::Cursor::next_bucket()
+{
+  while (ptr == nullptr && t < 2) {
+    Node* const * buckets = t == 0 ? table.hash_table : table.old_table;
+    size_t capacity = t == 0 ? table.table_capacity : table.old_capacity;
+    if (buckets != nullptr && index < capacity) {
+      ptr = buckets[index];
+      ++index;
+    }
+    else {
+      // Done with this table, so go on to the old one (if any)
+      ++t;
+      index = 0;
+    }
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+bool HashTableCollection<K,V,Hash,Index>::migrating() const
+{
+  return old_table != nullptr;
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t HashTableCollection<K,V,Hash,Index>::min_chain_length()
+{
+  // Statistics are over the fully migrated table
+  finish_migration();
   // The maximum possible length any one chain could be is the value of length
   size_t min_chain = length;
   size_t curr_chain = 0;
@@ -291,9 +613,11 @@ size_t HashTableCollection<K,V>::min_chain_length()
   return min_chain;
 }
 
-template<typename K,typename V>
-size_t HashTableCollection<K,V>::max_chain_length()
+template<typename K, typename V, typename Hash, typename Index>
+size_t HashTableCollection<K,V,Hash,Index>::max_chain_length()
 {
+  // Statistics are over the fully migrated table
+  finish_migration();
   // The minimum possible length any one chain could be is the value of 0
   size_t max_chain = 0;
   size_t curr_chain = 0;
@@ -313,8 +637,8 @@ size_t HashTableCollection<K,V>::max_chain_length()
   return max_chain;
 }
 
-template<typename K,typename V>
-double HashTableCollection<K,V>::avg_chain_length()
+template<typename K, typename V, typename Hash, typename Index>
+double HashTableCollection<K,V,Hash,Index>::avg_chain_length()
 {
   double avg_length;
   avg_length = static_cast<double>(length) / table_capacity;
@@ -322,65 +646,131 @@ double HashTableCollection<K,V>::avg_chain_length()
   return avg_length;
 }
 
-template<typename K,typename V>
-void HashTableCollection<K,V>::resize_and_rehash()
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::chain_length_histogram(ArrayList<size_t>& counts)
+{
+  // Statistics are over the fully migrated table
+  finish_migration();
+  counts = ArrayList<size_t>();
+  for (size_t i = 0; i < table_capacity; ++i) {
+    size_t curr_chain = 0;
+    for (Node * ptr = hash_table[i]; ptr != NULL; ptr = ptr->next) {
+      ++curr_chain;
+    }
+    while (counts.size() <= curr_chain) {
+      counts.add(0);
+    }
+    ++counts[curr_chain];
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+size_t HashTableCollection<K,V,Hash,Index>::memory_bytes() const
 {
-  int new_length = 0;
-  // Creates new array of double capacity, and storing the items
-  Node* * new_hash_table = new Node*[table_capacity * 2];
+  return (table_capacity + old_capacity) * sizeof(Node*) + length * sizeof(Node);
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::resize_and_rehash(size_t min_capacity)
+{
+  COLLECTION_COUNT(REHASHES, 1);
+  // A migration still in progress must complete before growing again
+  // (migrate_step paces the moves so normally none are left)
+  finish_migration();
+  
+  // Creates new array of double capacity (or more, to reach min_capacity)
+  size_t new_capacity = table_capacity * 2;
+  while (new_capacity < min_capacity) {
+    new_capacity = new_capacity * 2;
+  }
+  Node* * new_hash_table = new Node*[new_capacity];
   // Confirm that all the head nodes in the table are set to NULL
-  for (size_t i = 0; i < table_capacity * 2; ++i) {
+  for (size_t i = 0; i < new_capacity; ++i) {
     new_hash_table[i] = NULL;
   }
   
-  for (size_t i = 0; i < table_capacity; ++i) {
-    Node * ptr = hash_table[i];
-    while (ptr != NULL) {
-	  Node * new_node = new Node;
-      new_node->key = ptr->key;	  
-	  new_node->value = ptr->value;
-	  // Adding each key and value pair from the old hash table to the new one
-	  // Find the location where to has the node to
-      size_t code = hash_fun(new_node->key); // get int - based value for key
-      size_t index = code % (table_capacity * 2); // calculate the index
+  // The current table becomes the old table, whose buckets are
+  // relinked (not copied) into the new one
+  old_table = hash_table;
+  old_capacity = table_capacity;
+  migrate_index = 0;
+  hash_table = new_hash_table;
+  // Adjust the size of the table capacity to the correct size
+  table_capacity = new_capacity;
   
-      // Now insert at the front of the linked list, adjusting all other potential elements
-      if (new_hash_table[index] == NULL) {
-        new_hash_table[index] = new_node;
-	    new_node->next = NULL;
-      }
-      else {
-        new_node->next = new_hash_table[index];
-        new_hash_table[index] = new_node;
-      }
-	  ++new_length;
-	  ptr = ptr->next;
-	}
+  if (migration_budget == 0) {
+    // Stop-the-world: move every bucket right now
+    finish_migration();
   }
-  
-  // Deleting the old array
-  if (hash_table != NULL) {
-    for (size_t i = 0; i < table_capacity; ++i) {
-	  Node * ptr = hash_table[i];
-	  Node * next_ptr = NULL;
-	  while (ptr != NULL) {
-	    next_ptr = ptr->next;
-	    delete ptr;
-	    ptr = next_ptr;
-	  }
-    }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::migrate_step()
+{
+  if (!old_table) {
+    return;
   }
-  for (size_t i = 0; i < table_capacity; ++i) {
-    hash_table[i] = NULL;
+  // The table grows again once the load factor threshold is reached,
+  // so the remaining old buckets are spread over the adds until then
+  size_t remaining = old_capacity - migrate_index;
+  double headroom = load_factor_threshold * table_capacity - length;
+  size_t adds_left = headroom > 1 ? static_cast<size_t>(headroom) : 1;
+  size_t count = (remaining + adds_left - 1) / adds_left;
+  if (count < migration_budget) {
+    count = migration_budget;
   }
-  // Adjust the size of the table capacity to the correct size
-  table_capacity = table_capacity * 2;
-  // Creating a new array with the new capacity
-  hash_table = new Node *[table_capacity];
-  // Readding the array values
-  hash_table = new_hash_table;
-  // Confirm that the length is accurate
-  length = new_length;
+  for (size_t moved = 0; old_table && moved < count; ++moved) {
+    migrate_bucket(migrate_index);
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::finish_migration()
+{
+  while (old_table) {
+    migrate_bucket(migrate_index);
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::migrate_bucket(size_t index)
+{
+  Node * ptr = old_table[index];
+  while (ptr != NULL) {
+    Node * next_ptr = ptr->next;
+    // Find the location in the new table and insert at the front
+    size_t new_index = index_fun(hash_fun(ptr->key), table_capacity);
+    ptr->next = hash_table[new_index];
+    hash_table[new_index] = ptr;
+    ptr = next_ptr;
+  }
+  old_table[index] = NULL;
+  migrate_index = index + 1;
+  if (migrate_index == old_capacity) {
+    // Every bucket has been moved, so the old table can go
+    delete [] old_table;
+    old_table = NULL;
+    old_capacity = 0;
+    migrate_index = 0;
+  }
+}
+
+template<typename K, typename V, typename Hash, typename Index>
+void HashTableCollection<K,V,Hash,Index>::make_empty(Node* * table, size_t capacity)
+{
+  if (table == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < capacity; ++i) {
+    Node * ptr = table[i];
+	Node * next_ptr = NULL;
+    while (ptr != NULL) {
+	  next_ptr = ptr->next;
+	  delete ptr;
+	  ptr = next_ptr;
+	}
+  }
+  delete [] table;
 }
 
 
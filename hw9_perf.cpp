@@ -11,10 +11,34 @@
 //     3 = find value
 //     4 = find range
 //     5 = sort
-//     6 = statistics
+//     6 = statistics (tree heights, chain lengths, and hash table
+//         bytes per key, node-based vs compact)
+//     7 = worst-case add (stop-the-world vs incremental rehash)
+//     8 = tree build time and memory (heap nodes vs node pool)
+//     9 = tree build time (add loop vs bulk load)
+//    10 = key copies and moves per add (copying vs moving add)
+//    11 = ArrayList sort algorithms
+//    12 = radix sort vs comparison sorts (string and integer keys)
+//    13 = multithreaded hash table throughput (lock stripes vs one mutex)
+//    14 = red-black tree reads during writes (copy-on-write vs rw lock)
+//    15 = AVL tree snapshots (persistent snapshot vs deep copy)
+//    16 = wide range queries (buffered find range vs streaming scan)
+//    17 = range counts (find range size vs subtree-size count)
+//    18 = batch operations (batch size sweep)
+//    19 = virtual vs static dispatch (Collection& vs StaticCollection)
+//    20 = latency histograms and counters (needs a build with
+//         COLLECTION_INSTRUMENTATION, see instrumentation.h)
+//    21 = hardware counters (cache, branch, and TLB misses and
+//         instructions per cycle, see perf_counters.h)
+//    22 = YCSB-style mixed workloads (see workload.h)
 // Output consists of average operation times for different sized
 // input lists for both implementations, except for test 6, which
-// prints statistics information.
+// prints statistics information. Tests 1-3 also time the open
+// addressing SwissTableCollection against the chained hash table, and
+// tests 1-6 include the BPlusTreeCollection. Tests 1-5 use the
+// benchmark harness (benchmark.h), so after the mean times they also
+// print the median, 99th percentile, standard deviation, and
+// operations per second of each collection.
 //----------------------------------------------------------------------
 
 
@@ -25,13 +49,35 @@
 #include <chrono>
 #include <string>
 #include <cassert>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include "collection.h"
 #include "array_list_collection.h"
 #include "bin_search_collection.h"
 #include "hash_table_collection.h"
+#include "compact_hash_table_collection.h"
 #include "bst_collection.h"
 #include "avl_collection.h"
 #include "rbt_collection.h"
+#include "swiss_table_collection.h"
+#include "node_pool.h"
+#include "bplus_tree_collection.h"
+#include "radix_sort.h"
+#include "concurrent_hash_table_collection.h"
+#include "concurrent_rbt_collection.h"
+#include "persistent_avl_collection.h"
+#include "static_collection.h"
+#include "benchmark.h"
+#include "perf_counters.h"
+#include "workload.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 using namespace std;
 using namespace std::chrono;
@@ -47,20 +93,81 @@ const int HASHTABLE = 2;
 const int BINSEARCHTREE = 3;
 const int AVLSEARCHTREE = 4;
 const int RBTSEARCHTREE = 5;
+const int SWISSTABLE = 6;
+const int BPLUSTREE = 7;
+
+// String key that counts how often keys are copied and moved
+struct CountedString {
+  static size_t copies;
+  static size_t moves;
+  string str;
+  CountedString() {}
+  CountedString(const CountedString& rhs) : str(rhs.str) {++copies;}
+  CountedString(CountedString&& rhs) : str(std::move(rhs.str)) {++moves;}
+  CountedString& operator=(const CountedString& rhs) {str = rhs.str; ++copies; return *this;}
+  CountedString& operator=(CountedString&& rhs) {str = std::move(rhs.str); ++moves; return *this;}
+  bool operator==(const CountedString& rhs) const {return str == rhs.str;}
+  bool operator!=(const CountedString& rhs) const {return str != rhs.str;}
+  bool operator<(const CountedString& rhs) const {return str < rhs.str;}
+  bool operator>(const CountedString& rhs) const {return str > rhs.str;}
+  bool operator<=(const CountedString& rhs) const {return str <= rhs.str;}
+  bool operator>=(const CountedString& rhs) const {return str >= rhs.str;}
+};
+size_t CountedString::copies = 0;
+size_t CountedString::moves = 0;
+
+namespace std {
+  template<>
+  struct hash<CountedString> {
+    size_t operator()(const CountedString& k) const {return hash<string>()(k.str);}
+  };
+}
 
 // Helper functions: 
 unsigned long sum(unsigned long array[], size_t n);
 void create_pairs(pair<string,int> array[], size_t n); 
 string get_ith_key(size_t i, size_t n);
 void print(const Collection<string,int>& coll);
+Collection<string,int>* new_collection(int type);
+Collection<string,int>* new_pooled_collection(int type);
+long resident_kb();
+void print_stats_header(size_t first_column, size_t n);
+void print_stats(const BenchmarkResult results[], size_t n);
   
 // Test cases:
-double add(pair<string,int> array[], size_t size, int type);
-double remove(pair<string,int> array[], size_t size, int type);
-double find_value(pair<string,int> array[], size_t size, int type);
-double find_range(pair<string,int> array[], size_t size, int type);
-double sort(pair<string,int> array[], size_t size, int type);
+BenchmarkResult add(pair<string,int> array[], size_t size, int type);
+BenchmarkResult remove(pair<string,int> array[], size_t size, int type);
+BenchmarkResult find_value(pair<string,int> array[], size_t size, int type);
+BenchmarkResult find_range(pair<string,int> array[], size_t size, int type);
+BenchmarkResult sort(pair<string,int> array[], size_t size, int type);
 size_t stats(pair<string,int> array[], size_t size, int type);
+void chain_histogram(pair<string,int> array[], size_t size, bool wyhash_mask,
+                     size_t counts[], size_t bins);
+double bytes_per_key(pair<string,int> array[], size_t size, bool compact);
+double max_add(pair<string,int> array[], size_t size, size_t migration_budget);
+void build(pair<string,int> array[], size_t size, int type, bool pooled,
+           double& time, long& rss);
+double bulk_load(const ArrayList<pair<string,int>>& kv_pairs, int type);
+void count_copies(pair<string,int> array[], size_t size, int type, bool move,
+                  double& copies, double& moves);
+double sort_list(pair<string,int> array[], size_t size, int algorithm, bool presorted);
+double parallel_sort(pair<string,int> array[], size_t size, size_t threads);
+template<typename T>
+double radix_compare(const ArrayList<T>& keys, int algorithm);
+double throughput(pair<string,int> array[], size_t size, size_t threads, bool striped);
+void mixed_throughput(pair<string,int> array[], size_t size, size_t readers,
+                      bool copy_on_write, double& reads, double& writes);
+void snapshot_cost(pair<string,int> array[], size_t size, bool persistent,
+                   double& snapshot_time, double& add_time);
+double range_scan(pair<string,int> array[], size_t size, int type, bool streaming,
+                  size_t& buffer_bytes);
+double range_count(pair<string,int> array[], size_t size, int type, bool counting);
+void batch_sweep(pair<string,int> array[], size_t size, size_t batch, double times[]);
+double dispatch(pair<string,int> array[], size_t size, int type, bool static_dispatch);
+void instrumented(pair<string,int> array[], size_t size, int type);
+void counted(pair<string,int> array[], size_t size, int type, HardwareCounters& counters,
+             double add_stats[], double find_stats[]);
+void run_workload(const Workload& workload, int type, double stats[]);
 
 
 // Test driver:
@@ -69,7 +176,7 @@ int main(int argc, char* argv[])
 
   // check command line args
   if (argc != 2) {
-    cerr << "usage: " << argv[0] << " test-number (1-6)" << endl;
+    cerr << "usage: " << argv[0] << " test-number (1-22)" << endl;
     exit(1);
   }
   string test_number = argv[1];
@@ -86,106 +193,529 @@ int main(int argc, char* argv[])
   const size_t STOP = 300000;
   const size_t STEP = 10000; 
   
+  // tests 1-5: one operation over each collection type (the means are
+  // in columns 2 on, as the plot scripts expect, and the rest of each
+  // result follows the other columns)
   // test 1: add operation
   if (test_number.compare("1") == 0) {
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, SWISSTABLE, BPLUSTREE};
     cout << "# Column 1 = Input data size" << endl
          << "# Column 2 = Avg time for HashTableCollection add function\n"
          << "# Column 3 = Avg time for AVLCollection add function\n"
          << "# Column 4 = Avg time for RBTCollection add function\n"
-         << "# All times are measured in milliseconds" << endl;
-    int i = 0;
+         << "# Column 5 = Avg time for SwissTableCollection add function\n"
+         << "# Column 6 = Avg time for BPlusTreeCollection add function" << endl;
+    print_stats_header(7, 5);
     for (size_t size = START; size <= STOP; size += STEP) {
-      double avg1 = add(array, size, HASHTABLE);
-      double avg2 = add(array, size, AVLSEARCHTREE);
-      double avg3 = add(array, size, RBTSEARCHTREE);
-      cout << size << " "
-           << (avg1/1000.0) << " "
-           << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+      BenchmarkResult results[5];
+      cout << size;
+      for (int t = 0; t < 5; ++t) {
+        results[t] = add(array, size, types[t]);
+        cout << " " << (results[t].mean/1000.0);
+      }
+      print_stats(results, 5);
+      cout << endl;
     }
   }
   // test 2: remove operation
   else if (test_number.compare("2") == 0) {
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, SWISSTABLE, BPLUSTREE};
     cout << "# Column 1 = Input data size" << endl
          << "# Column 2 = Avg time for HashTableCollection remove function\n"
          << "# Column 3 = Avg time for AVLCollection remove function\n"
          << "# Column 4 = Avg time for RBTCollection remove function\n"
-         << "# All times are measured in microseconds" << endl;
+         << "# Column 5 = Avg time for SwissTableCollection remove function\n"
+         << "# Column 6 = Avg time for BPlusTreeCollection remove function" << endl;
+    print_stats_header(7, 5);
     for (size_t size = START; size <= STOP; size += STEP) {
-      double avg1 = remove(array, size, HASHTABLE);
-      double avg2 = remove(array, size, AVLSEARCHTREE);
-      double avg3 = remove(array, size, RBTSEARCHTREE);      
-      cout << size << " "
-           << (avg1/1000.0) << " "
-           << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+      BenchmarkResult results[5];
+      cout << size;
+      for (int t = 0; t < 5; ++t) {
+        results[t] = remove(array, size, types[t]);
+        cout << " " << (results[t].mean/1000.0);
+      }
+      print_stats(results, 5);
+      cout << endl;
     }
   }
   // test 3: find-value operation
   else if (test_number.compare("3") == 0) {
-    // const size_t START = 0;            // initial test data size
-    // const size_t STOP = 35000;         // max test data size
-    // const size_t STEP = 1024;          // data size increments
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, SWISSTABLE, BPLUSTREE};
     cout << "# Column 1 = Input data size" << endl
          << "# Column 2 = Avg time for HashTableCollection find-value function\n"
          << "# Column 3 = Avg time for AVLCollection find-value function\n"
          << "# Column 4 = Avg time for RBTCollection find-value function\n"
-         << "# All times are measured in microseconds" << endl;
+         << "# Column 5 = Avg time for SwissTableCollection find-value function\n"
+         << "# Column 6 = Avg time for BPlusTreeCollection find-value function" << endl;
+    print_stats_header(7, 5);
     for (size_t size = START; size <= STOP; size += STEP) {
-      double avg1 = find_value(array, size, HASHTABLE);
-      double avg2 = find_value(array, size, AVLSEARCHTREE);
-      double avg3 = find_value(array, size, RBTSEARCHTREE);
-      cout << size << " "
-           << (avg1/1000.0) << " "
-           << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;        
+      BenchmarkResult results[5];
+      cout << size;
+      for (int t = 0; t < 5; ++t) {
+        results[t] = find_value(array, size, types[t]);
+        cout << " " << (results[t].mean/1000.0);
+      }
+      print_stats(results, 5);
+      cout << endl;
     }
   }
   // test 4: find-range operation
   else if (test_number.compare("4") == 0) {
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, BPLUSTREE};
     cout << "# Column 1 = Input data size" << endl
          << "# Column 2 = Avg time for HashTableCollection find-range function\n"
          << "# Column 3 = Avg time for AVLCollection find-range function\n"
          << "# Column 4 = Avg time for RBTCollection find-range function\n"
-         << "# All times are measured in microseconds" << endl;
+         << "# Column 5 = Avg time for BPlusTreeCollection find-range function" << endl;
+    print_stats_header(6, 4);
     for (size_t size = START; size <= STOP; size += STEP) {
-      double avg1 = find_range(array, size, HASHTABLE);
-      double avg2 = find_range(array, size, AVLSEARCHTREE);
-      double avg3 = find_range(array, size, RBTSEARCHTREE);
-      cout << size << " "
-           << (avg1/1000.0) << " "
-           << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+      BenchmarkResult results[4];
+      cout << size;
+      for (int t = 0; t < 4; ++t) {
+        results[t] = find_range(array, size, types[t]);
+        cout << " " << (results[t].mean/1000.0);
+      }
+      print_stats(results, 4);
+      cout << endl;
     }
   }
   // test 5: sort operation
   else if (test_number.compare("5") == 0) {
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, BPLUSTREE};
     cout << "# Column 1 = Input data size" << endl
          << "# Column 2 = Avg time for HashTableCollection sort function\n"
          << "# Column 3 = Avg time for AVLCollection sort function\n"
          << "# Column 4 = Avg time for RBTCollection sort function\n"
-         << "# All times are measured in microseconds" << endl;
+         << "# Column 5 = Avg time for BPlusTreeCollection sort function\n"
+         << "# Columns 6-11 = Speedup of ArrayList parallel_sort with 2, 4, 8,"
+         << " 16, 32, and 64 threads over 1 thread" << endl;
+    print_stats_header(12, 4);
     for (size_t size = START; size <= STOP; size += STEP) {
-      double avg1 = sort(array, size, HASHTABLE);
-      double avg2 = sort(array, size, AVLSEARCHTREE);
-      double avg3 = sort(array, size, RBTSEARCHTREE);
-      cout << size << " "
-           << (avg1/1000.0) << " "
-           << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+      BenchmarkResult results[4];
+      cout << size;
+      for (int t = 0; t < 4; ++t) {
+        results[t] = sort(array, size, types[t]);
+        cout << " " << (results[t].mean/1000.0);
+      }
+      double serial = parallel_sort(array, size, 1);
+      for (size_t threads = 2; threads <= 64; threads *= 2) {
+        double parallel = parallel_sort(array, size, threads);
+        cout << " " << (parallel > 0 ? serial / parallel : 1.0);
+      }
+      print_stats(results, 4);
+      cout << endl;
     }
   }
   // test 6: statistics information
   else if (test_number.compare("6") == 0) {
     cout << "# Column 1 = Input data size\n" 
          << "# Column 2 = Height for AVLCollection\n"
-         << "# Column 3 = Height for RBTCollection" << endl;
+         << "# Column 3 = Height for RBTCollection\n"
+         << "# Column 4 = Height for BPlusTreeCollection\n"
+         << "# Column 5-12 = HashTableCollection buckets with chain length 0-6 and 7+\n"
+         << "# Column 13-20 = The same for HashTableCollection<WyHash,MaskIndex>\n"
+         << "# Column 21 = Payload (key and value) bytes per key\n"
+         << "# Column 22 = Heap bytes per key for HashTableCollection\n"
+         << "# Column 23 = Heap bytes per key for CompactHashTableCollection" << endl;
+    const size_t BINS = 8;
     for (size_t size = START; size <= STOP; size += STEP) {
       size_t height1 = stats(array, size, AVLSEARCHTREE);
       size_t height2 = stats(array, size, RBTSEARCHTREE);
+      size_t height3 = stats(array, size, BPLUSTREE);
+      size_t counts[2][BINS];
+      chain_histogram(array, size, false, counts[0], BINS);
+      chain_histogram(array, size, true, counts[1], BINS);
       cout << size << " "
            << height1 << " " 
-           << height2 << endl;
+           << height2 << " "
+           << height3;
+      for (int h = 0; h < 2; ++h)
+        for (size_t i = 0; i < BINS; ++i)
+          cout << " " << counts[h][i];
+      cout << " " << sizeof(string) + sizeof(int)
+           << " " << bytes_per_key(array, size, false)
+           << " " << bytes_per_key(array, size, true);
+      cout << endl;
+    }
+  }
+  // test 7: worst-case add while the hash table grows
+  else if (test_number.compare("7") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Max add time for HashTableCollection (stop-the-world rehash)\n"
+         << "# Column 3 = Max add time for HashTableCollection (incremental rehash, budget 4)\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double max1 = max_add(array, size, 0);
+      double max2 = max_add(array, size, 4);
+      cout << size << " "
+           << (max1/1000.0) << " "
+           << (max2/1000.0) << endl;
+    }
+  }
+  // test 8: tree build time and memory with and without a node pool
+  else if (test_number.compare("8") == 0) {
+    const int trees[] = {AVLSEARCHTREE, RBTSEARCHTREE};
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2-3 = Build time for AVLCollection (heap, pool)\n"
+         << "# Column 4-5 = Build time for RBTCollection (heap, pool)\n"
+         << "# Column 6-9 = Resident memory added by each build above\n"
+         << "# Times are in milliseconds, memory is in kilobytes" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double times[4];
+      long rss[4];
+      for (int t = 0; t < 2; ++t) {
+        build(array, size, trees[t], false, times[2*t], rss[2*t]);
+        build(array, size, trees[t], true, times[2*t+1], rss[2*t+1]);
+      }
+      cout << size;
+      for (int i = 0; i < 4; ++i)
+        cout << " " << (times[i]/1000.0);
+      for (int i = 0; i < 4; ++i)
+        cout << " " << rss[i];
+      cout << endl;
+    }
+  }
+  // test 9: building trees with add() versus bulk loading
+  else if (test_number.compare("9") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Build time for AVLCollection (add loop)\n"
+         << "# Column 3 = Build time for AVLCollection (bulk load, unsorted input)\n"
+         << "# Column 4 = Build time for AVLCollection (bulk load, sorted input)\n"
+         << "# Column 5 = Build time for RBTCollection (add loop)\n"
+         << "# Column 6 = Build time for RBTCollection (bulk load, unsorted input)\n"
+         << "# Column 7 = Build time for RBTCollection (bulk load, sorted input)\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      ArrayList<pair<string,int>> unsorted_pairs;
+      for (size_t i = 0; i < size; ++i)
+        unsorted_pairs.add(array[i]);
+      ArrayList<pair<string,int>> sorted_pairs(unsorted_pairs);
+      sorted_pairs.sort();
+      double times[6];
+      long rss;
+      build(array, size, AVLSEARCHTREE, false, times[0], rss);
+      times[1] = bulk_load(unsorted_pairs, AVLSEARCHTREE);
+      times[2] = bulk_load(sorted_pairs, AVLSEARCHTREE);
+      build(array, size, RBTSEARCHTREE, false, times[3], rss);
+      times[4] = bulk_load(unsorted_pairs, RBTSEARCHTREE);
+      times[5] = bulk_load(sorted_pairs, RBTSEARCHTREE);
+      cout << size;
+      for (int i = 0; i < 6; ++i)
+        cout << " " << (times[i]/1000.0);
+      cout << endl;
+    }
+  }
+  // test 10: key copies and moves made by add(const K&, const V&)
+  // versus add(K&&, V&&)
+  else if (test_number.compare("10") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Columns 2-4 = HashTableCollection copies per add (copying add),"
+         << " copies and moves per add (moving add)\n"
+         << "# Columns 5-7 = AVLCollection (same three counts)\n"
+         << "# Columns 8-10 = RBTCollection (same three counts)\n"
+         << "# Columns 11-13 = BPlusTreeCollection (same three counts)" << endl;
+    int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE, BPLUSTREE};
+    for (size_t size = START; size <= STOP; size += STEP) {
+      cout << size;
+      for (int type : types) {
+        double copies, moves, move_copies, move_moves;
+        count_copies(array, size, type, false, copies, moves);
+        count_copies(array, size, type, true, move_copies, move_moves);
+        cout << " " << copies << " " << move_copies << " " << move_moves;
+      }
+      cout << endl;
+    }
+  }
+  // test 11: sort algorithms on a list of keys
+  else if (test_number.compare("11") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time for ArrayList quick_sort\n"
+         << "# Column 3 = Avg time for ArrayList merge_sort\n"
+         << "# Column 4 = Avg time for ArrayList heap_sort\n"
+         << "# Column 5 = Avg time for ArrayList intro_sort\n"
+         << "# Column 6 = Avg time for ArrayList intro_sort (already sorted keys)\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      cout << size;
+      for (int algorithm = 0; algorithm < 4; ++algorithm)
+        cout << " " << sort_list(array, size, algorithm, false)/1000.0;
+      cout << " " << sort_list(array, size, 3, true)/1000.0 << endl;
+    }
+  }
+  // test 12: radix sort against the comparison sorts
+  else if (test_number.compare("12") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time for quick_sort (string keys)\n"
+         << "# Column 3 = Avg time for intro_sort (string keys)\n"
+         << "# Column 4 = Avg time for radix_sort (string keys)\n"
+         << "# Column 5 = Avg time for quick_sort (int keys)\n"
+         << "# Column 6 = Avg time for intro_sort (int keys)\n"
+         << "# Column 7 = Avg time for radix_sort (int keys)\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      ArrayList<string> string_keys(size);
+      ArrayList<int> int_keys(size);
+      for (size_t i = 0; i < size; ++i) {
+        string_keys.add(array[i].first);
+        int_keys.add(array[i].second);
+      }
+      cout << size;
+      for (int algorithm = 0; algorithm < 3; ++algorithm)
+        cout << " " << radix_compare(string_keys, algorithm)/1000.0;
+      for (int algorithm = 0; algorithm < 3; ++algorithm)
+        cout << " " << radix_compare(int_keys, algorithm)/1000.0;
+      cout << endl;
+    }
+  }
+  // test 13: aggregate throughput of a mixed find/remove/add workload
+  else if (test_number.compare("13") == 0) {
+    size_t max_threads = thread::hardware_concurrency();
+    if (max_threads < 4)
+      max_threads = 4;
+    cout << "# Column 1 = Number of threads\n"
+         << "# Column 2 = Throughput for ConcurrentHashTableCollection\n"
+         << "# Column 3 = Throughput for HashTableCollection behind one mutex\n"
+         << "# Each thread runs 90% finds and 10% remove/add pairs over "
+         << (STOP/3) << " keys\n"
+         << "# Throughput is measured in millions of operations per second" << endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+      cout << threads << " "
+           << throughput(array, STOP/3, threads, true) << " "
+           << throughput(array, STOP/3, threads, false) << endl;
+    }
+  }
+  // test 14: readers (finds and range scans) alongside one writer
+  else if (test_number.compare("14") == 0) {
+    size_t max_threads = thread::hardware_concurrency();
+    if (max_threads < 4)
+      max_threads = 4;
+    cout << "# Column 1 = Number of reader threads (plus one writer)\n"
+         << "# Column 2 = Read throughput for ConcurrentRBTCollection\n"
+         << "# Column 3 = Write throughput for ConcurrentRBTCollection\n"
+         << "# Column 4 = Read throughput for RBTCollection behind a reader-writer lock\n"
+         << "# Column 5 = Write throughput for RBTCollection behind a reader-writer lock\n"
+         << "# Readers run 90% finds and 10% range finds of 100 keys over "
+         << (STOP/3) << " keys,\n"
+         << "# the writer runs remove/add pairs until the readers finish\n"
+         << "# Throughput is measured in millions of operations per second" << endl;
+    for (size_t readers = 1; readers <= max_threads; readers *= 2) {
+      double cow_reads, cow_writes, locked_reads, locked_writes;
+      mixed_throughput(array, STOP/3, readers, true, cow_reads, cow_writes);
+      mixed_throughput(array, STOP/3, readers, false, locked_reads, locked_writes);
+      cout << readers << " " << cow_reads << " " << cow_writes << " "
+           << locked_reads << " " << locked_writes << endl;
+    }
+  }
+  // test 15: cost of a point-in-time copy of an AVL tree
+  else if (test_number.compare("15") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Snapshot time for PersistentAVLCollection\n"
+         << "# Column 3 = Copy time for AVLCollection\n"
+         << "# Column 4 = Avg add time for PersistentAVLCollection (snapshot held)\n"
+         << "# Column 5 = Avg add time for AVLCollection (copy held)\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double times[4];
+      snapshot_cost(array, size, true, times[0], times[2]);
+      snapshot_cost(array, size, false, times[1], times[3]);
+      cout << size;
+      for (int i = 0; i < 4; ++i)
+        cout << " " << times[i];
+      cout << endl;
+    }
+  }
+  // test 16: summing the values of half the keys
+  else if (test_number.compare("16") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time for AVLCollection find range + find value per key\n"
+         << "# Column 3 = Avg time for AVLCollection scan\n"
+         << "# Column 4 = Avg time for RBTCollection find range + find value per key\n"
+         << "# Column 5 = Avg time for RBTCollection scan\n"
+         << "# Column 6 = Key buffer filled by find range (scan buffers nothing)\n"
+         << "# The range covers the middle half of the key space\n"
+         << "# Times are in microseconds, memory is in kilobytes" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      size_t bytes, none;
+      double avl_find = range_scan(array, size, AVLSEARCHTREE, false, bytes);
+      double avl_scan = range_scan(array, size, AVLSEARCHTREE, true, none);
+      double rbt_find = range_scan(array, size, RBTSEARCHTREE, false, bytes);
+      double rbt_scan = range_scan(array, size, RBTSEARCHTREE, true, none);
+      cout << size << " " << avl_find << " " << avl_scan << " "
+           << rbt_find << " " << rbt_scan << " " << bytes / 1024.0 << endl;
+    }
+  }
+  // test 17: counting the keys in half of the key space
+  else if (test_number.compare("17") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time for AVLCollection find range size\n"
+         << "# Column 3 = Avg time for AVLCollection count\n"
+         << "# Column 4 = Avg time for RBTCollection find range size\n"
+         << "# Column 5 = Avg time for RBTCollection count\n"
+         << "# The range covers the middle half of the key space\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      cout << size << " "
+           << range_count(array, size, AVLSEARCHTREE, false) << " "
+           << range_count(array, size, AVLSEARCHTREE, true) << " "
+           << range_count(array, size, RBTSEARCHTREE, false) << " "
+           << range_count(array, size, RBTSEARCHTREE, true) << endl;
+    }
+  }
+  // test 18: adding, finding, and removing keys a batch at a time
+  else if (test_number.compare("18") == 0) {
+    cout << "# Column 1 = Batch size (1 = one key at a time through Collection)\n"
+         << "# Column 2 = Avg time per key for HashTableCollection add_batch\n"
+         << "# Column 3 = Avg time per key for HashTableCollection find_batch\n"
+         << "# Column 4 = Avg time per key for HashTableCollection remove_batch\n"
+         << "# Column 5 = Avg time per key for AVLCollection find_batch\n"
+         << "# Column 6 = Avg time per key for RBTCollection find_batch\n"
+         << "# Every run adds, finds, and removes " << (STOP/3) << " keys\n"
+         << "# All times are measured in nanoseconds" << endl;
+    for (size_t batch = 1; batch <= 1024; batch *= 2) {
+      double times[5];
+      batch_sweep(array, STOP/3, batch, times);
+      cout << batch;
+      for (int i = 0; i < 5; ++i)
+        cout << " " << times[i];
+      cout << endl;
+    }
+  }
+  // test 19: the same workload through a Collection& and statically
+  else if (test_number.compare("19") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time per operation for HashTableCollection (virtual)\n"
+         << "# Column 3 = Avg time per operation for HashTableCollection (static)\n"
+         << "# Column 4 = Avg time per operation for SwissTableCollection (virtual)\n"
+         << "# Column 5 = Avg time per operation for SwissTableCollection (static)\n"
+         << "# Column 6 = Avg time per operation for AVLCollection (virtual)\n"
+         << "# Column 7 = Avg time per operation for AVLCollection (static)\n"
+         << "# Operations are adds of every key, then 4 finds and a\n"
+         << "# remove and re-add per key\n"
+         << "# All times are measured in nanoseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      cout << size << " "
+           << dispatch(array, size, HASHTABLE, false) << " "
+           << dispatch(array, size, HASHTABLE, true) << " "
+           << dispatch(array, size, SWISSTABLE, false) << " "
+           << dispatch(array, size, SWISSTABLE, true) << " "
+           << dispatch(array, size, AVLSEARCHTREE, false) << " "
+           << dispatch(array, size, AVLSEARCHTREE, true) << endl;
+    }
+  }
+  // test 20: operation latency histograms of a hash table and a
+  // red-black tree
+  else if (test_number.compare("20") == 0) {
+#ifdef COLLECTION_INSTRUMENTATION
+    const size_t SIZE = 300000;
+    cout << "# Latency histograms for adds of every key, then a find of\n"
+         << "# each key, 100 find ranges, 10 sorts, and a remove of each key\n"
+         << "# Data set 0 (gnuplot index 0) = HashTableCollection\n"
+         << "# Data set 1 (gnuplot index 1) = RBTCollection" << endl;
+    instrumented(array, SIZE, HASHTABLE);
+    cout << endl << endl;
+    instrumented(array, SIZE, RBTSEARCHTREE);
+#else
+    cerr << "error: test 20 needs hw9perf built with COLLECTION_INSTRUMENTATION"
+         << " (cmake -DCOLLECTION_INSTRUMENTATION=ON)" << endl;
+    exit(1);
+#endif
+  }
+  // test 21: where the time of adds and finds goes, by hardware counter
+  else if (test_number.compare("21") == 0) {
+    const int types[] = {HASHTABLE, AVLSEARCHTREE, RBTSEARCHTREE};
+    const char* names[] = {"HashTableCollection", "AVLCollection", "RBTCollection"};
+    const char* ops[] = {"add", "find"};
+    const char* metrics[] = {"Avg time (nanoseconds)", "Instructions per cycle",
+                             "L1 data cache misses", "Last level cache misses",
+                             "Branch misses", "Data TLB misses"};
+    HardwareCounters counters;
+    cout << "# Column 1 = Input data size\n";
+    size_t column = 2;
+    for (int op = 0; op < 2; ++op) {
+      for (int t = 0; t < 3; ++t) {
+        cout << "# Columns " << column << "-" << (column + 5) << " = " << names[t]
+             << " " << ops[op] << ": ";
+        for (int m = 0; m < 6; ++m) {
+          cout << metrics[m] << (m < 5 ? ", " : "\n");
+        }
+        column += 6;
+      }
+    }
+    cout << "# Times and misses are per operation, over adds of every key\n"
+         << "# and then a find of each key\n";
+    if (!counters.available(HW_CYCLES) || !counters.available(HW_INSTRUCTIONS) ||
+        !counters.available(HW_L1D_MISSES) || !counters.available(HW_LLC_MISSES) ||
+        !counters.available(HW_BRANCH_MISSES) || !counters.available(HW_DTLB_MISSES)) {
+      cout << "# Counters that could not be opened print as nan ("
+           << counters.error() << ")\n";
+    }
+    cout << flush;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double add_stats[3][6], find_stats[3][6];
+      for (int t = 0; t < 3; ++t) {
+        counted(array, size, types[t], counters, add_stats[t], find_stats[t]);
+      }
+      cout << size;
+      for (int t = 0; t < 3; ++t) {
+        for (int m = 0; m < 6; ++m) {
+          cout << " " << add_stats[t][m];
+        }
+      }
+      for (int t = 0; t < 3; ++t) {
+        for (int m = 0; m < 6; ++m) {
+          cout << " " << find_stats[t][m];
+        }
+      }
+      cout << endl;
+    }
+  }
+  // test 22: mixed workloads with skewed keys
+  else if (test_number.compare("22") == 0) {
+    const int types[] = {HASHTABLE, SWISSTABLE, AVLSEARCHTREE, RBTSEARCHTREE, BPLUSTREE};
+    const char* names[] = {"HashTableCollection", "SwissTableCollection", "AVLCollection",
+                           "RBTCollection", "BPlusTreeCollection"};
+    cout << "# Column 1 = Workload: YCSB A (50/50 reads and updates), B (95/5 reads\n"
+         << "#   and updates), C (reads), D (95/5 reads and inserts, latest keys\n"
+         << "#   most popular), E (95/5 scans of up to 100 keys and inserts), with\n"
+         << "#   Zipfian keys unless named, or only inserts in the order named\n";
+    for (int t = 0; t < 5; ++t) {
+      cout << "# Columns " << (2 + 3*t) << "-" << (4 + 3*t) << " = " << names[t]
+           << " throughput, median latency, 99th percentile latency\n";
+    }
+    cout << "# Every workload but the inserts loads " << (STOP/3) << " keys (8 letters"
+         << " unless named) in random order, then runs " << (STOP/3) << " operations\n"
+         << "# The hash tables run no scans (each find range visits every key)\n"
+         << "# Throughput is in millions of operations per second, latency in microseconds"
+         << endl;
+    const size_t WORKLOADS = 11;
+    const char* labels[WORKLOADS] = {"A", "B", "C", "C-uniform", "C-hotspot",
+                                     "C-64-letter-keys", "D", "E", "insert-sequential",
+                                     "insert-reverse", "insert-random"};
+    for (size_t w = 0; w < WORKLOADS; ++w) {
+      WorkloadSpec spec = ycsb_workload(labels[w][0]);
+      if (w == 3)
+        spec.distribution = UNIFORM;
+      else if (w == 4)
+        spec.distribution = HOTSPOT;
+      else if (w == 5)
+        spec.key_length = 64;
+      else if (w >= 8) {
+        spec.record_count = 0;
+        spec.read_fraction = 0;
+        spec.insert_fraction = 1;
+        spec.insert_order = w == 8 ? SEQUENTIAL : w == 9 ? REVERSE : RANDOM;
+      }
+      spec.record_count = spec.record_count > 0 ? STOP/3 : 0;
+      spec.operation_count = STOP/3;
+      Workload workload(spec);
+      cout << labels[w];
+      for (int t = 0; t < 5; ++t) {
+        double stats[3] = {NAN, NAN, NAN};
+        if (spec.scan_fraction == 0 || (types[t] != HASHTABLE && types[t] != SWISSTABLE))
+          run_workload(workload, types[t], stats);
+        cout << " " << stats[0] << " " << stats[1] << " " << stats[2];
+      }
+      cout << endl;
     }
   }
   else {
@@ -253,247 +783,998 @@ void create_pairs(pair<string,int>* array, size_t n)
   return;
 }
 
-string get_ith_key(size_t i, size_t n)
+string get_ith_key(size_t i, size_t)
 {
-  char letter[26];
-  for (size_t i = 65; i <= 90; ++i)
-    letter[i - 65] = i;
-  string* keys = new string[n];      
-  size_t i1 = 0, i2 = 0, i3 = 0, i4 = 0;
-  for (size_t i = 0; i < n; ++i) {
-    if (i1 == 26) {i1 = 0; i2++;}
-    if (i2 == 26) {i2 = 0; i3++;}
-    if (i3 == 26) {i3 = 0; i4++;}
-    string str = "";
-    str += letter[i4];
-    str += letter[i3];
-    str += letter[i2];
-    str += letter[i1];
-    keys[i] = str;
-    ++i1;
+  // the ith key spells i in base 26, most significant letter first
+  // (the same keys the original loop over all n keys generated)
+  char key[4];
+  for (int j = 3; j >= 0; --j) {
+    key[j] = 'A' + i % 26;
+    i /= 26;
   }
-  return keys[i];
+  return string(key, 4);
+}
+
+
+Collection<string,int>* new_collection(int type)
+{
+  if (type == ARRAYLIST)
+    return new ArrayListCollection<string,int>;
+  else if (type == BINSEARCH)
+    return new BinSearchCollection<string,int>;
+  else if (type == HASHTABLE)
+    return new HashTableCollection<string,int>;
+  else if (type == BINSEARCHTREE)
+    return new BSTCollection<string,int>;
+  else if (type == AVLSEARCHTREE)
+    return new AVLCollection<string,int>;
+  else if (type == RBTSEARCHTREE)
+    return new RBTCollection<string,int>;
+  else if (type == SWISSTABLE)
+    return new SwissTableCollection<string,int>;
+  else if (type == BPLUSTREE)
+    return new BPlusTreeCollection<string,int>;
+  return nullptr;
+}
+
+
+Collection<string,int>* new_pooled_collection(int type)
+{
+  if (type == BINSEARCHTREE)
+    return new BSTCollection<string,int,NodePool>;
+  else if (type == AVLSEARCHTREE)
+    return new AVLCollection<string,int,NodePool>;
+  else if (type == RBTSEARCHTREE)
+    return new RBTCollection<string,int,NodePool>;
+  return new_collection(type);
+}
+
+
+// resident set size of this process (0 if it can't be determined)
+long resident_kb()
+{
+  long pages = 0, resident = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm)
+    return 0;
+  if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+    resident = 0;
+  fclose(statm);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
 }
 
 
 void print(const Collection<string,int>& coll)
 {
   cout << "{";
-  ArrayList<string> keys;
-  coll.keys(keys);
-  for (size_t i = 0; i < keys.size(); ++i) {
-    string key = "";
-    keys.get(i, key);
-    cout << key;
-    if (i < keys.size() - 1)
+  bool first = true;
+  for (auto kv : coll) {
+    if (!first)
       cout << ", ";
+    cout << kv.first;
+    first = false;
   }
   cout << "}\n";
 }
 
 
-double add(pair<string,int> array[], size_t size, int type)
+// Column headers for the statistics print_stats adds after the means
+// of n collections, starting at first_column
+void print_stats_header(size_t first_column, size_t n)
 {
-  unsigned long times[ITERATIONS]; 
-  Collection<string,int>* collection;
-  if (type == ARRAYLIST)
-    collection = new ArrayListCollection<string,int>;
-  else if (type == BINSEARCH)
-    collection = new BinSearchCollection<string,int>;
-  else if (type == HASHTABLE)
-    collection = new HashTableCollection<string,int>;
-  else if (type == BINSEARCHTREE)
-    collection = new BSTCollection<string,int>;    
-  else if (type == AVLSEARCHTREE)
-    collection = new AVLCollection<string,int>;
-  else if (type == RBTSEARCHTREE)
-    collection = new RBTCollection<string,int>;
+  const char* names[] = {"Median time", "99th percentile time", "Standard deviation of time"};
+  for (int s = 0; s < 3; ++s) {
+    cout << "# Columns " << first_column << "-" << (first_column + n - 1)
+         << " = " << names[s] << " (same order)\n";
+    first_column += n;
+  }
+  cout << "# Columns " << first_column << "-" << (first_column + n - 1)
+       << " = Operations per second (same order)\n"
+       << "# Each sample times a batch of operations, and samples are taken\n"
+       << "# until the 95% confidence interval of the mean is within 2% of it\n"
+       << "# (or a time limit is hit)\n"
+       << "# All times are measured in microseconds" << endl;
+}
+
+
+void print_stats(const BenchmarkResult results[], size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    cout << " " << (results[i].median/1000.0);
+  for (size_t i = 0; i < n; ++i)
+    cout << " " << (results[i].p99/1000.0);
+  for (size_t i = 0; i < n; ++i)
+    cout << " " << (results[i].stddev/1000.0);
+  for (size_t i = 0; i < n; ++i)
+    cout << " " << results[i].ops_per_sec;
+}
+
+
+// the collection of the given type holding the first size pairs
+Collection<string,int>* filled_collection(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = new_collection(type);
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
   assert(collection->size() == size);
+  return collection;
+}
+
+
+// the ith key not among the first size pairs (the unused pairs, then
+// keys past the ones create_pairs made)
+string unused_key(pair<string,int> array[], size_t size, size_t i)
+{
+  const size_t KEYS = 300001; // keys made by create_pairs
+  if (size + i < KEYS)
+    return array[size + i].first;
+  return get_ith_key(size + i, KEYS);
+}
+
+
+// operations per sample for tests 1-3
+const size_t MAX_BATCH = 1000;
+
+
+BenchmarkResult add(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = filled_collection(array, size, type);
+  ArrayList<string> keys;
+  for (size_t i = 0; i < MAX_BATCH; ++i)
+    keys.add(unused_key(array, size, i));
+  size_t added = 0;
+  // each sample adds new keys, which are then removed
+  BenchmarkResult result = Benchmark().run(
+    [&](size_t i) {collection->add(keys[i], 0); ++added;},
+    [&]() {
+      for (size_t i = 0; i < added; ++i)
+        collection->remove(keys[i]);
+      added = 0;
+      assert(collection->size() == size);
+    }, MAX_BATCH);
+  delete collection;
+  return result;
+}
+
+BenchmarkResult remove(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = filled_collection(array, size, type);
+  size_t removed = 0;
+  // each sample removes keys from the middle of the array, which are
+  // then added back
+  size_t first = size / 2 > MAX_BATCH / 2 ? size / 2 - MAX_BATCH / 2 : 0;
+  BenchmarkResult result = Benchmark().run(
+    [&](size_t i) {collection->remove(array[first + i].first); ++removed;},
+    [&]() {
+      if (type == RBTSEARCHTREE)
+        assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+      for (size_t i = 0; i < removed; ++i)
+        collection->add(array[first + i].first, array[first + i].second);
+      removed = 0;
+      assert(collection->size() == size);
+    }, min(size, MAX_BATCH));
+  delete collection;
+  return result;
+}
+
+BenchmarkResult find_value(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = filled_collection(array, size, type);
+  BenchmarkResult result = Benchmark().run(
+    [&](size_t i) {
+      int val;
+      bool found = collection->find(array[i].first, val);
+      assert(found && val == array[i].second);
+    }, min(size, MAX_BATCH));
+  delete collection;
+  return result;
+}
+
+BenchmarkResult find_range(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = filled_collection(array, size, type);
+  size_t k1 = (size/2) - (size/10);
+  size_t k2 = (size/2) + (size/10);
+  string key1 = get_ith_key(k1, size);
+  string key2 = get_ith_key(k2, size);
+  BenchmarkResult result = Benchmark().run(
+    [&](size_t) {
+      ArrayList<string> keys;
+      collection->find(key1, key2, keys);
+    }, size > 0 ? MAX_BATCH : 0);
+  delete collection;  
+  return result;
+}
+
+
+BenchmarkResult sort(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection = filled_collection(array, size, type);
+  // each sort takes long enough to be its own sample, so fewer are taken
+  Benchmark benchmark(0.02, 3);
+  BenchmarkResult result = benchmark.run(
+    [&](size_t) {
+      ArrayList<string> keys;
+      collection->sort(keys);
+      for (size_t j = 0; j + 1 < keys.size(); ++j)
+        assert(keys[j] < keys[j + 1]);
+    }, size > 0 ? MAX_BATCH : 0);
+  delete collection;
+  return result;
+}
+
+
+size_t stats(pair<string,int> array[], size_t size, int type)
+{
+  size_t height = 0;
+  if (type == BINSEARCHTREE) { 
+    BSTCollection<string,int>* collection = new BSTCollection<string,int>;
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    height = collection->height();
+    delete collection;
+  }
+  else if (type == AVLSEARCHTREE) {
+    AVLCollection<string,int>* collection = new AVLCollection<string,int>;
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    height = collection->height();
+    delete collection;
+  }
+  else if (type == RBTSEARCHTREE) {
+    RBTCollection<string,int>* collection = new RBTCollection<string,int>;
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    assert(collection->valid_rbt());
+    height = collection->height();
+    delete collection;
+  }
+  else if (type == BPLUSTREE) {
+    BPlusTreeCollection<string,int>* collection = new BPlusTreeCollection<string,int>;
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    assert(collection->valid_bplus_tree());
+    height = collection->height();
+    delete collection;
+  }
+  return height;
+}
+
+
+template<typename C>
+void fill_histogram(C& collection, pair<string,int> array[], size_t size,
+                    size_t counts[], size_t bins)
+{
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  ArrayList<size_t> lengths;
+  collection.chain_length_histogram(lengths);
+  // chains of bins-1 or more share the last bin
+  for (size_t i = 0; i < bins; ++i)
+    counts[i] = 0;
+  for (size_t len = 0; len < lengths.size(); ++len)
+    counts[len < bins ? len : bins - 1] += lengths[len];
+}
+
+
+void chain_histogram(pair<string,int> array[], size_t size, bool wyhash_mask,
+                     size_t counts[], size_t bins)
+{
+  if (wyhash_mask) {
+    HashTableCollection<string,int,WyHash<string>,MaskIndex> collection;
+    fill_histogram(collection, array, size, counts, bins);
+  }
+  else {
+    HashTableCollection<string,int> collection;
+    fill_histogram(collection, array, size, counts, bins);
+  }
+}
+
+
+// heap bytes in use (0 if the allocator can't say)
+size_t heap_bytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+
+template<typename C>
+double fill_bytes_per_key(C& collection, pair<string,int> array[], size_t size)
+{
+  size_t before = heap_bytes();
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  size_t after = heap_bytes();
+  if (size == 0)
+    return 0;
+  // The allocator's count includes its per-block headers and rounding,
+  // which is most of the cost of small nodes. Without it fall back to
+  // the collection's own count.
+  size_t bytes = after > before ? after - before : collection.memory_bytes();
+  return static_cast<double>(bytes) / size;
+}
+
+
+double bytes_per_key(pair<string,int> array[], size_t size, bool compact)
+{
+  // the keys are short enough to be stored in the strings themselves,
+  // so the heap growth is all the table's
+  if (compact) {
+    CompactHashTableCollection<string,int> collection;
+    return fill_bytes_per_key(collection, array, size);
+  }
+  HashTableCollection<string,int> collection;
+  return fill_bytes_per_key(collection, array, size);
+}
+
+
+double max_add(pair<string,int> array[], size_t size, size_t migration_budget)
+{
+  // Time every add while building the table and keep the slowest one
+  HashTableCollection<string,int> collection(migration_budget);
+  unsigned long max_time = 0;
+  for (size_t i = 0; i < size; ++i) {
+    auto start = high_resolution_clock::now();
+    collection.add(array[i].first, array[i].second);
+    auto end = high_resolution_clock::now();
+    unsigned long time = duration_cast<microseconds>(end - start).count();
+    if (time > max_time)
+      max_time = time;
+  }
+  assert(collection.size() == size);
+  return max_time;
+}
+
+
+void build(pair<string,int> array[], size_t size, int type, bool pooled,
+           double& time, long& rss)
+{
+  // Build in a child process so memory freed by earlier builds can't
+  // be reused and hide the growth in resident memory
+  time = 0;
+  rss = 0;
+  int fds[2];
+  if (pipe(fds) != 0)
+    return;
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    long before = resident_kb();
+    auto start = high_resolution_clock::now();
+    Collection<string,int>* collection = pooled ? new_pooled_collection(type)
+                                                : new_collection(type);
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    auto end = high_resolution_clock::now();
+    double result[2];
+    result[0] = duration_cast<microseconds>(end - start).count();
+    result[1] = resident_kb() - before;
+    ssize_t written = write(fds[1], result, sizeof(result));
+    _exit(written == sizeof(result) ? 0 : 1);
+  }
+  close(fds[1]);
+  double result[2];
+  if (pid > 0 && read(fds[0], result, sizeof(result)) == sizeof(result)) {
+    time = result[0];
+    rss = static_cast<long>(result[1]);
+  }
+  close(fds[0]);
+  if (pid > 0)
+    waitpid(pid, nullptr, 0);
+}
+
+
+double bulk_load(const ArrayList<pair<string,int>>& kv_pairs, int type)
+{
+  unsigned long times[ITERATIONS];
   for (size_t i = 0; i < ITERATIONS; ++i) {
     auto start = high_resolution_clock::now();
-    collection->add(array[size+1].first, array[size+1].second);
+    if (type == AVLSEARCHTREE) {
+      AVLCollection<string,int> collection(kv_pairs);
+      assert(collection.size() == kv_pairs.size());
+    }
+    else if (type == RBTSEARCHTREE) {
+      RBTCollection<string,int> collection(kv_pairs);
+      assert(collection.size() == kv_pairs.size());
+    }
     auto end = high_resolution_clock::now();
     times[i] = duration_cast<microseconds>(end - start).count();
-    collection->remove(array[size+1].first);
   }
-  delete collection;
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
-double remove(pair<string,int> array[], size_t size, int type)
+
+void count_copies(pair<string,int> array[], size_t size, int type, bool move,
+                  double& copies, double& moves)
 {
-  unsigned long times[ITERATIONS]; 
-  Collection<string,int>* collection;
-  if (type == ARRAYLIST)
-    collection = new ArrayListCollection<string,int>;
-  else if (type == BINSEARCH)
-    collection = new BinSearchCollection<string,int>;
-  else if (type == HASHTABLE)
-    collection = new HashTableCollection<string,int>;
-  else if (type == BINSEARCHTREE)
-    collection = new BSTCollection<string,int>;    
+  Collection<CountedString,int>* collection = nullptr;
+  if (type == HASHTABLE)
+    collection = new HashTableCollection<CountedString,int>;
   else if (type == AVLSEARCHTREE)
-    collection = new AVLCollection<string,int>;    
+    collection = new AVLCollection<CountedString,int>;
   else if (type == RBTSEARCHTREE)
-    collection = new RBTCollection<string,int>;
+    collection = new RBTCollection<CountedString,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<CountedString,int>;
+  CountedString* keys = new CountedString[size];
   for (size_t i = 0; i < size; ++i)
-    collection->add(array[i].first, array[i].second);
-  if (type == RBTSEARCHTREE)
-    assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+    keys[i].str = array[i].first;
+  CountedString::copies = 0;
+  CountedString::moves = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (move)
+      collection->add(std::move(keys[i]), int(array[i].second));
+    else
+      collection->add(keys[i], array[i].second);
+  }
   assert(collection->size() == size);
+  copies = size ? CountedString::copies / (size*1.0) : 0;
+  moves = size ? CountedString::moves / (size*1.0) : 0;
+  delete [] keys;
+  delete collection;
+}
+
+
+double sort_list(pair<string,int> array[], size_t size, int algorithm, bool presorted)
+{
+  unsigned long times[ITERATIONS];
+  ArrayList<string> keys(size);
+  for (size_t i = 0; i < size; ++i)
+    keys.add(array[i].first);
+  if (presorted)
+    keys.sort();
   for (size_t i = 0; i < ITERATIONS; ++i) {
+    ArrayList<string> list(keys);
     auto start = high_resolution_clock::now();
-    collection->remove(array[size/2].first);
+    if (algorithm == 0)
+      list.quick_sort();
+    else if (algorithm == 1)
+      list.merge_sort();
+    else if (algorithm == 2)
+      list.heap_sort();
+    else
+      list.intro_sort();
     auto end = high_resolution_clock::now();
-    if (type == RBTSEARCHTREE) {
-      assert(((RBTCollection<string,int>*)collection)->valid_rbt());
-    }
-    collection->add(array[size/2].first, array[size/2].second);
+    for (size_t j = 1; j < size; ++j)
+      assert(!(list[j] < list[j - 1]));
     times[i] = duration_cast<microseconds>(end - start).count();
   }
-  delete collection;
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
-double find_value(pair<string,int> array[], size_t size, int type)
+
+double parallel_sort(pair<string,int> array[], size_t size, size_t threads)
 {
-  unsigned long times[ITERATIONS]; 
-  Collection<string,int>* collection;
-  if (type == ARRAYLIST)
-    collection = new ArrayListCollection<string,int>;
-  else if (type == BINSEARCH)
-    collection = new BinSearchCollection<string,int>;
-  else if (type == HASHTABLE)
-    collection = new HashTableCollection<string,int>;
-  else if (type == BINSEARCHTREE)
-    collection = new BSTCollection<string,int>;    
-  else if (type == AVLSEARCHTREE)
-    collection = new AVLCollection<string,int>;    
-  else if (type == RBTSEARCHTREE)
-    collection = new RBTCollection<string,int>;
+  unsigned long times[ITERATIONS];
+  ArrayList<string> keys(size);
   for (size_t i = 0; i < size; ++i)
-    collection->add(array[i].first, array[i].second);
-  if (type == RBTSEARCHTREE)
-    assert(((RBTCollection<string,int>*)collection)->valid_rbt());
-  assert(collection->size() == size);
+    keys.add(array[i].first);
   for (size_t i = 0; i < ITERATIONS; ++i) {
+    ArrayList<string> list(keys);
     auto start = high_resolution_clock::now();
-    int val;
-    collection->find(array[size/2].first, val);
+    list.parallel_sort(threads);
     auto end = high_resolution_clock::now();
+    for (size_t j = 1; j < size; ++j)
+      assert(!(list[j] < list[j - 1]));
     times[i] = duration_cast<microseconds>(end - start).count();
   }
-  delete collection;
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
-double find_range(pair<string,int> array[], size_t size, int type)
+
+template<typename T>
+double radix_compare(const ArrayList<T>& keys, int algorithm)
 {
-  unsigned long times[ITERATIONS]; 
-  Collection<string,int>* collection;
-  if (type == ARRAYLIST)
-    collection = new ArrayListCollection<string,int>;
-  else if (type == BINSEARCH)
-    collection = new BinSearchCollection<string,int>;
-  else if (type == HASHTABLE)
-    collection = new HashTableCollection<string,int>;
-  else if (type == BINSEARCHTREE)
-    collection = new BSTCollection<string,int>;    
-  else if (type == AVLSEARCHTREE)
-    collection = new AVLCollection<string,int>;    
-  else if (type == RBTSEARCHTREE)
-    collection = new RBTCollection<string,int>;
-  for (size_t i = 0; i < size; ++i)
-    collection->add(array[i].first, array[i].second);
-  if (type == RBTSEARCHTREE)
-    assert(((RBTCollection<string,int>*)collection)->valid_rbt());
-  assert(collection->size() == size);
+  unsigned long times[ITERATIONS];
   for (size_t i = 0; i < ITERATIONS; ++i) {
-    size_t k1 = (size/2) - (size/10);
-    size_t k2 = (size/2) + (size/10);
-    ArrayList<string> keys;
+    ArrayList<T> list(keys);
     auto start = high_resolution_clock::now();
-    collection->find(get_ith_key(k1, size), get_ith_key(k2, size), keys); 
-    // collection->find(array[k1].first, array[k2].first, keys);
+    if (algorithm == 0)
+      list.quick_sort();
+    else if (algorithm == 1)
+      list.intro_sort();
+    else
+      radix_sort(list);
     auto end = high_resolution_clock::now();
+    for (size_t j = 1; j < list.size(); ++j)
+      assert(!(list[j] < list[j - 1]));
     times[i] = duration_cast<microseconds>(end - start).count();
   }
-  delete collection;  
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
 
-double sort(pair<string,int> array[], size_t size, int type)
+double throughput(pair<string,int> array[], size_t size, size_t threads, bool striped)
 {
-  unsigned long times[ITERATIONS]; 
-  Collection<string,int>* collection;
-  if (type == ARRAYLIST)
-    collection = new ArrayListCollection<string,int>;
-  else if (type == BINSEARCH)
-    collection = new BinSearchCollection<string,int>;
-  else if (type == HASHTABLE)
-    collection = new HashTableCollection<string,int>;
-  else if (type == BINSEARCHTREE)
-    collection = new BSTCollection<string,int>;    
-  else if (type == AVLSEARCHTREE)
-    collection = new AVLCollection<string,int>;    
-  else if (type == RBTSEARCHTREE)
-    collection = new RBTCollection<string,int>;
-  for (size_t i = 0; i < size; ++i)
-    collection->add(array[i].first, array[i].second);
-  if (type == RBTSEARCHTREE)
-    assert(((RBTCollection<string,int>*)collection)->valid_rbt());
-  assert(collection->size() == size);
+  const size_t OPERATIONS = 200000; // per thread
+  ConcurrentHashTableCollection<string,int> concurrent;
+  HashTableCollection<string,int> plain;
+  mutex plain_lock;
+  for (size_t i = 0; i < size; ++i) {
+    if (striped)
+      concurrent.add(array[i].first, array[i].second);
+    else
+      plain.add(array[i].first, array[i].second);
+  }
+  auto worker = [&](size_t t) {
+    unsigned long seed = t + 1;
+    size_t own = t; // keys t, t + threads, ... are this thread's to move
+    for (size_t i = 0; i < OPERATIONS; ++i) {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      if ((seed >> 33) % 10 != 0) {
+        const string& key = array[(seed >> 33) % size].first;
+        int val;
+        if (striped)
+          concurrent.find(key, val);
+        else {
+          lock_guard<mutex> lock(plain_lock);
+          plain.find(key, val);
+        }
+      }
+      else {
+        const pair<string,int>& p = array[own];
+        if (striped) {
+          concurrent.remove(p.first);
+          concurrent.add(p.first, p.second);
+        }
+        else {
+          lock_guard<mutex> lock(plain_lock);
+          plain.remove(p.first);
+          plain.add(p.first, p.second);
+        }
+        own = own + threads < size ? own + threads : t;
+      }
+    }
+  };
+  thread* workers = new thread[threads];
+  auto start = high_resolution_clock::now();
+  for (size_t t = 0; t < threads; ++t)
+    workers[t] = thread(worker, t);
+  for (size_t t = 0; t < threads; ++t)
+    workers[t].join();
+  auto end = high_resolution_clock::now();
+  delete [] workers;
+  assert((striped ? concurrent.size() : plain.size()) == size);
+  double seconds = duration_cast<microseconds>(end - start).count() / 1000000.0;
+  return threads * OPERATIONS / seconds / 1000000.0;
+}
+
+
+void mixed_throughput(pair<string,int> array[], size_t size, size_t readers,
+                      bool copy_on_write, double& reads, double& writes)
+{
+  const size_t OPERATIONS = 100000; // per reader
+  const size_t RANGE = 100;
+  ConcurrentRBTCollection<string,int> concurrent;
+  RBTCollection<string,int> plain;
+  shared_mutex plain_lock;
+  for (size_t i = 0; i < size; ++i) {
+    if (copy_on_write)
+      concurrent.add(array[i].first, array[i].second);
+    else
+      plain.add(array[i].first, array[i].second);
+  }
+  atomic<bool> done(false);
+  size_t write_count = 0;
+  auto reader = [&](size_t t) {
+    unsigned long seed = t + 1;
+    for (size_t i = 0; i < OPERATIONS; ++i) {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      size_t k = (seed >> 33) % size;
+      if ((seed >> 33) % 10 != 0) {
+        int val;
+        if (copy_on_write)
+          concurrent.find(array[k].first, val);
+        else {
+          shared_lock<shared_mutex> lock(plain_lock);
+          plain.find(array[k].first, val);
+        }
+      }
+      else {
+        // the keys added are a random subset of the keys create_pairs
+        // made, so widen the range to hold about RANGE of them
+        const size_t KEYS = 300001;
+        ArrayList<string> keys;
+        size_t first = k * (KEYS / size);
+        string k1 = get_ith_key(first, KEYS);
+        string k2 = get_ith_key(first + RANGE * (KEYS / size) - 1, KEYS);
+        if (copy_on_write)
+          concurrent.find(k1, k2, keys);
+        else {
+          shared_lock<shared_mutex> lock(plain_lock);
+          plain.find(k1, k2, keys);
+        }
+      }
+    }
+  };
+  auto writer = [&]() {
+    size_t own = 0;
+    while (!done) {
+      const pair<string,int>& p = array[own];
+      if (copy_on_write) {
+        concurrent.remove(p.first);
+        concurrent.add(p.first, p.second);
+      }
+      else {
+        unique_lock<shared_mutex> lock(plain_lock);
+        plain.remove(p.first);
+        plain.add(p.first, p.second);
+      }
+      write_count += 2;
+      own = (own + 1) % size;
+    }
+  };
+  thread* workers = new thread[readers];
+  auto start = high_resolution_clock::now();
+  thread writing(writer);
+  for (size_t t = 0; t < readers; ++t)
+    workers[t] = thread(reader, t);
+  for (size_t t = 0; t < readers; ++t)
+    workers[t].join();
+  auto end = high_resolution_clock::now();
+  done = true;
+  writing.join();
+  delete [] workers;
+  assert((copy_on_write ? concurrent.size() : plain.size()) == size);
+  double seconds = duration_cast<microseconds>(end - start).count() / 1000000.0;
+  reads = readers * OPERATIONS / seconds / 1000000.0;
+  writes = write_count / seconds / 1000000.0;
+}
+
+
+void snapshot_cost(pair<string,int> array[], size_t size, bool persistent,
+                   double& snapshot_time, double& add_time)
+{
+  // the last few keys are added after the snapshot is taken
+  const size_t ADDS = size < 100 ? size : 100;
+  unsigned long snapshot_times[ITERATIONS];
+  unsigned long add_times[ITERATIONS];
   for (size_t i = 0; i < ITERATIONS; ++i) {
-    ArrayList<string> keys;
+    PersistentAVLCollection<string,int> persistent_tree;
+    AVLCollection<string,int> tree;
+    for (size_t j = 0; j < size - ADDS; ++j) {
+      if (persistent)
+        persistent_tree.add(array[j].first, array[j].second);
+      else
+        tree.add(array[j].first, array[j].second);
+    }
     auto start = high_resolution_clock::now();
-    collection->sort(keys);
+    PersistentAVLCollection<string,int> persistent_copy;
+    AVLCollection<string,int> copy;
+    if (persistent)
+      persistent_copy = persistent_tree.snapshot();
+    else
+      copy = tree;
     auto end = high_resolution_clock::now();
-    if (keys.size() > 0) 
-      for (size_t i = 0; i < keys.size() - 1; ++i) {
-        string val1 = "", val2 = "";
-        keys.get(i, val1);
-        keys.get(i + 1, val2);
-        assert(val1 < val2);
+    snapshot_times[i] = duration_cast<microseconds>(end - start).count();
+    start = high_resolution_clock::now();
+    for (size_t j = size - ADDS; j < size; ++j) {
+      if (persistent)
+        persistent_tree.add(array[j].first, array[j].second);
+      else
+        tree.add(array[j].first, array[j].second);
+    }
+    end = high_resolution_clock::now();
+    add_times[i] = duration_cast<microseconds>(end - start).count();
+    assert((persistent ? persistent_copy.size() : copy.size()) == size - ADDS);
+  }
+  snapshot_time = sum(snapshot_times, ITERATIONS) / (ITERATIONS*1.0);
+  add_time = ADDS == 0 ? 0 : sum(add_times, ITERATIONS) / (ITERATIONS*1.0) / ADDS;
+}
+
+
+// sum the values of the keys in the middle half of the key space (about
+// half of the keys added), either by buffering the keys (and finding
+// each value) or by scanning
+template<typename C>
+double range_sum(const C& collection, pair<string,int> array[], size_t size,
+                 bool streaming, size_t& buffer_bytes)
+{
+  const size_t KEYS = 300001; // keys made by create_pairs
+  unsigned long times[ITERATIONS];
+  string k1 = get_ith_key(KEYS/4, KEYS);
+  string k2 = get_ith_key(3*KEYS/4, KEYS);
+  long expected = 0;
+  for (size_t i = 0; i < size; ++i)
+    if (array[i].first >= k1 && array[i].first <= k2)
+      expected += array[i].second;
+  buffer_bytes = 0;
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    long total = 0;
+    auto start = high_resolution_clock::now();
+    if (streaming) {
+      collection.scan(k1, k2, [&total](const string&, const int& val) {
+        total += val;
+        return true;
+      });
+    }
+    else {
+      ArrayList<string> keys;
+      collection.find(k1, k2, keys);
+      for (size_t j = 0; j < keys.size(); ++j) {
+        int val;
+        collection.find(keys[j], val);
+        total += val;
       }
+      buffer_bytes = keys.capacity() * sizeof(string);
+    }
+    auto end = high_resolution_clock::now();
+    assert(total == expected);
     times[i] = duration_cast<microseconds>(end - start).count();
   }
-  delete collection;
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
 
-size_t stats(pair<string,int> array[], size_t size, int type)
+double range_scan(pair<string,int> array[], size_t size, int type, bool streaming,
+                  size_t& buffer_bytes)
 {
-  size_t height = 0;
-  if (type == BINSEARCHTREE) { 
-    BSTCollection<string,int>* collection = new BSTCollection<string,int>;
+  if (type == AVLSEARCHTREE) {
+    AVLCollection<string,int> collection;
     for (size_t i = 0; i < size; ++i)
-      collection->add(array[i].first, array[i].second);
-    height = collection->height();
-    delete collection;
+      collection.add(array[i].first, array[i].second);
+    return range_sum(collection, array, size, streaming, buffer_bytes);
   }
-  else if (type == AVLSEARCHTREE) {
-    AVLCollection<string,int>* collection = new AVLCollection<string,int>;
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  return range_sum(collection, array, size, streaming, buffer_bytes);
+}
+
+
+// count the keys in the middle half of the key space, either from the
+// size of the range find or from the subtree sizes
+template<typename C>
+double count_keys(const C& collection, pair<string,int> array[], size_t size,
+                  bool counting)
+{
+  const size_t KEYS = 300001; // keys made by create_pairs
+  unsigned long times[ITERATIONS];
+  string k1 = get_ith_key(KEYS/4, KEYS);
+  string k2 = get_ith_key(3*KEYS/4, KEYS);
+  size_t expected = 0;
+  for (size_t i = 0; i < size; ++i)
+    if (array[i].first >= k1 && array[i].first <= k2)
+      ++expected;
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    size_t count = 0;
+    auto start = high_resolution_clock::now();
+    if (counting)
+      count = collection.count(k1, k2);
+    else {
+      ArrayList<string> keys;
+      collection.find(k1, k2, keys);
+      count = keys.size();
+    }
+    auto end = high_resolution_clock::now();
+    assert(count == expected);
+    times[i] = duration_cast<nanoseconds>(end - start).count();
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1000.0);
+}
+
+
+double range_count(pair<string,int> array[], size_t size, int type, bool counting)
+{
+  if (type == AVLSEARCHTREE) {
+    AVLCollection<string,int> collection;
     for (size_t i = 0; i < size; ++i)
-      collection->add(array[i].first, array[i].second);
-    height = collection->height();
-    delete collection;
+      collection.add(array[i].first, array[i].second);
+    return count_keys(collection, array, size, counting);
   }
-  else if (type == RBTSEARCHTREE) {
-    RBTCollection<string,int>* collection = new RBTCollection<string,int>;
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  return count_keys(collection, array, size, counting);
+}
+
+
+// time a pass over keys[0..size) in batches of the given size, where
+// a batch of 1 makes one (virtual) Collection call per key
+template<typename F1, typename F2>
+unsigned long batch_pass(size_t size, size_t batch, F1 one, F2 many)
+{
+  auto start = high_resolution_clock::now();
+  for (size_t i = 0; i < size; i += batch) {
+    if (batch == 1)
+      one(i);
+    else
+      many(i, size - i < batch ? size - i : batch);
+  }
+  auto end = high_resolution_clock::now();
+  return duration_cast<nanoseconds>(end - start).count();
+}
+
+
+void batch_sweep(pair<string,int> array[], size_t size, size_t batch, double times[])
+{
+  string* keys = new string[size];
+  int* vals = new int[size];
+  int* found_vals = new int[size];
+  bool* found = new bool[size];
+  for (size_t i = 0; i < size; ++i) {
+    keys[i] = array[i].first;
+    vals[i] = array[i].second;
+  }
+  unsigned long totals[5] = {0, 0, 0, 0, 0};
+  for (size_t it = 0; it < ITERATIONS; ++it) {
+    HashTableCollection<string,int> table;
+    Collection<string,int>& coll = table;
+    AVLCollection<string,int> avl;
+    RBTCollection<string,int> rbt;
+    avl.add_batch(keys, vals, size);
+    rbt.add_batch(keys, vals, size);
+    int val;
+    totals[0] += batch_pass(size, batch,
+      [&](size_t i) {coll.add(keys[i], vals[i]);},
+      [&](size_t i, size_t n) {table.add_batch(keys + i, vals + i, n);});
+    totals[1] += batch_pass(size, batch,
+      [&](size_t i) {found[i] = coll.find(keys[i], found_vals[i]);},
+      [&](size_t i, size_t n) {table.find_batch(keys + i, n, found_vals + i, found + i);});
     for (size_t i = 0; i < size; ++i)
-      collection->add(array[i].first, array[i].second);
-    assert(collection->valid_rbt());
-    height = collection->height();
-    delete collection;
+      assert(found[i] && found_vals[i] == vals[i]);
+    totals[2] += batch_pass(size, batch,
+      [&](size_t i) {coll.remove(keys[i]);},
+      [&](size_t i, size_t n) {table.remove_batch(keys + i, n);});
+    assert(table.size() == 0);
+    Collection<string,int>& avl_coll = avl;
+    totals[3] += batch_pass(size, batch,
+      [&](size_t i) {avl_coll.find(keys[i], val);},
+      [&](size_t i, size_t n) {avl.find_batch(keys + i, n, found_vals + i, found + i);});
+    Collection<string,int>& rbt_coll = rbt;
+    totals[4] += batch_pass(size, batch,
+      [&](size_t i) {rbt_coll.find(keys[i], val);},
+      [&](size_t i, size_t n) {rbt.find_batch(keys + i, n, found_vals + i, found + i);});
   }
-  return height;
+  for (int i = 0; i < 5; ++i)
+    times[i] = totals[i] / (ITERATIONS * 1.0) / size;
+  delete [] keys;
+  delete [] vals;
+  delete [] found_vals;
+  delete [] found;
+}
+
+
+// run the workload over the collection (a Collection reference or a
+// StaticCollection), returning the total time in nanoseconds
+template<typename C>
+unsigned long dispatch_workload(C& collection, pair<string,int> array[], size_t size)
+{
+  const int FINDS = 4;
+  auto start = high_resolution_clock::now();
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  for (int f = 0; f < FINDS; ++f) {
+    for (size_t i = 0; i < size; ++i) {
+      int val;
+      collection.find(array[i].first, val);
+    }
+  }
+  for (size_t i = 0; i < size; ++i) {
+    collection.remove(array[i].first);
+    collection.add(array[i].first, array[i].second);
+  }
+  auto end = high_resolution_clock::now();
+  assert(collection.size() == size);
+  return duration_cast<nanoseconds>(end - start).count();
+}
+
+
+template<typename C>
+unsigned long dispatch_run(pair<string,int> array[], size_t size, bool static_dispatch)
+{
+  C collection;
+  if (static_dispatch) {
+    StaticCollection<C> front_end(collection);
+    return dispatch_workload(front_end, array, size);
+  }
+  Collection<string,int>& base = collection;
+  return dispatch_workload(base, array, size);
+}
+
+
+double dispatch(pair<string,int> array[], size_t size, int type, bool static_dispatch)
+{
+  // adds, finds, and removes per key
+  const size_t OPERATIONS = 1 + 4 + 2;
+  unsigned long times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    if (type == HASHTABLE)
+      times[i] = dispatch_run<HashTableCollection<string,int>>(array, size, static_dispatch);
+    else if (type == SWISSTABLE)
+      times[i] = dispatch_run<SwissTableCollection<string,int>>(array, size, static_dispatch);
+    else
+      times[i] = dispatch_run<AVLCollection<string,int>>(array, size, static_dispatch);
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / (size * OPERATIONS);
+}
+
+
+void instrumented(pair<string,int> array[], size_t size, int type)
+{
+#ifdef COLLECTION_INSTRUMENTATION
+  Collection<string,int>* collection = new_collection(type);
+  for (size_t i = 0; i < size; ++i)
+    collection->add(array[i].first, array[i].second);
+  for (size_t i = 0; i < size; ++i) {
+    int val;
+    collection->find(array[i].first, val);
+  }
+  // ranges of about 1% of the keys
+  for (size_t i = 0; i < 100; ++i) {
+    ArrayList<string> keys;
+    size_t k1 = i * (size / 100);
+    collection->find(get_ith_key(k1, size), get_ith_key(k1 + size / 100, size), keys);
+  }
+  for (size_t i = 0; i < 10; ++i) {
+    ArrayList<string> keys;
+    collection->sort(keys);
+  }
+  for (size_t i = 0; i < size; ++i)
+    collection->remove(array[i].first);
+  collection->statistics().dump(cout);
+  delete collection;
+#else
+  (void) array;
+  (void) size;
+  (void) type;
+#endif
 }
 
 
+// the time and counts of a counted region, per operation
+void counter_stats(const HardwareCounters& counters, uint64_t ns, size_t ops, double stats[])
+{
+  stats[0] = static_cast<double>(ns) / ops;
+  stats[1] = counters.ipc();
+  stats[2] = counters.value(HW_L1D_MISSES) / ops;
+  stats[3] = counters.value(HW_LLC_MISSES) / ops;
+  stats[4] = counters.value(HW_BRANCH_MISSES) / ops;
+  stats[5] = counters.value(HW_DTLB_MISSES) / ops;
+}
 
+
+void counted(pair<string,int> array[], size_t size, int type, HardwareCounters& counters,
+             double add_stats[], double find_stats[])
+{
+  Collection<string,int>* collection = new_collection(type);
+  // each region is size operations, long enough for one run to count
+  counters.start();
+  uint64_t start = Benchmark::now();
+  for (size_t i = 0; i < size; ++i)
+    collection->add(array[i].first, array[i].second);
+  uint64_t end = Benchmark::now();
+  counters.stop();
+  counter_stats(counters, end - start, size, add_stats);
+  int val;
+  counters.start();
+  start = Benchmark::now();
+  for (size_t i = 0; i < size; ++i)
+    collection->find(array[i].first, val);
+  end = Benchmark::now();
+  counters.stop();
+  counter_stats(counters, end - start, size, find_stats);
+  delete collection;
+}
+
+
+
+// throughput (millions of operations per second) and median and 99th
+// percentile latency (microseconds) of a workload on a new collection
+void run_workload(const Workload& workload, int type, double stats[])
+{
+  Collection<string,int>* collection = new_collection(type);
+  workload.load(*collection);
+  WorkloadResult result;
+  workload.run(*collection, result);
+  stats[0] = result.ops_per_sec / 1000000.0;
+  stats[1] = result.overall.percentile(0.5) / 1000.0;
+  stats[2] = result.overall.percentile(0.99) / 1000.0;
+  delete collection;
+}
@@ -2,15 +2,32 @@
 // Name: 
 // File: hw9_test.cpp
 // Date: Fall 2020
-// Desc: Unit tests for the red-black tree collection implementation
+// Desc: Unit tests for the collection implementations
 //----------------------------------------------------------------------
 
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <gtest/gtest.h>
 #include "array_list.h"
 #include "rbt_collection.h"
+#include "swiss_table_collection.h"
+#include "hash_table_collection.h"
+#include "compact_hash_table_collection.h"
+#include "node_pool.h"
+#include "bplus_tree_collection.h"
+#include "avl_collection.h"
+#include "bst_collection.h"
+#include "array_list_collection.h"
+#include "bin_search_collection.h"
+#include "radix_sort.h"
+#include "concurrent_hash_table_collection.h"
+#include "concurrent_rbt_collection.h"
+#include "persistent_avl_collection.h"
+#include "static_collection.h"
+#include "workload.h"
+#include <thread>
 #include <cmath>
 
 using namespace std;
@@ -21,16 +38,12 @@ template<typename K,typename V>
 void print(const Collection<K,V>& kv_list)
 {
   cout << "{";
-  ArrayList<K> the_keys;
-  kv_list.keys(the_keys);
-  for (size_t i = 0; i < the_keys.size(); ++i) {
-    K key;
-    V val;
-    the_keys.get(i, key);
-    kv_list.find(key, val);
-    cout << key << ": " << val;
-    if (i < the_keys.size() - 1)
+  bool first = true;
+  for (auto kv : kv_list) {
+    if (!first)
       cout << ", ";
+    cout << kv.first << ": " << kv.second;
+    first = false;
   }
   cout << "}";
 }
@@ -538,6 +551,1469 @@ TEST(RBTCollectionTest, LargeInputMiddleAddRemove) {
   }
 }
 
+// Test: Add, find, and remove in the open addressing hash table
+TEST(SwissTableCollectionTest, SimpleAddFindRemove) {
+  SwissTableCollection<string,int> c;
+  int v;
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(false, c.find("a", v));
+  c.add("b", 10);
+  c.add("a", 20);
+  c.add("c", 30);
+  ASSERT_EQ(3, c.size());
+  ASSERT_EQ(true, c.find("a", v));
+  ASSERT_EQ(20, v);
+  ASSERT_EQ(true, c.find("c", v));
+  ASSERT_EQ(30, v);
+  c.remove("a");
+  ASSERT_EQ(2, c.size());
+  ASSERT_EQ(false, c.find("a", v));
+  ASSERT_EQ(true, c.find("b", v));
+  ASSERT_EQ(10, v);
+  // removing a missing key does nothing
+  c.remove("z");
+  ASSERT_EQ(2, c.size());
+}
+
+// Test: Grow through many rehashes and reuse deleted slots
+TEST(SwissTableCollectionTest, LargeInputAddRemove) {
+  SwissTableCollection<int,int> c;
+  int LARGE_NUM = 20000;
+  int v;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    c.add(i, i + 10);
+  }
+  ASSERT_EQ(LARGE_NUM, c.size());
+  ASSERT_LE(c.load_factor(), 0.875);
+  for (int i = 0; i < LARGE_NUM; i += 2) {
+    c.remove(i);
+  }
+  ASSERT_EQ(LARGE_NUM / 2, c.size());
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    ASSERT_EQ(i % 2 == 1, c.find(i, v));
+    if (i % 2 == 1) {
+      ASSERT_EQ(i + 10, v);
+    }
+  }
+  // refill the tombstones
+  for (int i = 0; i < LARGE_NUM; i += 2) {
+    c.add(i, i);
+  }
+  ASSERT_EQ(LARGE_NUM, c.size());
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(LARGE_NUM, sorted.size());
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    sorted.get(i, v);
+    ASSERT_EQ(i, v);
+  }
+}
+
+// Test: Range search and copy of the open addressing hash table
+TEST(SwissTableCollectionTest, RangeAndCopy) {
+  SwissTableCollection<string,int> c;
+  c.add("a", 10);
+  c.add("b", 20);
+  c.add("c", 30);
+  c.add("d", 40);
+  ArrayList<string> keys;
+  c.find("b", "c", keys);
+  ASSERT_EQ(2, keys.size());
+  ASSERT_EQ(true, member(string("b"), keys));
+  ASSERT_EQ(true, member(string("c"), keys));
+  SwissTableCollection<string,int> c2(c);
+  c.remove("a");
+  int v;
+  ASSERT_EQ(4, c2.size());
+  ASSERT_EQ(true, c2.find("a", v));
+  ASSERT_EQ(10, v);
+  c2 = c;
+  ASSERT_EQ(3, c2.size());
+  ASSERT_EQ(false, c2.find("a", v));
+}
+
+// Test: Incremental rehashing keeps every key reachable mid-migration
+TEST(HashTableCollectionTest, IncrementalRehash) {
+  HashTableCollection<int,int> c(2);
+  int LARGE_NUM = 5000;
+  int v;
+  bool saw_migration = false;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    c.add(i, i + 10);
+    if (c.migrating()) {
+      saw_migration = true;
+      // old and new buckets are both searched while migrating
+      ASSERT_EQ(true, c.find(i / 2, v));
+      ASSERT_EQ(i / 2 + 10, v);
+    }
+  }
+  ASSERT_EQ(true, saw_migration);
+  ASSERT_EQ(LARGE_NUM, c.size());
+  for (int i = 0; i < LARGE_NUM; i += 2) {
+    c.remove(i);
+  }
+  ASSERT_EQ(LARGE_NUM / 2, c.size());
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    ASSERT_EQ(i % 2 == 1, c.find(i, v));
+  }
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(LARGE_NUM / 2, sorted.size());
+  // copies pick up keys that are still in old buckets
+  HashTableCollection<int,int> c2(c);
+  ASSERT_EQ(LARGE_NUM / 2, c2.size());
+  ASSERT_EQ(true, c2.find(LARGE_NUM - 1, v));
+  ASSERT_LE(c2.avg_chain_length(), 0.75);
+  // even one bucket per add finishes each migration before the table
+  // next grows (when the load drops)
+  HashTableCollection<int,int> c3(1);
+  bool was_migrating = false;
+  double last_load = 0;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    c3.add(i, i);
+    if (c3.avg_chain_length() < last_load) {
+      ASSERT_EQ(false, was_migrating);
+    }
+    was_migrating = c3.migrating();
+    last_load = c3.avg_chain_length();
+  }
+}
+
+// Test: Chains spill from the inline entry into overflow blocks and
+// shrink back as keys are removed
+TEST(CompactHashTableCollectionTest, LargeInputAddRemove) {
+  CompactHashTableCollection<int,int> c;
+  int LARGE_NUM = 20000;
+  int v;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    c.add(i, i + 10);
+  }
+  ASSERT_EQ(LARGE_NUM, c.size());
+  ASSERT_LE(LARGE_NUM, 3 * c.capacity());
+  ASSERT_LT(1, c.max_chain_length());
+  for (int i = 0; i < LARGE_NUM; i += 2) {
+    c.remove(i);
+  }
+  ASSERT_EQ(LARGE_NUM / 2, c.size());
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    ASSERT_EQ(i % 2 == 1, c.find(i, v));
+    if (i % 2 == 1) {
+      ASSERT_EQ(i + 10, v);
+    }
+  }
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(LARGE_NUM / 2, sorted.size());
+  for (int i = 0; i < LARGE_NUM / 2; ++i) {
+    sorted.get(i, v);
+    ASSERT_EQ(2 * i + 1, v);
+  }
+  // iteration visits every pair once
+  size_t count = 0;
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    ASSERT_EQ(it.key() + 10, it.value());
+    ++count;
+  }
+  ASSERT_EQ(LARGE_NUM / 2, count);
+  for (int i = 1; i < LARGE_NUM; i += 2) {
+    c.remove(i);
+  }
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(0, c.max_chain_length());
+}
+
+// Test: Range search, copies, and moves of the compact hash table,
+// which needs fewer bytes per key than the node-based one
+TEST(CompactHashTableCollectionTest, RangeCopyAndMemory) {
+  CompactHashTableCollection<string,int> c;
+  c.add("a", 10);
+  c.add("b", 20);
+  c.add("c", 30);
+  c.add("d", 40);
+  ArrayList<string> keys;
+  c.find("b", "c", keys);
+  ASSERT_EQ(2, keys.size());
+  ASSERT_EQ(true, member(string("b"), keys));
+  ASSERT_EQ(true, member(string("c"), keys));
+  int v;
+  ASSERT_EQ(true, c.find(std::string_view("d"), v));
+  ASSERT_EQ(40, v);
+  CompactHashTableCollection<string,int> c2(c);
+  c.remove("a");
+  ASSERT_EQ(4, c2.size());
+  ASSERT_EQ(true, c2.find("a", v));
+  ASSERT_EQ(10, v);
+  c2 = c;
+  ASSERT_EQ(3, c2.size());
+  ASSERT_EQ(false, c2.find("a", v));
+  CompactHashTableCollection<string,int> c3(std::move(c2));
+  ASSERT_EQ(3, c3.size());
+  ASSERT_EQ(true, c3.find("b", v));
+  ASSERT_EQ(20, v);
+  CompactHashTableCollection<int,int> compact;
+  HashTableCollection<int,int> chained;
+  for (int i = 0; i < 10000; ++i) {
+    compact.add(i, i);
+    chained.add(i, i);
+  }
+  ASSERT_LT(compact.memory_bytes(), chained.memory_bytes());
+}
+
+// Test: Pooled red-black tree behaves like the heap allocated one
+TEST(RBTCollectionTest, NodePoolAddRemove) {
+  RBTCollection<int,int,NodePool> c;
+  int LARGE_NUM = 5000;
+  int v;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    c.add(i, i + 10);
+  }
+  ASSERT_EQ(LARGE_NUM, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  for (int i = LARGE_NUM - 1; i >= LARGE_NUM / 2; --i) {
+    c.remove(i);
+  }
+  ASSERT_EQ(LARGE_NUM / 2, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  // removed nodes are recycled by the next adds
+  for (int i = LARGE_NUM / 2; i < LARGE_NUM; ++i) {
+    c.add(i, i);
+  }
+  ASSERT_EQ(true, c.find(LARGE_NUM - 1, v));
+  ASSERT_EQ(LARGE_NUM - 1, v);
+  RBTCollection<int,int,NodePool> c2(c);
+  ASSERT_EQ(LARGE_NUM, c2.size());
+  ASSERT_EQ(true, c2.find(0, v));
+  ASSERT_EQ(10, v);
+}
+
+// Test: Node pool recycles freed nodes before carving new ones
+TEST(NodePoolTest, RecyclesNodes) {
+  NodePool<pair<string,int>> pool;
+  pair<string,int>* a = pool.allocate();
+  a->first = "a";
+  size_t reserved = pool.bytes_reserved();
+  ASSERT_LT(0, reserved);
+  pool.deallocate(a);
+  pair<string,int>* b = pool.allocate();
+  ASSERT_EQ(a, b);
+  ASSERT_EQ("", b->first);
+  pool.deallocate(b);
+  pool.release();
+  ASSERT_EQ(0, pool.bytes_reserved());
+}
+
+// Test: B+ tree splits and merges stay valid with small nodes
+TEST(BPlusTreeCollectionTest, LargeInputAddRemove) {
+  BPlusTreeCollection<int,int,4> c;
+  int LARGE_NUM = 5000;
+  int v;
+  for (int i = 0; i < LARGE_NUM; ++i) {
+    // add from both ends toward the middle
+    int key = (i % 2) ? i : LARGE_NUM - i;
+    c.add(key, key + 10);
+  }
+  ASSERT_EQ(LARGE_NUM, c.size());
+  ASSERT_EQ(true, c.valid_bplus_tree());
+  ASSERT_LE(c.height(), 2 * log2(LARGE_NUM));
+  for (int i = 1; i <= LARGE_NUM; i += 3) {
+    c.remove(i);
+    if (i % 100 == 1) {
+      ASSERT_EQ(true, c.valid_bplus_tree());
+    }
+  }
+  ASSERT_EQ(true, c.valid_bplus_tree());
+  for (int i = 1; i <= LARGE_NUM; ++i) {
+    ASSERT_EQ(i % 3 != 1, c.find(i, v));
+  }
+  for (int i = 0; i <= LARGE_NUM; ++i) {
+    c.remove(i);
+  }
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(0, c.height());
+}
+
+// Test: B+ tree range search and sort scan the linked leaves
+TEST(BPlusTreeCollectionTest, RangeAndSort) {
+  BPlusTreeCollection<string,int> c;
+  c.add("c", 30);
+  c.add("a", 10);
+  c.add("e", 50);
+  c.add("b", 20);
+  c.add("d", 40);
+  ArrayList<string> keys;
+  c.find("b", "d", keys);
+  ASSERT_EQ(3, keys.size());
+  string k;
+  keys.get(0, k);
+  ASSERT_EQ("b", k);
+  keys.get(2, k);
+  ASSERT_EQ("d", k);
+  ArrayList<string> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(5, sorted.size());
+  for (size_t i = 0; i < sorted.size() - 1; ++i) {
+    string k1, k2;
+    sorted.get(i, k1);
+    sorted.get(i + 1, k2);
+    ASSERT_LT(k1, k2);
+  }
+  BPlusTreeCollection<string,int> c2(c);
+  c.remove("a");
+  int v;
+  ASSERT_EQ(true, c2.find("a", v));
+  ASSERT_EQ(10, v);
+  ASSERT_EQ(true, c2.valid_bplus_tree());
+}
+
+// Test: Bulk loading builds valid, balanced red-black trees of any size
+TEST(RBTCollectionTest, BulkLoad) {
+  for (int n = 0; n <= 70; ++n) {
+    ArrayList<pair<int,int>> kv_pairs;
+    for (int i = 0; i < n; ++i) {
+      kv_pairs.add(pair<int,int>(i, i + 10));
+    }
+    RBTCollection<int,int> c(kv_pairs);
+    ASSERT_EQ(n, c.size());
+    ASSERT_EQ(true, c.valid_rbt());
+    ASSERT_LE(c.height(), log2(n + 1) + 1);
+    int v;
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(true, c.find(i, v));
+      ASSERT_EQ(i + 10, v);
+    }
+    // the bulk loaded tree keeps working under adds and removes
+    c.add(n, 0);
+    c.add(-1, 0);
+    ASSERT_EQ(true, c.valid_rbt());
+    c.remove(n / 2);
+    ASSERT_EQ(true, c.valid_rbt());
+    ASSERT_EQ(n + 1, c.size());
+  }
+}
+
+// Test: Bulk loading sorts unsorted input and drops repeated keys
+TEST(AVLCollectionTest, BulkLoadUnsorted) {
+  ArrayList<pair<string,int>> kv_pairs;
+  kv_pairs.add(pair<string,int>("d", 40));
+  kv_pairs.add(pair<string,int>("b", 20));
+  kv_pairs.add(pair<string,int>("a", 10));
+  kv_pairs.add(pair<string,int>("b", 99));
+  kv_pairs.add(pair<string,int>("c", 30));
+  AVLCollection<string,int> c;
+  c.add("z", 0);
+  c.bulk_load(kv_pairs);
+  ASSERT_EQ(4, c.size());
+  ASSERT_EQ(3, c.height());
+  int v;
+  ASSERT_EQ(false, c.find("z", v));
+  ASSERT_EQ(true, c.find("b", v));
+  ASSERT_EQ(20, v);
+  ArrayList<string> sorted;
+  c.sort(sorted);
+  string k;
+  sorted.get(0, k);
+  ASSERT_EQ("a", k);
+  sorted.get(3, k);
+  ASSERT_EQ("d", k);
+  BSTCollection<string,int> c2(kv_pairs);
+  ASSERT_EQ(4, c2.size());
+  ASSERT_EQ(3, c2.height());
+}
+
+// Test: Every collection can be searched with a string_view or C string
+template<typename C>
+void check_heterogeneous_find()
+{
+  C c;
+  c.add("apple", 10);
+  c.add("banana", 20);
+  c.add("cherry", 30);
+  string text = "a banana split";
+  string_view view(text.data() + 2, 6);
+  int v = 0;
+  ASSERT_EQ(true, c.find(view, v));
+  ASSERT_EQ(20, v);
+  ASSERT_EQ(true, c.find("cherry", v));
+  ASSERT_EQ(30, v);
+  ASSERT_EQ(true, c.find(string("apple"), v));
+  ASSERT_EQ(10, v);
+  ASSERT_EQ(false, c.find(string_view(text.data(), 1), v));
+  ASSERT_EQ(false, c.find("durian", v));
+}
+
+// other key types still convert the search key to K first
+template<typename C>
+void check_converted_find()
+{
+  C c;
+  c.add(1, 10);
+  int v = 0;
+  ASSERT_EQ(true, c.find(1.5, v));
+  ASSERT_EQ(10, v);
+  ASSERT_EQ(true, c.find(size_t(1), v));
+}
+
+TEST(CollectionTest, HeterogeneousFind) {
+  check_heterogeneous_find<HashTableCollection<string,int>>();
+  check_heterogeneous_find<SwissTableCollection<string,int>>();
+  check_heterogeneous_find<BinSearchCollection<string,int>>();
+  check_heterogeneous_find<BSTCollection<string,int>>();
+  check_heterogeneous_find<AVLCollection<string,int>>();
+  check_heterogeneous_find<RBTCollection<string,int>>();
+  check_heterogeneous_find<BPlusTreeCollection<string,int,4>>();
+  check_converted_find<HashTableCollection<int,int>>();
+  check_converted_find<CompactHashTableCollection<int,int>>();
+  check_converted_find<SwissTableCollection<int,int>>();
+  check_converted_find<ConcurrentHashTableCollection<int,int>>();
+  check_converted_find<BinSearchCollection<int,int>>();
+  check_converted_find<BSTCollection<int,int>>();
+  check_converted_find<AVLCollection<int,int>>();
+  check_converted_find<RBTCollection<int,int>>();
+  check_converted_find<BPlusTreeCollection<int,int,4>>();
+  check_converted_find<ConcurrentRBTCollection<int,int>>();
+  check_converted_find<PersistentAVLCollection<int,int>>();
+}
+
+// Test: Iterators visit every pair once (in key order for the sorted
+// collections) and lower_bound/upper_bound skip keys outside the bound
+template<typename C>
+void check_iteration(bool sorted)
+{
+  C c;
+  ASSERT_EQ(true, c.begin() == c.end());
+  const int n = 200;
+  for (int i = 0; i < n; ++i) {
+    c.add((i * 37) % n * 2, i); // the even keys 0 to 398
+  }
+  bool seen[2 * n] = {};
+  int count = 0, prev = -1;
+  for (auto kv : c) {
+    ASSERT_EQ(0, kv.first % 2);
+    ASSERT_EQ(false, seen[kv.first]);
+    seen[kv.first] = true;
+    int v;
+    c.find(kv.first, v);
+    ASSERT_EQ(v, kv.second);
+    if (sorted) {
+      ASSERT_LT(prev, kv.first);
+    }
+    prev = kv.first;
+    ++count;
+  }
+  ASSERT_EQ(n, count);
+  // 102 to 398 are >= 101, and all but 102 are > 102
+  count = 0;
+  for (auto it = c.lower_bound(101); it != c.end(); ++it) {
+    ASSERT_GE(it.key(), 102);
+    if (sorted && count == 0) {
+      ASSERT_EQ(102, it.key());
+    }
+    ++count;
+  }
+  ASSERT_EQ(149, count);
+  count = 0;
+  for (auto it = c.upper_bound(102); it != c.end(); ++it) {
+    ASSERT_GT(it.key(), 102);
+    ++count;
+  }
+  ASSERT_EQ(148, count);
+  ASSERT_EQ(true, c.lower_bound(2 * n) == c.end());
+  // a copy moves on its own
+  auto a = c.begin();
+  auto b = a;
+  ++b;
+  ASSERT_EQ(true, a != b);
+  ++a;
+  ASSERT_EQ(true, a == b);
+  ASSERT_EQ(&(*a).second, &b.value());
+}
+
+TEST(CollectionTest, Iteration) {
+  check_iteration<ArrayListCollection<int,int>>(false);
+  check_iteration<BinSearchCollection<int,int>>(true);
+  check_iteration<HashTableCollection<int,int>>(false);
+  check_iteration<SwissTableCollection<int,int>>(false);
+  check_iteration<ConcurrentHashTableCollection<int,int>>(false);
+  check_iteration<BSTCollection<int,int>>(true);
+  check_iteration<AVLCollection<int,int>>(true);
+  check_iteration<RBTCollection<int,int>>(true);
+  check_iteration<BPlusTreeCollection<int,int,4>>(true);
+  check_iteration<ConcurrentRBTCollection<int,int>>(true);
+  check_iteration<PersistentAVLCollection<int,int>>(true);
+}
+
+// Test: scan visits exactly the keys the range find returns, in order,
+// and stops as soon as the functor returns false
+template<typename C>
+void check_scan()
+{
+  C c;
+  for (int i = 0; i < 300; ++i) {
+    c.add((i * 7) % 300, i);
+  }
+  ArrayList<int> expected;
+  c.find(40, 120, expected);
+  ArrayList<int> seen;
+  c.scan(40, 120, [&c, &seen](const int& k, const int& v) {
+    int val;
+    c.find(k, val);
+    EXPECT_EQ(val, v);
+    seen.add(k);
+    return true;
+  });
+  ASSERT_EQ(81, seen.size());
+  ASSERT_EQ(expected.size(), seen.size());
+  for (size_t i = 0; i < seen.size(); ++i) {
+    ASSERT_EQ(40 + int(i), seen[i]);
+  }
+  int count = 0;
+  c.scan(0, 299, [&count](const int&, const int&) {
+    return ++count < 5;
+  });
+  ASSERT_EQ(5, count);
+  count = 0;
+  c.scan(500, 600, [&count](const int&, const int&) {
+    return ++count > 0;
+  });
+  ASSERT_EQ(0, count);
+}
+
+TEST(CollectionTest, RangeScan) {
+  check_scan<BSTCollection<int,int>>();
+  check_scan<AVLCollection<int,int>>();
+  check_scan<RBTCollection<int,int>>();
+  check_scan<BPlusTreeCollection<int,int,4>>();
+}
+
+// Test: rank, select, and count agree with a brute-force count over
+// the keys present, through adds and removes (including removes of
+// nodes with two children), copies, and bulk loads
+template<typename C>
+void check_order_statistics()
+{
+  const int n = 1000;
+  bool present[n] = {false};
+  C c;
+  auto check = [&present](const C& c) {
+    int smaller = 0;
+    for (int k = 0; k < n; ++k) {
+      ASSERT_EQ(smaller, c.rank(k));
+      if (present[k]) {
+        int key = -1;
+        ASSERT_EQ(true, c.select(smaller, key));
+        ASSERT_EQ(k, key);
+        ++smaller;
+      }
+    }
+    int key;
+    ASSERT_EQ(false, c.select(smaller, key));
+    ASSERT_EQ(smaller, c.size());
+    for (int k1 = 0; k1 < n; k1 += 97) {
+      int expected = 0;
+      for (int k2 = k1; k2 < n; ++k2) {
+        expected += present[k2];
+        if (k2 % 31 == 0) {
+          ASSERT_EQ(expected, c.count(k1, k2));
+        }
+      }
+      ASSERT_EQ(0, c.count(k1 + 1, k1));
+    }
+    ASSERT_GE(2 * log2(c.size() + 1), c.height());
+  };
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 7919) % n;
+    c.add(k, i);
+    present[k] = true;
+  }
+  check(c);
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 104729) % n;
+    if (k % 3 != 0) {
+      c.remove(k);
+      present[k] = false;
+    }
+  }
+  c.remove(n + 1);
+  check(c);
+  C copy(c);
+  check(copy);
+  for (int k = 0; k < n; k += 5) {
+    if (!present[k + 1]) {
+      copy.add(k + 1, k);
+      present[k + 1] = true;
+    }
+    copy.remove(k);
+    present[k] = false;
+  }
+  check(copy);
+  ArrayList<std::pair<int,int>> kv_pairs;
+  for (int k = 0; k < n; ++k) {
+    present[k] = k % 2 == 0;
+    if (present[k]) {
+      kv_pairs.add(std::make_pair(k, k));
+    }
+  }
+  C loaded(kv_pairs);
+  check(loaded);
+}
+
+TEST(CollectionTest, OrderStatistics) {
+  check_order_statistics<AVLCollection<int,int>>();
+  check_order_statistics<RBTCollection<int,int>>();
+}
+
+// Test: batches (of sizes that are not a multiple of the batch width)
+// give the same results as adding, finding, and removing one at a time
+template<typename C>
+void check_batch(C& c)
+{
+  const int n = 1000;
+  int keys[n], vals[n], found_vals[2*n];
+  bool found[2*n];
+  for (int i = 0; i < n; ++i) {
+    keys[i] = (i * 7919) % n;
+    vals[i] = keys[i] * 2;
+  }
+  c.add(-1, -1);
+  c.add_batch(keys, vals, 37);
+  c.add_batch(keys + 37, vals + 37, n - 37);
+  ASSERT_EQ(n + 1, c.size());
+  // look up every key and then as many missing ones
+  int lookups[2*n];
+  for (int i = 0; i < 2*n; ++i) {
+    lookups[i] = i;
+  }
+  ASSERT_EQ(n, c.find_batch(lookups, 2*n, found_vals, found));
+  for (int i = 0; i < 2*n; ++i) {
+    ASSERT_EQ(i < n, found[i]);
+    if (i < n) {
+      ASSERT_EQ(2*i, found_vals[i]);
+    }
+  }
+  // remove the even keys (and one missing key)
+  int evens[n/2 + 1];
+  for (int i = 0; i <= n/2; ++i) {
+    evens[i] = 2*i;
+  }
+  c.remove_batch(evens, n/2 + 1);
+  ASSERT_EQ(n/2 + 1, c.size());
+  for (int k = -1; k < n; ++k) {
+    int val;
+    ASSERT_EQ(k == -1 || k % 2 == 1, c.find(k, val));
+  }
+  ASSERT_EQ(0, c.find_batch(evens, 0, found_vals, found));
+}
+
+TEST(CollectionTest, BatchOperations) {
+  HashTableCollection<int,int> hash_table;
+  check_batch(hash_table);
+  HashTableCollection<int,int> incremental(1);
+  check_batch(incremental);
+  // the table grew ahead of the batch, so it is under the load threshold
+  ASSERT_GT(0.75, incremental.avg_chain_length());
+  BSTCollection<int,int> bst;
+  check_batch(bst);
+  AVLCollection<int,int> avl;
+  check_batch(avl);
+  RBTCollection<int,int> rbt;
+  check_batch(rbt);
+  ASSERT_EQ(true, rbt.valid_rbt());
+}
+
+// generic code, templated on the collection (or front end) type
+template<typename C>
+int add_find_remove(C& c)
+{
+  for (int i = 0; i < 100; ++i) {
+    c.add(i, i * i);
+  }
+  for (int i = 0; i < 100; i += 2) {
+    c.remove(i);
+  }
+  int total = 0;
+  for (int i = 0; i < 100; ++i) {
+    int val;
+    if (c.find(i, val)) {
+      total += val;
+    }
+  }
+  ArrayList<int> keys;
+  c.find(10, 19, keys);
+  return total + c.size() + keys.size();
+}
+
+TEST(CollectionTest, StaticDispatch) {
+  static_assert(is_collection<HashTableCollection<int,int>>::value, "");
+  static_assert(is_collection<Collection<int,int>>::value, "");
+  static_assert(!is_collection<ArrayList<int>>::value, "");
+  static_assert(!is_collection<int>::value, "");
+  HashTableCollection<int,int> a;
+  RBTCollection<int,int> b;
+  Collection<int,int>& dynamic = a;
+  auto fast_hash = static_collection(a);
+  auto fast_tree = static_collection(b);
+  int expected = add_find_remove(dynamic);
+  ASSERT_EQ(166650 + 50 + 5, expected);
+  for (int i = 0; i < 100; ++i) {
+    a.remove(i);
+  }
+  ASSERT_EQ(expected, add_find_remove(fast_hash));
+  ASSERT_EQ(expected, add_find_remove(fast_tree));
+  ASSERT_EQ(true, fast_tree.get().valid_rbt());
+  int k = 1;
+  for (auto kv : fast_tree) {
+    ASSERT_EQ(k, kv.first);
+    k += 2;
+  }
+  ASSERT_EQ(101, k);
+}
+
+// Test: every hash and index policy pairing stores and finds keys, and
+// the chain length histogram accounts for every bucket and key
+template<typename Hash, typename Index>
+void check_hash_policy(size_t stride, size_t max_chain)
+{
+  HashTableCollection<int,int,Hash,Index> c;
+  const int n = 2000;
+  for (int i = 0; i < n; ++i) {
+    c.add(i * stride, i);
+  }
+  for (int i = 0; i < n; i += 3) {
+    c.remove(i * stride);
+  }
+  for (int i = 0; i < n; ++i) {
+    int val;
+    ASSERT_EQ(i % 3 != 0, c.find(i * stride, val));
+  }
+  ArrayList<size_t> counts;
+  c.chain_length_histogram(counts);
+  ASSERT_EQ(c.max_chain_length() + 1, counts.size());
+  size_t buckets = 0, keys = 0;
+  for (size_t len = 0; len < counts.size(); ++len) {
+    buckets += counts[len];
+    keys += len * counts[len];
+  }
+  ASSERT_EQ(c.size(), keys);
+  ASSERT_EQ(c.size(), c.avg_chain_length() * buckets);
+  ASSERT_GE(max_chain, c.max_chain_length());
+}
+
+TEST(HashTableCollectionTest, HashPolicies) {
+  check_hash_policy<KeyHash<int>, MaskIndex>(1, 4);
+  // keys 1024 apart only differ above their low 10 bits, so with the
+  // identity std::hash<int> a mask of 4096 buckets uses just 4 of them
+  HashTableCollection<int,int,KeyHash<int>,MaskIndex> weak;
+  for (int i = 0; i < 2000; ++i) {
+    weak.add(i * 1024, i);
+  }
+  ASSERT_EQ(500, weak.max_chain_length());
+  check_hash_policy<KeyHash<int>, MaskIndex>(1024, 500);
+  check_hash_policy<KeyHash<int>, ModuloIndex>(1, 4);
+  check_hash_policy<FibonacciHash<int>, MaskIndex>(1024, 10);
+  check_hash_policy<FibonacciHash<int>, FastRangeIndex>(1024, 10);
+  check_hash_policy<WyHash<int>, MaskIndex>(1024, 10);
+  check_hash_policy<WyHash<int>, ModuloIndex>(1024, 10);
+  check_hash_policy<WyHash<int>, FastRangeIndex>(1024, 10);
+  // string hashes match across key types, for every tail length
+  WyHash<string> wy;
+  ArrayList<size_t> codes;
+  string key;
+  for (int len = 0; len < 40; ++len) {
+    ASSERT_EQ(wy(key), wy(string_view(key)));
+    ASSERT_EQ(wy(key), wy(key.c_str()));
+    for (size_t i = 0; i < codes.size(); ++i) {
+      ASSERT_NE(codes[i], wy(key));
+    }
+    codes.add(wy(key));
+    key += char('a' + len % 26);
+  }
+  HashTableCollection<string,int,WyHash<string>,MaskIndex> c;
+  c.add("alpha", 1);
+  c.add("beta", 2);
+  int val;
+  ASSERT_EQ(true, c.find(string_view("beta"), val));
+  ASSERT_EQ(2, val);
+  ASSERT_EQ(false, c.find("gamma", val));
+}
+
+TEST(InstrumentationTest, LatencyHistogram) {
+  // every time lands in a bucket that holds it, with buckets within
+  // 12.5% of their lowest time
+  for (uint64_t ns = 0; ns < 100000; ns += 1 + ns / 64) {
+    size_t b = LatencyHistogram::bucket(ns);
+    ASSERT_LE(LatencyHistogram::bucket_low(b), ns);
+    ASSERT_GE(LatencyHistogram::bucket_high(b), ns);
+    ASSERT_LE(LatencyHistogram::bucket_high(b) - LatencyHistogram::bucket_low(b),
+              LatencyHistogram::bucket_low(b) / 8);
+  }
+  ASSERT_GT(LatencyHistogram::BUCKETS, LatencyHistogram::bucket(UINT64_MAX));
+  LatencyHistogram h;
+  for (uint64_t ns = 1; ns <= 1000; ++ns) {
+    h.record(ns);
+  }
+  h.record(1000000);
+  ASSERT_EQ(1001, h.count());
+  ASSERT_EQ(1000000, h.max());
+  ASSERT_NEAR(500, h.percentile(0.5), 500 / 8);
+  ASSERT_NEAR(990, h.percentile(0.99), 990 / 8);
+  ASSERT_EQ(1000000, h.percentile(1.0));
+  h.reset();
+  ASSERT_EQ(0, h.count());
+  ASSERT_EQ(0, h.percentile(0.5));
+#ifdef COLLECTION_INSTRUMENTATION
+  // each operation is timed once, along with the work behind it
+  RBTCollection<int,int> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.add(i, i);
+  }
+  int val;
+  for (int i = 0; i < 500; ++i) {
+    c.find(i, val);
+  }
+  ArrayList<int> keys;
+  c.find(10, 20, keys);
+  c.sort(keys);
+  c.remove(0);
+  const CollectionStats& stats = c.statistics();
+  ASSERT_EQ(1000, stats.histogram(OP_ADD).count());
+  ASSERT_EQ(500, stats.histogram(OP_FIND).count());
+  ASSERT_EQ(1, stats.histogram(OP_FIND_RANGE).count());
+  ASSERT_EQ(1, stats.histogram(OP_SORT).count());
+  ASSERT_EQ(1, stats.histogram(OP_REMOVE).count());
+  // sorted adds rotate all the way, and every find visits a node
+  ASSERT_LT(900, stats.counter(ROTATIONS));
+  ASSERT_LE(500, stats.counter(NODES_VISITED));
+  HashTableCollection<int,int> t;
+  for (int i = 0; i < 1000; ++i) {
+    t.add(i, i);
+  }
+  ASSERT_LT(0, t.statistics().counter(REHASHES));
+  c.reset_statistics();
+  ASSERT_EQ(0, stats.histogram(OP_ADD).count());
+#endif
+}
+
+TEST(WorkloadTest, MixesAndDistributions) {
+  // the mix matches the fractions asked for
+  WorkloadSpec spec = ycsb_workload('B', UNIFORM);
+  spec.record_count = 1000;
+  spec.operation_count = 20000;
+  Workload b(spec);
+  size_t kinds[WORKLOAD_OPERATION_COUNT] = {0};
+  for (size_t i = 0; i < b.operations().size(); ++i) {
+    ++kinds[b.operations()[i].op];
+  }
+  ASSERT_NEAR(19000, kinds[WORKLOAD_READ], 300);
+  ASSERT_NEAR(1000, kinds[WORKLOAD_UPDATE], 300);
+  ASSERT_EQ(0, kinds[WORKLOAD_INSERT] + kinds[WORKLOAD_SCAN]);
+  // Zipfian keys are skewed: the most popular record gets far more
+  // than its uniform share
+  spec.distribution = ZIPFIAN;
+  Workload z(spec);
+  ArrayList<size_t> hits;
+  for (size_t i = 0; i < 1000; ++i) {
+    hits.add(0);
+  }
+  for (size_t i = 0; i < z.operations().size(); ++i) {
+    ++hits[z.operations()[i].key];
+  }
+  hits.sort();
+  ASSERT_LT(1000, hits[999]);
+  // inserts go in key order, reverse key order, or shuffled, and every
+  // key is distinct and sorts in key order
+  spec = ycsb_workload('C');
+  spec.record_count = 0;
+  spec.operation_count = 500;
+  spec.read_fraction = 0;
+  spec.insert_fraction = 1;
+  spec.key_length = 1;
+  spec.insert_order = SEQUENTIAL;
+  Workload seq(spec);
+  spec.insert_order = REVERSE;
+  Workload rev(spec);
+  ASSERT_EQ(2, seq.key(0).size());
+  for (size_t i = 0; i < 500; ++i) {
+    ASSERT_EQ(i, seq.operations()[i].key);
+    ASSERT_EQ(499 - i, rev.operations()[i].key);
+    if (i > 0) {
+      ASSERT_LT(seq.key(i - 1), seq.key(i));
+    }
+  }
+  // with no keys at all there is nothing to shuffle
+  spec.operation_count = 0;
+  spec.insert_order = RANDOM;
+  Workload none(spec);
+  ASSERT_EQ(0, none.operations().size());
+  // running a workload changes the collection as the operations say
+  spec = ycsb_workload('E');
+  spec.record_count = 2000;
+  spec.operation_count = 1000;
+  Workload e(spec);
+  AVLCollection<string,int> c;
+  e.load(c);
+  ASSERT_EQ(2000, c.size());
+  WorkloadResult result;
+  e.run(c, result);
+  size_t inserts = result.latency[WORKLOAD_INSERT].count();
+  ASSERT_NEAR(50, inserts, 30);
+  ASSERT_EQ(2000 + inserts, c.size());
+  ASSERT_EQ(1000, result.overall.count());
+  ASSERT_LT(0, result.ops_per_sec);
+}
+
+TEST(CollectionTest, IterationDuringMigration) {
+  // keys still in unmigrated old buckets are visited too
+  HashTableCollection<int,int> c(1);
+  for (int i = 0; i < 100; ++i) {
+    c.add(i, i);
+  }
+  ASSERT_EQ(true, c.migrating());
+  int count = 0;
+  for (auto kv : c) {
+    ASSERT_EQ(kv.first, kv.second);
+    ++count;
+  }
+  ASSERT_EQ(100, count);
+}
+
+TEST(CollectionTest, IteratorsKeepTheirVersion) {
+  // the copy-on-write trees keep an iterator's version alive
+  PersistentAVLCollection<int,int> p;
+  ConcurrentRBTCollection<int,int> r;
+  for (int i = 0; i < 100; ++i) {
+    p.add(i, i);
+    r.add(i, i);
+  }
+  auto p_it = p.lower_bound(50);
+  auto r_it = r.lower_bound(50);
+  for (int i = 0; i < 100; ++i) {
+    p.remove(i);
+    r.remove(i);
+  }
+  ASSERT_EQ(0, p.size());
+  ASSERT_EQ(0, r.size());
+  for (int k = 50; k < 100; ++k, ++p_it, ++r_it) {
+    ASSERT_EQ(k, p_it.key());
+    ASSERT_EQ(k, r_it.value());
+  }
+  ASSERT_EQ(true, p_it == p.end());
+  ASSERT_EQ(true, r_it == r.end());
+}
+
+// key type that counts how many times keys are copied
+struct CountedKey {
+  static int copies;
+  int key = 0;
+  CountedKey() {}
+  CountedKey(int k) : key(k) {}
+  CountedKey(const CountedKey& rhs) : key(rhs.key) {++copies;}
+  CountedKey(CountedKey&& rhs) : key(rhs.key) {}
+  CountedKey& operator=(const CountedKey& rhs) {key = rhs.key; ++copies; return *this;}
+  CountedKey& operator=(CountedKey&& rhs) {key = rhs.key; return *this;}
+  bool operator==(const CountedKey& rhs) const {return key == rhs.key;}
+  bool operator!=(const CountedKey& rhs) const {return key != rhs.key;}
+  bool operator<(const CountedKey& rhs) const {return key < rhs.key;}
+  bool operator>(const CountedKey& rhs) const {return key > rhs.key;}
+  bool operator<=(const CountedKey& rhs) const {return key <= rhs.key;}
+  bool operator>=(const CountedKey& rhs) const {return key >= rhs.key;}
+};
+int CountedKey::copies = 0;
+
+namespace std {
+  template<>
+  struct hash<CountedKey> {
+    size_t operator()(const CountedKey& k) const {return hash<int>()(k.key);}
+  };
+}
+
+// Test: Rvalue adds and collection moves never copy a key (except
+// for the separator keys a B+ tree copies into its interior nodes)
+template<typename C>
+void check_move_add(int max_copies = 0)
+{
+  CountedKey::copies = 0;
+  C c;
+  for (int i = 0; i < 500; ++i) {
+    c.add(CountedKey((i * 7919) % 500), int(i));
+  }
+  C c2(std::move(c));
+  C c3;
+  c3 = std::move(c2);
+  ASSERT_LE(CountedKey::copies, max_copies);
+  ASSERT_EQ(500, c3.size());
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(0, c2.size());
+  int v;
+  ASSERT_EQ(true, c3.find(CountedKey(7919 % 500), v));
+  ASSERT_EQ(1, v);
+  // the moved from collections are still usable
+  c.add(CountedKey(1), 1);
+  ASSERT_EQ(true, c.find(CountedKey(1), v));
+}
+
+TEST(CollectionTest, MoveAdd) {
+  check_move_add<ArrayListCollection<CountedKey,int>>();
+  check_move_add<BinSearchCollection<CountedKey,int>>();
+  check_move_add<HashTableCollection<CountedKey,int>>();
+  check_move_add<SwissTableCollection<CountedKey,int>>();
+  check_move_add<BSTCollection<CountedKey,int>>();
+  check_move_add<AVLCollection<CountedKey,int>>();
+  check_move_add<RBTCollection<CountedKey,int>>();
+  check_move_add<RBTCollection<CountedKey,int,NodePool>>();
+  check_move_add<BPlusTreeCollection<CountedKey,int,4>>(250);
+}
+
+// Test: ArrayList emplace, move construction, and move assignment
+TEST(ArrayListTest, EmplaceAndMove) {
+  ArrayList<pair<string,int>> list;
+  for (int i = 0; i < 100; ++i) {
+    list.emplace(string(40, 'a' + i % 26), i);
+  }
+  ASSERT_EQ(true, list.add(0, pair<string,int>("first", -1)));
+  ArrayList<pair<string,int>> list2(std::move(list));
+  ASSERT_EQ(0, list.size());
+  ASSERT_EQ(101, list2.size());
+  pair<string,int> p;
+  list2.get(0, p);
+  ASSERT_EQ("first", p.first);
+  list2.get(100, p);
+  ASSERT_EQ(string(40, 'a' + 99 % 26), p.first);
+  list = std::move(list2);
+  ASSERT_EQ(101, list.size());
+  list2.add(p);
+  ASSERT_EQ(1, list2.size());
+}
+
+// item type with no default constructor that tracks live instances
+struct LiveItem {
+  static int live;
+  int val;
+  explicit LiveItem(int v) : val(v) {++live;}
+  LiveItem(const LiveItem& rhs) : val(rhs.val) {++live;}
+  LiveItem& operator=(const LiveItem& rhs) {val = rhs.val; return *this;}
+  ~LiveItem() {--live;}
+  bool operator<(const LiveItem& rhs) const {return val < rhs.val;}
+};
+int LiveItem::live = 0;
+
+// Test: Spare capacity holds no constructed items
+TEST(ArrayListTest, RawStorage) {
+  {
+    ArrayList<LiveItem> list(100);
+    ASSERT_EQ(100, list.capacity());
+    ASSERT_EQ(0, LiveItem::live);
+    for (int i = 0; i < 50; ++i) {
+      list.emplace(i);
+    }
+    ASSERT_EQ(50, LiveItem::live);
+    ASSERT_EQ(true, list.add(10, LiveItem(-1)));
+    ASSERT_EQ(true, list.remove(0));
+    ASSERT_EQ(50, LiveItem::live);
+    ASSERT_EQ(-1, list[9].val);
+    ASSERT_EQ(49, list[49].val);
+    list.shrink_to_fit();
+    ASSERT_EQ(50, list.capacity());
+    list.set_growth_factor(1.5);
+    list.emplace(50);
+    ASSERT_EQ(75, list.capacity());
+    list.reserve(10);
+    ASSERT_EQ(75, list.capacity());
+    ArrayList<LiveItem> copy(list);
+    ASSERT_EQ(102, LiveItem::live);
+    // copies grow the same way, however they were made
+    ArrayList<LiveItem> assigned;
+    assigned = list;
+    assigned.shrink_to_fit();
+    assigned.emplace(0);
+    ASSERT_EQ(76, assigned.capacity());
+    assigned = ArrayList<LiveItem>();
+    ASSERT_EQ(102, LiveItem::live);
+    list.sort();
+    ASSERT_EQ(-1, list[0].val);
+    copy.selection_sort();
+    copy.insertion_sort();
+    copy.merge_sort();
+    copy.quick_sort();
+    copy.heap_sort();
+    ASSERT_EQ(-1, copy[0].val);
+    ASSERT_EQ(102, LiveItem::live);
+  }
+  ASSERT_EQ(0, LiveItem::live);
+}
+
+// key with an insertion order that is ignored when comparing, used to
+// check that merge sort is stable
+struct StableItem {
+  int key;
+  int order;
+  bool operator<(const StableItem& rhs) const {return key < rhs.key;}
+  bool operator>(const StableItem& rhs) const {return key > rhs.key;}
+  bool operator<=(const StableItem& rhs) const {return key <= rhs.key;}
+};
+
+// Test: Every sort algorithm handles the usual adversarial inputs
+TEST(ArrayListTest, SortAlgorithms) {
+  const int n = 2000;
+  for (int pattern = 0; pattern < 6; ++pattern) {
+    for (int algorithm = 0; algorithm < 4; ++algorithm) {
+      for (int size : {0, 1, 2, 17, 129, n}) {
+        ArrayList<int> list;
+        for (int i = 0; i < size; ++i) {
+          if (pattern == 0) list.add((i * 7919) % size);       // shuffled
+          else if (pattern == 1) list.add(i);                  // sorted
+          else if (pattern == 2) list.add(size - i);           // reversed
+          else if (pattern == 3) list.add(5);                  // all equal
+          else if (pattern == 4) list.add(i < size / 2 ? i : size - i); // organ pipe
+          else list.add((i * 31) % 7);                         // few distinct
+        }
+        if (algorithm == 0) list.sort();
+        else if (algorithm == 1) list.heap_sort();
+        else if (algorithm == 2) list.merge_sort();
+        else list.insertion_sort();
+        ASSERT_EQ(size, list.size());
+        for (int i = 1; i < size; ++i) {
+          ASSERT_LE(list[i - 1], list[i]);
+        }
+        if (pattern == 0 || pattern == 1 || pattern == 2) {
+          for (int i = 0; i < size; ++i) {
+            ASSERT_EQ(pattern == 2 ? i + 1 : i, list[i]);
+          }
+        }
+      }
+    }
+  }
+  // merge sort keeps equal keys in their original order
+  ArrayList<StableItem> items;
+  for (int i = 0; i < n; ++i) {
+    items.add(StableItem{(i * 7919) % 10, i});
+  }
+  items.merge_sort();
+  for (int i = 1; i < n; ++i) {
+    ASSERT_LE(items[i - 1].key, items[i].key);
+    if (items[i - 1].key == items[i].key) {
+      ASSERT_LT(items[i - 1].order, items[i].order);
+    }
+  }
+}
+
+// Test: Parallel sort with any thread count matches a sequential sort
+TEST(ArrayListTest, ParallelSort) {
+  for (size_t threads : {1, 2, 3, 4, 7, 16}) {
+    for (int size : {0, 1, 100, 5000, 20011}) {
+      ArrayList<string> list;
+      for (int i = 0; i < size; ++i) {
+        list.add(to_string((i * 7919) % size));
+      }
+      ArrayList<string> expected(list);
+      expected.sort();
+      list.parallel_sort(threads, 64);
+      ASSERT_EQ(size, list.size());
+      for (int i = 0; i < size; ++i) {
+        ASSERT_EQ(expected[i], list[i]);
+      }
+    }
+  }
+}
+
+// Test: Radix sort orders strings byte by byte, shorter prefixes first
+TEST(RadixSortTest, Strings) {
+  ArrayList<string> list;
+  for (int i = 0; i < 3000; ++i) {
+    string key = to_string((i * 7919) % 1500);
+    if (i % 3 == 0) key += "\xe9";
+    if (i % 5 == 0) key = key.substr(0, 1);
+    list.add(key);
+  }
+  list.add("");
+  ArrayList<string> expected(list);
+  expected.sort();
+  radix_sort(list);
+  ASSERT_EQ(expected.size(), list.size());
+  for (size_t i = 0; i < list.size(); ++i) {
+    // radix sort compares bytes as unsigned, std::string does too
+    ASSERT_EQ(expected[i], list[i]);
+  }
+  // a prefix shared by every key, far longer than the stack would
+  // allow one recursive pass per byte for
+  const string prefix(20000, 'k');
+  ArrayList<string> shared;
+  for (int i = 0; i < 100; ++i) {
+    shared.add(prefix + to_string((i * 37) % 100));
+  }
+  radix_sort(shared);
+  for (size_t i = 1; i < shared.size(); ++i) {
+    ASSERT_EQ(true, shared[i - 1] < shared[i]);
+  }
+}
+
+// Test: Radix sort handles negative and full width integers
+TEST(RadixSortTest, Integers) {
+  ArrayList<int> ints;
+  ArrayList<long long> longs;
+  ArrayList<unsigned> unsigneds;
+  for (int i = 0; i < 5000; ++i) {
+    int v = (i * 7919) % 5000 - 2500;
+    ints.add(v);
+    longs.add((long long) v * 4000000007LL);
+    unsigneds.add((unsigned) v);
+  }
+  ArrayList<int> ints2(ints);
+  ArrayList<long long> longs2(longs);
+  ArrayList<unsigned> unsigneds2(unsigneds);
+  ints2.sort();
+  longs2.sort();
+  unsigneds2.sort();
+  sort_keys(ints);
+  sort_keys(longs);
+  sort_keys(unsigneds);
+  for (size_t i = 0; i < 5000; ++i) {
+    ASSERT_EQ(ints2[i], ints[i]);
+    ASSERT_EQ(longs2[i], longs[i]);
+    ASSERT_EQ(unsigneds2[i], unsigneds[i]);
+  }
+  ASSERT_EQ(-2500, ints[0]);
+}
+
+// Test: Threads adding, finding, and removing at once (with resizes)
+TEST(ConcurrentHashTableCollectionTest, ParallelAddFindRemove) {
+  const int threads = 8, per_thread = 5000;
+  ConcurrentHashTableCollection<int,int> c(4);
+  thread workers[threads];
+  for (int t = 0; t < threads; ++t) {
+    workers[t] = thread([&c, t]() {
+      for (int i = t * per_thread; i < (t + 1) * per_thread; ++i) {
+        c.add(i, i * 2);
+        int v;
+        // other threads' keys may or may not be there yet
+        c.find((i * 7919) % (threads * per_thread), v);
+      }
+    });
+  }
+  for (int t = 0; t < threads; ++t) {
+    workers[t].join();
+  }
+  ASSERT_EQ(threads * per_thread, c.size());
+  ASSERT_LE(threads * per_thread, c.capacity());
+  int v;
+  for (int i = 0; i < threads * per_thread; ++i) {
+    ASSERT_EQ(true, c.find(i, v));
+    ASSERT_EQ(i * 2, v);
+  }
+  // every thread removes the odd keys of its own range
+  for (int t = 0; t < threads; ++t) {
+    workers[t] = thread([&c, t]() {
+      for (int i = t * per_thread + 1; i < (t + 1) * per_thread; i += 2) {
+        c.remove(i);
+      }
+    });
+  }
+  for (int t = 0; t < threads; ++t) {
+    workers[t].join();
+  }
+  ASSERT_EQ(threads * per_thread / 2, c.size());
+  for (int i = 0; i < threads * per_thread; ++i) {
+    ASSERT_EQ(i % 2 == 0, c.find(i, v));
+  }
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(threads * per_thread / 2, sorted.size());
+  ASSERT_EQ(2, sorted[1]);
+}
+
+// Test: The thread holding an iterator can keep reading the table
+// (without locking its stripes twice) while a writer waits
+TEST(ConcurrentHashTableCollectionTest, ReadsWhileIterating) {
+  ConcurrentHashTableCollection<int,int> c(4);
+  for (int i = 0; i < 100; ++i) {
+    c.add(i, i);
+  }
+  thread writer;
+  int count = 0;
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    if (count == 0) {
+      // queued behind the iterator's locks
+      writer = thread([&c]() { c.add(100, 100); });
+    }
+    int v;
+    ASSERT_EQ(true, c.find(it.key(), v));
+    ASSERT_EQ(it.value(), v);
+    if (count % 25 == 0) {
+      ArrayList<int> keys;
+      c.find(10, 19, keys);
+      ASSERT_EQ(10, keys.size());
+      ASSERT_LE(8, c.capacity());
+      int inner = 0;
+      for (auto kv : c) {
+        ASSERT_EQ(kv.first, kv.second);
+        ++inner;
+      }
+      ASSERT_EQ(100, inner);
+    }
+    ++count;
+  }
+  ASSERT_EQ(100, count);
+  // the writer gets in once the iterator is gone
+  writer.join();
+  ASSERT_EQ(101, c.size());
+  int v;
+  ASSERT_EQ(true, c.find(100, v));
+}
+
+TEST(ConcurrentRBTCollectionTest, AddRemoveStaysBalanced) {
+  ConcurrentRBTCollection<int,int> c;
+  const int n = 2000;
+  for (int i = 0; i < n; ++i) {
+    c.add((i * 7919) % n, i);
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  ASSERT_EQ(n, c.size());
+  ASSERT_GE(2 * log2(n + 1), c.height());
+  c.add(5, -1);
+  ASSERT_EQ(n, c.size());
+  int v;
+  ASSERT_EQ(true, c.find(5, v));
+  ASSERT_EQ(-1, v);
+  // remove every key that is not a multiple of three
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 104729) % n;
+    if (k % 3 != 0) {
+      c.remove(k);
+      ASSERT_EQ(true, c.valid_rbt());
+    }
+  }
+  c.remove(n + 1);
+  ASSERT_EQ((n + 2) / 3, c.size());
+  for (int k = 0; k < n; ++k) {
+    ASSERT_EQ(k % 3 == 0, c.find(k, v));
+  }
+  ArrayList<int> keys;
+  c.find(10, 20, keys);
+  ASSERT_EQ(3, keys.size());
+  ASSERT_EQ(12, keys[0]);
+  ASSERT_EQ(18, keys[2]);
+  // no readers, so nothing replaced is left waiting
+  ASSERT_EQ(0, c.retired_count());
+}
+
+TEST(ConcurrentRBTCollectionTest, ReadersDuringWrites) {
+  const int readers = 4, n = 2000;
+  ConcurrentRBTCollection<int,int> c;
+  // even keys stay put, odd keys come and go
+  for (int i = 0; i < n; i += 2) {
+    c.add(i, i);
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> bad(0);
+  thread workers[readers];
+  for (int t = 0; t < readers; ++t) {
+    workers[t] = thread([&, t]() {
+      int i = t;
+      do {
+        int v;
+        int k = (i * 7919) % n & ~1;
+        if (!c.find(k, v) || v != k) {
+          ++bad;
+        }
+        ArrayList<int> keys;
+        c.find(k, k + 20, keys);
+        for (size_t j = 1; j < keys.size(); ++j) {
+          if (keys[j - 1] >= keys[j]) {
+            ++bad;
+          }
+        }
+        ++i;
+      } while (!done);
+    });
+  }
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 1; i < n; i += 2) {
+      c.add(i, i);
+    }
+    for (int i = 1; i < n; i += 2) {
+      c.remove(i);
+    }
+  }
+  done = true;
+  for (int t = 0; t < readers; ++t) {
+    workers[t].join();
+  }
+  ASSERT_EQ(0, bad);
+  ASSERT_EQ(n / 2, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+}
+
+TEST(PersistentAVLCollectionTest, SnapshotsKeepTheirContents) {
+  const int n = 1000;
+  PersistentAVLCollection<int,int> c;
+  for (int i = 0; i < n; ++i) {
+    c.add((i * 7919) % n, i);
+    ASSERT_EQ(true, c.valid_avl());
+  }
+  ASSERT_GE(1.44 * log2(n + 2), c.height());
+  PersistentAVLCollection<int,int> before = c.snapshot();
+  // change every key's fate in the live tree
+  for (int k = 0; k < n; k += 2) {
+    c.remove(k);
+    ASSERT_EQ(true, c.valid_avl());
+  }
+  for (int k = 1; k < n; k += 2) {
+    c.add(k, -k);
+  }
+  c.add(n, n);
+  PersistentAVLCollection<int,int> after = c.snapshot();
+  c.remove(n);
+  ASSERT_EQ(n / 2, c.size());
+  ASSERT_EQ(n, before.size());
+  ASSERT_EQ(n / 2 + 1, after.size());
+  int v;
+  for (int k = 0; k < n; ++k) {
+    ASSERT_EQ(true, before.find(k, v));
+    ASSERT_EQ(k % 2 == 1, c.find(k, v));
+    if (k % 2 == 1) {
+      ASSERT_EQ(-k, v);
+    }
+  }
+  ASSERT_EQ(true, after.find(n, v));
+  ASSERT_EQ(false, c.find(n, v));
+  ASSERT_EQ(true, before.valid_avl());
+  // a snapshot is a tree of its own
+  before.remove(0);
+  ASSERT_EQ(n - 1, before.size());
+  ASSERT_EQ(false, before.find(0, v));
+  ArrayList<int> keys;
+  after.sort(keys);
+  ASSERT_EQ(n / 2 + 1, keys.size());
+  ASSERT_EQ(1, keys[0]);
+  ASSERT_EQ(n, keys[n / 2]);
+}
+
+TEST(PersistentAVLCollectionTest, SnapshotReadWhileWriting) {
+  const int n = 2000;
+  PersistentAVLCollection<int,int> c;
+  for (int i = 0; i < n; ++i) {
+    c.add(i, i);
+  }
+  PersistentAVLCollection<int,int> snap = c.snapshot();
+  int bad = 0;
+  // the snapshot is read and dropped on another thread while the
+  // original keeps changing
+  thread reader([&bad](PersistentAVLCollection<int,int> s) {
+    for (int k = 0; k < n; ++k) {
+      int v;
+      if (!s.find(k, v) || v != k) {
+        ++bad;
+      }
+    }
+  }, std::move(snap));
+  for (int k = 0; k < n; ++k) {
+    c.remove(k);
+  }
+  reader.join();
+  ASSERT_EQ(0, bad);
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(0, snap.size());
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
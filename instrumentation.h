@@ -0,0 +1,282 @@
+//----------------------------------------------------------------------
+// FILE: instrumentation.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Optional instrumentation for the collections. When the code is
+//  compiled with COLLECTION_INSTRUMENTATION defined, every collection
+//  times each add, remove, find, find range, and sort into a latency
+//  histogram, and counts the structural work behind them (rotations,
+//  rehashes, and nodes visited). Otherwise the hooks compile to nothing
+//  and the collections are unchanged.
+//
+//  The histograms are log-bucketed (as in HdrHistogram): each power of
+//  two range of nanoseconds is split into 8 buckets, so a recorded
+//  time is off by at most 12.5% while a few hundred counters cover
+//  every possible time. That keeps the rare slow operations (a rehash,
+//  a long run of rebalancing) that an average hides.
+//----------------------------------------------------------------------
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <stdint.h>
+
+
+// the timed operations
+enum CollectionOperation {
+  OP_ADD, OP_REMOVE, OP_FIND, OP_FIND_RANGE, OP_SORT, OPERATION_COUNT
+};
+
+// the structural counters: tree rotations, hash table rehashes (each
+// growth of the table), and the nodes (tree or chain nodes, or
+// compared slots) visited while looking for a key
+enum CollectionCounter {
+  ROTATIONS, REHASHES, NODES_VISITED, COUNTER_COUNT
+};
+
+
+// Log-bucketed histogram of nanosecond times. Recording is thread safe
+// (the concurrent collections record from many threads), and copies
+// start out empty.
+class LatencyHistogram
+{
+public:
+  // buckets per power of two is 2^SUB_BITS
+  static constexpr int SUB_BITS = 3;
+  static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+  LatencyHistogram() { reset(); }
+  LatencyHistogram(const LatencyHistogram&) { reset(); }
+  LatencyHistogram& operator=(const LatencyHistogram&) { return *this; }
+
+  void record(uint64_t ns);
+  void reset();
+
+  uint64_t count() const { return total_count.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_ns.load(std::memory_order_relaxed); }
+  double mean() const;
+  // the (bucket upper bound) time at or below which fraction p (0 to 1)
+  // of the recorded times are
+  uint64_t percentile(double p) const;
+
+  // the bucket a time goes in, and the smallest and largest time in a
+  // bucket
+  static size_t bucket(uint64_t ns);
+  static uint64_t bucket_low(size_t index);
+  static uint64_t bucket_high(size_t index);
+  // number of recorded times in a bucket
+  uint64_t bucket_count(size_t index) const;
+
+private:
+  std::atomic<uint64_t> counts[BUCKETS];
+  std::atomic<uint64_t> total_count;
+  std::atomic<uint64_t> total_ns;
+  std::atomic<uint64_t> max_ns;
+};
+
+
+// The histograms and counters of one collection
+class CollectionStats
+{
+public:
+  const LatencyHistogram& histogram(CollectionOperation op) const { return histograms[op]; }
+  uint64_t counter(CollectionCounter c) const { return counters[c].load(std::memory_order_relaxed); }
+
+  void record(CollectionOperation op, uint64_t ns) { histograms[op].record(ns); }
+  void count(CollectionCounter c, uint64_t n = 1) { counters[c].fetch_add(n, std::memory_order_relaxed); }
+  void reset();
+
+  // Write the statistics as text: comment lines with the counters and
+  // a summary of each operation, then one row per bucket (from the
+  // first to the last bucket used) with its lowest time in column 1
+  // and the number of adds, removes, finds, find ranges, and sorts in
+  // columns 2-6, which plot_stats.gp can plot directly
+  void dump(std::ostream& out) const;
+
+  CollectionStats() { reset(); }
+  CollectionStats(const CollectionStats&) { reset(); }
+  CollectionStats& operator=(const CollectionStats&) { return *this; }
+
+private:
+  LatencyHistogram histograms[OPERATION_COUNT];
+  std::atomic<uint64_t> counters[COUNTER_COUNT];
+};
+
+
+// Records the time from its construction to its destruction (the end
+// of the enclosing scope) as one operation
+class OperationTimer
+{
+public:
+  OperationTimer(CollectionStats& a_stats, CollectionOperation an_op)
+    : stats(a_stats), op(an_op), start(std::chrono::steady_clock::now()) {}
+  ~OperationTimer()
+  {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stats.record(op, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+private:
+  CollectionStats& stats;
+  CollectionOperation op;
+  std::chrono::steady_clock::time_point start;
+  OperationTimer(const OperationTimer&);
+  OperationTimer& operator=(const OperationTimer&);
+};
+
+
+// The hooks the collections use (inside their member functions, where
+// the collection_stats member of Collection is in scope)
+#ifdef COLLECTION_INSTRUMENTATION
+#define COLLECTION_TIME(op) OperationTimer operation_timer(this->collection_stats, op)
+#define COLLECTION_COUNT(c, n) this->collection_stats.count(c, n)
+#else
+#define COLLECTION_TIME(op) ((void) 0)
+#define COLLECTION_COUNT(c, n) ((void) 0)
+#endif
+
+
+inline void LatencyHistogram::record(uint64_t ns)
+{
+  counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+  total_count.fetch_add(1, std::memory_order_relaxed);
+  total_ns.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t old_max = max_ns.load(std::memory_order_relaxed);
+  while (ns > old_max && !max_ns.compare_exchange_weak(old_max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+inline void LatencyHistogram::reset()
+{
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+  total_count.store(0, std::memory_order_relaxed);
+  total_ns.store(0, std::memory_order_relaxed);
+  max_ns.store(0, std::memory_order_relaxed);
+}
+
+inline double LatencyHistogram::mean() const
+{
+  uint64_t n = count();
+  return n > 0 ? static_cast<double>(total_ns.load(std::memory_order_relaxed)) / n : 0;
+}
+
+inline uint64_t LatencyHistogram::percentile(double p) const
+{
+  uint64_t n = count();
+  if (n == 0) {
+    return 0;
+  }
+  // nearest rank
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p * n));
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += bucket_count(i);
+    if (seen >= rank) {
+      // no time recorded is above the max
+      return bucket_high(i) < max() ? bucket_high(i) : max();
+    }
+  }
+  return max();
+}
+
+inline size_t LatencyHistogram::bucket(uint64_t ns)
+{
+  const uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+  if (ns < 2 * SUB_COUNT) {
+    // small times get a bucket each
+    return ns;
+  }
+  // position of the highest set bit
+  int high = 0;
+#ifdef __GNUC__
+  high = 63 - __builtin_clzll(ns);
+#else
+  for (uint64_t v = ns; v > 1; v >>= 1) {
+    ++high;
+  }
+#endif
+  // the SUB_BITS bits below the highest pick the bucket in its range
+  size_t sub = (ns >> (high - SUB_BITS)) & (SUB_COUNT - 1);
+  return ((high - SUB_BITS) << SUB_BITS) + sub + SUB_COUNT;
+}
+
+inline uint64_t LatencyHistogram::bucket_low(size_t index)
+{
+  const uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+  if (index < 2 * SUB_COUNT) {
+    return index;
+  }
+  int shift = static_cast<int>((index - SUB_COUNT) >> SUB_BITS);
+  uint64_t sub = index & (SUB_COUNT - 1);
+  return (SUB_COUNT + sub) << shift;
+}
+
+inline uint64_t LatencyHistogram::bucket_high(size_t index)
+{
+  if (index + 1 == BUCKETS) {
+    return UINT64_MAX;
+  }
+  return bucket_low(index + 1) - 1;
+}
+
+inline uint64_t LatencyHistogram::bucket_count(size_t index) const
+{
+  return counts[index].load(std::memory_order_relaxed);
+}
+
+
+inline void CollectionStats::reset()
+{
+  for (int op = 0; op < OPERATION_COUNT; ++op) {
+    histograms[op].reset();
+  }
+  for (int c = 0; c < COUNTER_COUNT; ++c) {
+    counters[c].store(0, std::memory_order_relaxed);
+  }
+}
+
+inline void CollectionStats::dump(std::ostream& out) const
+{
+  const char* op_names[] = {"add", "remove", "find", "find range", "sort"};
+  out << "# rotations = " << counter(ROTATIONS) << "\n"
+      << "# rehashes = " << counter(REHASHES) << "\n"
+      << "# nodes visited = " << counter(NODES_VISITED) << "\n";
+  for (int op = 0; op < OPERATION_COUNT; ++op) {
+    const LatencyHistogram& h = histograms[op];
+    out << "# " << op_names[op] << ": count = " << h.count()
+        << ", mean = " << h.mean() << ", p50 = " << h.percentile(0.5)
+        << ", p99 = " << h.percentile(0.99) << ", p99.9 = " << h.percentile(0.999)
+        << ", max = " << h.max() << "\n";
+  }
+  out << "# Column 1 = Lowest time in the bucket (nanoseconds)\n"
+      << "# Columns 2-6 = Number of adds, removes, finds, find ranges, and sorts in the bucket\n";
+  // only the buckets from the first to the last one used
+  size_t first = LatencyHistogram::BUCKETS, last = 0;
+  for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+      if (histograms[op].bucket_count(i) > 0) {
+        first = i < first ? i : first;
+        last = i;
+      }
+    }
+  }
+  for (size_t i = first; i <= last && first < LatencyHistogram::BUCKETS; ++i) {
+    out << LatencyHistogram::bucket_low(i);
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+      out << " " << histograms[op].bucket_count(i);
+    }
+    out << "\n";
+  }
+}
+
+
+#endif
@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------
+// FILE: key_hash.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Hash function object used by the hash table collections. For
+//  string keys it hashes through std::string_view, so a lookup with a
+//  string_view, a C string, or a std::string all produce the same hash
+//  code without building a temporary std::string. Also holds the other
+//  hash policies HashTableCollection can be built with, and the index
+//  policies that turn a hash code into a bucket index.
+//----------------------------------------------------------------------
+
+#ifndef KEY_HASH_H
+#define KEY_HASH_H
+
+#include <cstring>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+// hashes a key the same way std::hash<K> does
+template<typename K>
+struct KeyHash
+{
+  size_t operator()(const K& key) const { return std::hash<K>()(key); }
+};
+
+
+// string keys can be hashed from anything that converts to a string_view
+template<>
+struct KeyHash<std::string>
+{
+  using is_transparent = void;
+
+  size_t operator()(std::string_view key) const
+  {
+    return std::hash<std::string_view>()(key);
+  }
+};
+
+
+// true when a hash table hashing with Hash can be searched for a K key
+// with a Q directly: Q is K, or Hash is transparent (declares
+// is_transparent, hashing string_views) and Q converts to a string_view
+template<typename Hash, typename K, typename Q, typename = void>
+struct HashedLookup : std::is_same<K, Q> {};
+
+template<typename Hash, typename K, typename Q>
+struct HashedLookup<Hash, K, Q, std::void_t<typename Hash::is_transparent>>
+  : std::integral_constant<bool, std::is_same<K, Q>::value ||
+                                 std::is_convertible<const Q&, std::string_view>::value> {};
+
+
+// wyhash constants
+const uint64_t WY_P0 = 0xa0761d6478bd642full;
+const uint64_t WY_P1 = 0xe7037ed1a0b428dbull;
+
+// multiply into 128 bits and fold the halves together, so every bit
+// of a and b affects every bit of the result
+inline uint64_t wymix(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+  // the same product built from 32 bit halves
+  uint64_t a_hi = a >> 32, a_lo = a & 0xffffffffull;
+  uint64_t b_hi = b >> 32, b_lo = b & 0xffffffffull;
+  uint64_t hh = a_hi * b_hi, hl = a_hi * b_lo, lh = a_lo * b_hi, ll = a_lo * b_lo;
+  uint64_t mid = (ll >> 32) + (hl & 0xffffffffull) + (lh & 0xffffffffull);
+  uint64_t lo = (mid << 32) | (ll & 0xffffffffull);
+  uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+  return lo ^ hi;
+#endif
+}
+
+
+// wyhash-style hash: the std::hash code (the key itself for integers)
+// run through one wymix
+template<typename K>
+struct WyHash
+{
+  size_t operator()(const K& key) const
+  {
+    return wymix(std::hash<K>()(key) ^ WY_P0, WY_P1);
+  }
+};
+
+
+// string keys are hashed 16 bytes per wymix
+template<>
+struct WyHash<std::string>
+{
+  using is_transparent = void;
+
+  size_t operator()(std::string_view key) const
+  {
+    const char* p = key.data();
+    size_t n = key.size();
+    uint64_t seed = WY_P0 ^ n;
+    for (; n > 16; n -= 16, p += 16) {
+      seed = wymix(read(p, 8) ^ WY_P1, read(p + 8, 8) ^ seed);
+    }
+    // the last 1 to 16 bytes (zero padded)
+    uint64_t a = read(p, n < 8 ? n : 8);
+    uint64_t b = n > 8 ? read(p + 8, n - 8) : 0;
+    return wymix(WY_P1 ^ key.size(), wymix(a ^ WY_P1, b ^ seed));
+  }
+
+private:
+  // n <= 8 bytes starting at p as an integer
+  static uint64_t read(const char* p, size_t n)
+  {
+    uint64_t v = 0;
+    std::memcpy(&v, p, n);
+    return v;
+  }
+};
+
+
+// Fibonacci (multiplicative) hashing: multiply by 2^64 / golden ratio,
+// which spreads consecutive integers across the whole code, then fold
+// the well mixed high half into the low half the index policies use
+template<typename K>
+struct FibonacciHash
+{
+  size_t operator()(const K& key) const
+  {
+    uint64_t h = static_cast<uint64_t>(std::hash<K>()(key)) * 11400714819323198485ull;
+    return h ^ (h >> 32);
+  }
+};
+
+
+// Index policies, mapping a hash code to a bucket in [0, capacity)
+
+// remainder of the code, using every bit (the slowest, a division)
+struct ModuloIndex
+{
+  size_t operator()(size_t code, size_t capacity) const { return code % capacity; }
+};
+
+// low bits of the code, for power of two capacities (one AND, but a
+// weak hash's unmixed low bits cluster)
+struct MaskIndex
+{
+  size_t operator()(size_t code, size_t capacity) const { return code & (capacity - 1); }
+};
+
+// high bits of the code scaled to the capacity (Lemire's "fastrange",
+// a multiply and a shift), so any capacity works without a division
+struct FastRangeIndex
+{
+  size_t operator()(size_t code, size_t capacity) const
+  {
+#ifdef __SIZEOF_INT128__
+    return static_cast<size_t>((static_cast<unsigned __int128>(code) * capacity) >> 64);
+#else
+    return static_cast<size_t>(((static_cast<uint64_t>(code) >> 32) * capacity) >> 32);
+#endif
+  }
+};
+
+
+#endif
@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------
+// FILE: node_pool.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Node allocators for the tree collections. HeapAllocator is the
+//  plain new/delete behavior. NodePool carves nodes out of large slabs,
+//  recycles removed nodes through a free list, and gives every slab
+//  back at once when the tree is emptied, so building a tree is not
+//  one malloc per node and neighboring nodes end up close in memory.
+//----------------------------------------------------------------------
+
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+// allocates each node individually with new and delete
+template<typename T>
+class HeapAllocator
+{
+public:
+  // nodes must be destroyed one at a time before release()
+  static const bool BULK_RELEASE = false;
+
+  // return a new default constructed node
+  T* allocate() { return new T; }
+
+  // destroy and free a node returned by allocate()
+  void deallocate(T* ptr) { delete ptr; }
+
+  // nothing is held back, so nothing to give up
+  void release() {}
+
+  // bytes currently held for nodes (live nodes only)
+  size_t bytes_reserved() const { return 0; }
+
+  // nothing to trade, every node came from the same heap
+  void swap(HeapAllocator<T>&) {}
+};
+
+
+// allocates nodes out of fixed size slabs with free-list recycling
+template<typename T>
+class NodePool
+{
+public:
+  // release() hands back every slab, even with live nodes in them
+  static const bool BULK_RELEASE = true;
+
+  // number of nodes carved out of each slab
+  static const size_t SLAB_SIZE = 512;
+
+  NodePool();
+  ~NodePool();
+
+  // return a new default constructed node
+  T* allocate();
+
+  // destroy a node and push its slot onto the free list
+  void deallocate(T* ptr);
+
+  // free every slab; nodes still in them are not destroyed
+  void release();
+
+  // bytes currently held in slabs
+  size_t bytes_reserved() const;
+
+  // trade slabs with another pool (used when a tree is moved)
+  void swap(NodePool<T>& rhs);
+
+private:
+  // a node's storage, reused as a free-list link once the node is gone
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+  // slabs form a singly linked list so they can all be freed together
+  struct Slab {
+    Slab* next;
+    Slot slots[SLAB_SIZE];
+  };
+
+  // most recently allocated slab
+  Slab* slabs;
+  // number of slots already handed out from the current slab
+  size_t slab_used;
+  // slots returned by deallocate
+  Slot* free_list;
+  // number of slabs allocated
+  size_t slab_count;
+
+  // a pool owns its slabs, so it cannot be copied
+  NodePool(const NodePool<T>& rhs);
+  NodePool& operator=(const NodePool<T>& rhs);
+};
+
+
+template<typename T>
+NodePool<T>::NodePool()
+  : slabs(nullptr), slab_used(SLAB_SIZE), free_list(nullptr), slab_count(0)
+{
+}
+
+template<typename T>
+NodePool<T>::~NodePool()
+{
+  release();
+}
+
+template<typename T>
+T* NodePool<T>::allocate()
+{
+  Slot* slot = nullptr;
+  if (free_list != nullptr) {
+    // Reuse the most recently freed node
+    slot = free_list;
+    free_list = free_list->next;
+  }
+  else {
+    if (slab_used == SLAB_SIZE) {
+      // Current slab is used up, so start a new one
+      Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab)));
+      slab->next = slabs;
+      slabs = slab;
+      slab_used = 0;
+      ++slab_count;
+    }
+    slot = &slabs->slots[slab_used];
+    ++slab_used;
+  }
+  return new (&slot->storage) T();
+}
+
+template<typename T>
+void NodePool<T>::deallocate(T* ptr)
+{
+  ptr->~T();
+  Slot* slot = reinterpret_cast<Slot*>(ptr);
+  slot->next = free_list;
+  free_list = slot;
+}
+
+template<typename T>
+void NodePool<T>::release()
+{
+  while (slabs != nullptr) {
+    Slab* next = slabs->next;
+    ::operator delete(slabs);
+    slabs = next;
+  }
+  slab_used = SLAB_SIZE;
+  free_list = nullptr;
+  slab_count = 0;
+}
+
+template<typename T>
+void NodePool<T>::swap(NodePool<T>& rhs)
+{
+  std::swap(slabs, rhs.slabs);
+  std::swap(slab_used, rhs.slab_used);
+  std::swap(free_list, rhs.free_list);
+  std::swap(slab_count, rhs.slab_count);
+}
+
+template<typename T>
+size_t NodePool<T>::bytes_reserved() const
+{
+  return slab_count * sizeof(Slab);
+}
+
+
+#endif
@@ -0,0 +1,166 @@
+//----------------------------------------------------------------------
+// FILE: perf_counters.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Hardware performance counters (through Linux perf_event_open)
+//  for the performance tests. Wall time says how long an operation
+//  took, while the counters say where the cycles went: instructions
+//  per cycle, L1 data and last level cache misses, branch
+//  mispredictions, and data TLB misses. Counters are opened one by one,
+//  so any the kernel or hardware does not allow (or every counter, off
+//  Linux or inside most virtual machines) just reads as NaN.
+//----------------------------------------------------------------------
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// the counted events
+enum HardwareEvent {
+  HW_CYCLES, HW_INSTRUCTIONS, HW_L1D_MISSES, HW_LLC_MISSES,
+  HW_BRANCH_MISSES, HW_DTLB_MISSES, HW_EVENT_COUNT
+};
+
+
+// Counts the events of the calling thread (in user space only) between
+// start and stop
+class HardwareCounters
+{
+public:
+  // opens every counter it can
+  HardwareCounters();
+  ~HardwareCounters();
+
+  bool available(HardwareEvent e) const { return fds[e] >= 0; }
+  bool any_available() const;
+  // why the first counter that could not be opened failed (empty when
+  // all of them opened)
+  const std::string& error() const { return open_error; }
+
+  // reset and start counting
+  void start();
+  // stop counting and read the counts
+  void stop();
+
+  // count from the last start to stop (scaled up if the kernel had to
+  // share the hardware counter with other events), NaN if unavailable
+  double value(HardwareEvent e) const { return values[e]; }
+  // instructions per cycle over the last start to stop
+  double ipc() const { return values[HW_INSTRUCTIONS] / values[HW_CYCLES]; }
+
+private:
+  int fds[HW_EVENT_COUNT];
+  double values[HW_EVENT_COUNT];
+  std::string open_error;
+
+  HardwareCounters(const HardwareCounters&);
+  HardwareCounters& operator=(const HardwareCounters&);
+};
+
+
+inline HardwareCounters::HardwareCounters()
+{
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    fds[e] = -1;
+    values[e] = NAN;
+  }
+#ifdef __linux__
+  // cache events are (cache, operation, result) triples
+  const uint64_t READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  const uint32_t types[HW_EVENT_COUNT] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+  };
+  const uint64_t configs[HW_EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | READ_MISS, PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_DTLB | READ_MISS
+  };
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = types[e];
+    attr.config = configs[e];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread, on any CPU, in no group
+    fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    if (fds[e] < 0 && open_error.empty()) {
+      open_error = std::string("perf_event_open: ") + strerror(errno);
+    }
+  }
+#else
+  open_error = "hardware counters need Linux perf_event_open";
+#endif
+}
+
+inline HardwareCounters::~HardwareCounters()
+{
+#ifdef __linux__
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    if (fds[e] >= 0) {
+      close(fds[e]);
+    }
+  }
+#endif
+}
+
+inline bool HardwareCounters::any_available() const
+{
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    if (fds[e] >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void HardwareCounters::start()
+{
+#ifdef __linux__
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    if (fds[e] >= 0) {
+      ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+inline void HardwareCounters::stop()
+{
+#ifdef __linux__
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    if (fds[e] >= 0) {
+      ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+  for (int e = 0; e < HW_EVENT_COUNT; ++e) {
+    values[e] = NAN;
+    // the count, then the time enabled and the time actually counting
+    uint64_t data[3];
+    if (fds[e] >= 0 && read(fds[e], data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+      values[e] = static_cast<double>(data[0]) * data[1] / data[2];
+    }
+  }
+#endif
+}
+
+
+#endif
@@ -0,0 +1,499 @@
+//----------------------------------------------------------------------
+// FILE: persistent_avl_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: An AVL tree whose nodes are never changed once built. An add or
+//  remove copies only the nodes on the path from the root to the key
+//  (rebalancing the copies on the way back up) and the new path points
+//  at the untouched subtrees of the old tree. Nodes are reference
+//  counted, so any number of trees can share them, and a snapshot is
+//  just another reference to the current root.
+//----------------------------------------------------------------------
+
+#ifndef PERSISTENT_AVL_COLLECTION_H
+#define PERSISTENT_AVL_COLLECTION_H
+
+#include <atomic>
+#include <utility>
+#include "array_list.h"
+#include "collection.h"
+#include "tree_cursor.h"
+
+
+template<typename K, typename V>
+class PersistentAVLCollection final : public Collection<K,V>
+{
+public:
+  PersistentAVLCollection();
+  // copies share every node with rhs, so they take O(1) time
+  PersistentAVLCollection(const PersistentAVLCollection<K,V>& rhs);
+  PersistentAVLCollection(PersistentAVLCollection<K,V>&& rhs);
+  ~PersistentAVLCollection();
+  PersistentAVLCollection& operator=(const PersistentAVLCollection<K,V>& rhs);
+  PersistentAVLCollection& operator=(PersistentAVLCollection<K,V>&& rhs);
+
+  void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
+  void remove(const K& a_key);
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  void keys(ArrayList<K>& all_keys) const;
+  void sort(ArrayList<K>& all_keys_sorted) const;
+  size_t size() const;
+  size_t height() const;
+  // in-order iteration (see Collection); an iterator holds on to the
+  // version of the tree it started in, so it stays valid (and keeps
+  // seeing that version) across later adds and removes
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+  // an O(1) point-in-time copy that later adds and removes (on either
+  // tree) do not affect; the snapshot may be read and dropped on
+  // another thread while this tree keeps changing
+  PersistentAVLCollection<K,V> snapshot() const;
+
+  // for testing: check the ordering, height and balance of every node
+  bool valid_avl() const;
+
+private:
+  // tree node, shared by every tree whose root reaches it
+  struct Node {
+    K key;
+    V value;
+    int height;
+    Node* left;
+    Node* right;
+    // number of parents (and roots) pointing at the node
+    std::atomic<size_t> refs;
+  };
+  // root node of the tree
+  Node* root;
+  // number of k-v pairs stored in the collection
+  size_t node_count;
+
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+  // new node holding the pair, taking over a reference to each child
+  template<typename KK, typename VV>
+  static Node* make(KK&& a_key, VV&& a_val, Node* left, Node* right);
+  // add another reference to a node (returns it for convenience)
+  static Node* retain(Node* subtree_root);
+  // drop a reference, freeing the node (and dropping its references)
+  // once nothing points at it
+  static void release(Node* subtree_root);
+  // build a balanced node from the pair and two owned subtrees whose
+  // heights differ by at most two
+  static Node* balance(const K& a_key, const V& a_val, Node* left, Node* right);
+  static int height(const Node* subtree_root);
+  // path copying helpers, each returns a new owned subtree root
+  template<typename KK, typename VV>
+  static Node* add(const Node* subtree_root, KK&& a_key, VV&& a_val, bool& added);
+  static Node* remove(const Node* subtree_root, const K& a_key);
+  static Node* remove_min(const Node* subtree_root);
+  // helper to recursively build up key list
+  void find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const;
+  // helper to recursively build sorted list of keys
+  void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
+  // validate helper, returns false if any node is out of place
+  bool valid_avl(const Node* subtree_root) const;
+
+  // in-order cursor holding a reference to the root it walks
+  class Cursor : public TreeCursor<K,V,Node> {
+  public:
+    explicit Cursor(Node* a_root)
+      : TreeCursor<K,V,Node>(a_root), pinned_root(retain(a_root)) {}
+    Cursor(Node* a_root, const K& bound, bool strict)
+      : TreeCursor<K,V,Node>(a_root, bound, strict), pinned_root(retain(a_root)) {}
+    Cursor(const Cursor& rhs)
+      : TreeCursor<K,V,Node>(rhs), pinned_root(retain(rhs.pinned_root)) {}
+    ~Cursor() { release(pinned_root); }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    Node* pinned_root;
+    Cursor& operator=(const Cursor& rhs);
+  };
+};
+
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>::PersistentAVLCollection()
+  : root(nullptr), node_count(0)
+{
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>::PersistentAVLCollection(const PersistentAVLCollection<K,V>& rhs)
+  : root(retain(rhs.root)), node_count(rhs.node_count)
+{
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>::PersistentAVLCollection(PersistentAVLCollection<K,V>&& rhs)
+  : root(nullptr), node_count(0)
+{
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>::~PersistentAVLCollection()
+{
+  release(root);
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>& PersistentAVLCollection<K,V>::operator=(const PersistentAVLCollection<K,V>& rhs)
+{
+  // Take the new reference first, so self assignment is harmless
+  Node* old_root = root;
+  root = retain(rhs.root);
+  node_count = rhs.node_count;
+  release(old_root);
+  return *this;
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V>& PersistentAVLCollection<K,V>::operator=(PersistentAVLCollection<K,V>&& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case
+    std::swap(root, rhs.root);
+    std::swap(node_count, rhs.node_count);
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K, typename V>
+template<typename KK, typename VV>
+void PersistentAVLCollection<K,V>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  bool added = false;
+  Node* new_root = add(root, std::forward<KK>(a_key), std::forward<VV>(a_val), added);
+  // Old path nodes only go away if no snapshot still holds them
+  release(root);
+  root = new_root;
+  if (added) {
+    ++node_count;
+  }
+}
+
+template<typename K, typename V>
+template<typename KK, typename VV>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::add(const Node* subtree_root, KK&& a_key, VV&& a_val, bool& added)
+{
+  if (subtree_root == nullptr) {
+    added = true;
+    return make(std::forward<KK>(a_key), std::forward<VV>(a_val), nullptr, nullptr);
+  }
+  if (a_key < subtree_root->key) {
+    Node* left = add(subtree_root->left, std::forward<KK>(a_key), std::forward<VV>(a_val), added);
+    return balance(subtree_root->key, subtree_root->value, left, retain(subtree_root->right));
+  }
+  if (subtree_root->key < a_key) {
+    Node* right = add(subtree_root->right, std::forward<KK>(a_key), std::forward<VV>(a_val), added);
+    return balance(subtree_root->key, subtree_root->value, retain(subtree_root->left), right);
+  }
+  // Key already present, so only the value changes
+  return make(subtree_root->key, std::forward<VV>(a_val),
+              retain(subtree_root->left), retain(subtree_root->right));
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  V val;
+  if (!find(a_key, val)) {
+    // Nothing to remove, so keep sharing the current tree
+    return;
+  }
+  Node* new_root = remove(root, a_key);
+  release(root);
+  root = new_root;
+  --node_count;
+}
+
+template<typename K, typename V>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::remove(const Node* subtree_root, const K& a_key)
+{
+  if (a_key < subtree_root->key) {
+    Node* left = remove(subtree_root->left, a_key);
+    return balance(subtree_root->key, subtree_root->value, left, retain(subtree_root->right));
+  }
+  if (subtree_root->key < a_key) {
+    Node* right = remove(subtree_root->right, a_key);
+    return balance(subtree_root->key, subtree_root->value, retain(subtree_root->left), right);
+  }
+  // Found it: with at most one child the child takes its place
+  if (subtree_root->left == nullptr) {
+    return retain(subtree_root->right);
+  }
+  if (subtree_root->right == nullptr) {
+    return retain(subtree_root->left);
+  }
+  // Two children, so the inorder successor takes its place
+  const Node* successor = subtree_root->right;
+  while (successor->left != nullptr) {
+    successor = successor->left;
+  }
+  return balance(successor->key, successor->value, retain(subtree_root->left),
+                 remove_min(subtree_root->right));
+}
+
+template<typename K, typename V>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::remove_min(const Node* subtree_root)
+{
+  if (subtree_root->left == nullptr) {
+    return retain(subtree_root->right);
+  }
+  Node* left = remove_min(subtree_root->left);
+  return balance(subtree_root->key, subtree_root->value, left, retain(subtree_root->right));
+}
+
+template<typename K, typename V>
+template<typename KK, typename VV>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::make(KK&& a_key, VV&& a_val, Node* left, Node* right)
+{
+  int left_height = height(left);
+  int right_height = height(right);
+  return new Node{std::forward<KK>(a_key), std::forward<VV>(a_val),
+                  1 + (left_height > right_height ? left_height : right_height),
+                  left, right, {1}};
+}
+
+template<typename K, typename V>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::retain(Node* subtree_root)
+{
+  if (subtree_root != nullptr) {
+    subtree_root->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  return subtree_root;
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::release(Node* subtree_root)
+{
+  // The last tree to let go frees the node; acq_rel makes every other
+  // tree's use of it happen before the delete
+  if (subtree_root != nullptr &&
+      subtree_root->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    release(subtree_root->left);
+    release(subtree_root->right);
+    delete subtree_root;
+  }
+}
+
+template<typename K, typename V>
+typename PersistentAVLCollection<K,V>::Node*
+PersistentAVLCollection<K,V>::balance(const K& a_key, const V& a_val, Node* left, Node* right)
+{
+  int left_height = height(left);
+  int right_height = height(right);
+  Node* result = nullptr;
+  if (left_height > right_height + 1) {
+    // Left heavy: rotate right (after rotating left at the left child
+    // when its right side is the taller one)
+    if (height(left->left) >= height(left->right)) {
+      result = make(left->key, left->value, retain(left->left),
+                    make(a_key, a_val, retain(left->right), right));
+    }
+    else {
+      const Node* lr = left->right;
+      result = make(lr->key, lr->value,
+                    make(left->key, left->value, retain(left->left), retain(lr->left)),
+                    make(a_key, a_val, retain(lr->right), right));
+    }
+    release(left);
+  }
+  else if (right_height > left_height + 1) {
+    // Right heavy: the mirror image
+    if (height(right->right) >= height(right->left)) {
+      result = make(right->key, right->value,
+                    make(a_key, a_val, left, retain(right->left)), retain(right->right));
+    }
+    else {
+      const Node* rl = right->left;
+      result = make(rl->key, rl->value,
+                    make(a_key, a_val, left, retain(rl->left)),
+                    make(right->key, right->value, retain(rl->right), retain(right->right)));
+    }
+    release(right);
+  }
+  else {
+    result = make(a_key, a_val, left, right);
+  }
+  return result;
+}
+
+template<typename K, typename V>
+int PersistentAVLCollection<K,V>::height(const Node* subtree_root)
+{
+  return subtree_root == nullptr ? 0 : subtree_root->height;
+}
+
+template<typename K, typename V>
+bool PersistentAVLCollection<K,V>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V>
+template<typename Q, typename>
+bool PersistentAVLCollection<K,V>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  const Node* ptr = root;
+  while (ptr != nullptr) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
+    if (search_key < ptr->key) {
+      ptr = ptr->left;
+    }
+    else if (ptr->key < search_key) {
+      ptr = ptr->right;
+    }
+    else {
+      the_val = ptr->value;
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  find(root, k1, k2, keys);
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2,
+                                        ArrayList<K>& keys) const
+{
+  if (subtree_root == nullptr) {
+    return;
+  }
+  if (k1 < subtree_root->key) {
+    find(subtree_root->left, k1, k2, keys);
+  }
+  if (subtree_root->key >= k1 && subtree_root->key <= k2) {
+    keys.add(subtree_root->key);
+  }
+  if (subtree_root->key < k2) {
+    find(subtree_root->right, k1, k2, keys);
+  }
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::keys(ArrayList<K>& all_keys) const
+{
+  keys(root, all_keys);
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+{
+  if (subtree_root == nullptr) {
+    return;
+  }
+  keys(subtree_root->left, all_keys);
+  all_keys.add(subtree_root->key);
+  keys(subtree_root->right, all_keys);
+}
+
+template<typename K, typename V>
+void PersistentAVLCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  // An in-order walk is already sorted
+  keys(all_keys_sorted);
+}
+
+template<typename K, typename V>
+size_t PersistentAVLCollection<K,V>::size() const
+{
+  return node_count;
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> PersistentAVLCollection<K,V>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(root));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> PersistentAVLCollection<K,V>::lower_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new Cursor(root, k, false));
+}
+
+template<typename K, typename V>
+CollectionIterator<K,V> PersistentAVLCollection<K,V>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new Cursor(root, k, true));
+}
+
+template<typename K, typename V>
+size_t PersistentAVLCollection<K,V>::height() const
+{
+  return height(root);
+}
+
+template<typename K, typename V>
+PersistentAVLCollection<K,V> PersistentAVLCollection<K,V>::snapshot() const
+{
+  return *this;
+}
+
+template<typename K, typename V>
+bool PersistentAVLCollection<K,V>::valid_avl() const
+{
+  return valid_avl(root);
+}
+
+template<typename K, typename V>
+bool PersistentAVLCollection<K,V>::valid_avl(const Node* subtree_root) const
+{
+  if (subtree_root == nullptr) {
+    return true;
+  }
+  const Node* l = subtree_root->left;
+  const Node* r = subtree_root->right;
+  int left_height = height(l);
+  int right_height = height(r);
+  if (subtree_root->height != 1 + (left_height > right_height ? left_height : right_height)) {
+    return false;
+  }
+  if (left_height - right_height > 1 || right_height - left_height > 1) {
+    return false;
+  }
+  if ((l != nullptr && !(l->key < subtree_root->key)) ||
+      (r != nullptr && !(subtree_root->key < r->key))) {
+    return false;
+  }
+  return valid_avl(l) && valid_avl(r);
+}
+
+
+#endif
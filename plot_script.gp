@@ -33,9 +33,9 @@ set output outfile
 # Set the title and each axis label
 set title "Collection Implementation " . testname . " Performance"
 set xlabel "Input Size (n)"
-set ylabel "Time (milliseconds)"
+set ylabel "Time (microseconds)"
 
-set yrange [0:0.05<*]
+set yrange [0:50<*]
 # set xtics 40000
 
 # Move the key to the left of the graph
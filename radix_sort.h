@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------
+// FILE: radix_sort.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Radix sorts for lists of keys that can be split into bytes.
+//  Strings use a most significant digit (MSD) radix sort, one byte
+//  position per pass, and integers use a least significant digit (LSD)
+//  radix sort, one byte per pass. sort_keys() picks the radix sort when
+//  the key type allows it and the list's comparison sort otherwise.
+//----------------------------------------------------------------------
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "array_list.h"
+
+
+// true for key types radix_sort can handle (integers, but not bool)
+template<typename T>
+struct RadixSortable
+  : std::integral_constant<bool, std::is_integral<T>::value &&
+                                 !std::is_same<T, bool>::value> {};
+
+template<>
+struct RadixSortable<std::string> : std::true_type {};
+
+
+// string buckets this small are finished with insertion sort
+const size_t RADIX_INSERTION_CUTOFF = 32;
+
+
+// byte of key at position depth, shifted up one so that 0 means the
+// key has already ended (shorter keys sort first)
+inline size_t radix_byte(const std::string& key, size_t depth)
+{
+  return depth < key.size() ? static_cast<unsigned char>(key[depth]) + 1 : 0;
+}
+
+
+// a run of keys, items[start, start + n), whose first depth bytes all
+// match (ordered by start only so it can be kept in an ArrayList)
+struct RadixRange
+{
+  size_t start;
+  size_t n;
+  size_t depth;
+  bool operator<(const RadixRange& rhs) const { return start < rhs.start; }
+};
+
+
+// sort items[0, n) whose first depth bytes all match, using buffer
+// (n slots) as scratch space for the distribution. The runs still to
+// sort are kept on an explicit work list rather than by recursing, so
+// keys with long shared prefixes can't run out of stack.
+inline void msd_radix_sort(std::string* items, std::string* buffer, size_t n,
+                           size_t depth)
+{
+  ArrayList<RadixRange> work;
+  work.add(RadixRange{0, n, depth});
+  while (work.size() > 0) {
+    RadixRange range = work[work.size() - 1];
+    work.remove(work.size() - 1);
+    std::string* keys = items + range.start;
+    std::string* scratch = buffer + range.start;
+    if (range.n <= RADIX_INSERTION_CUTOFF) {
+      for (size_t j = 1; j < range.n; ++j) {
+        // compare only the bytes after the shared prefix
+        size_t i = j;
+        while (i > 0 && keys[i].compare(range.depth, std::string::npos,
+                                        keys[i - 1], range.depth, std::string::npos) < 0) {
+          std::swap(keys[i], keys[i - 1]);
+          --i;
+        }
+      }
+      continue;
+    }
+    // count[b + 1] is the number of keys with byte b, then prefix summed
+    // into the start of each bucket
+    size_t count[258] = {0};
+    for (size_t i = 0; i < range.n; ++i) {
+      ++count[radix_byte(keys[i], range.depth) + 1];
+    }
+    for (size_t b = 1; b < 258; ++b) {
+      count[b] += count[b - 1];
+    }
+    for (size_t i = 0; i < range.n; ++i) {
+      scratch[count[radix_byte(keys[i], range.depth)]++] = std::move(keys[i]);
+    }
+    for (size_t i = 0; i < range.n; ++i) {
+      keys[i] = std::move(scratch[i]);
+    }
+    // count[b] is now the end of bucket b; bucket 0 holds keys that have
+    // ended, which are all equal, so only the others need sorting
+    for (size_t b = 1; b < 257; ++b) {
+      size_t start = count[b - 1];
+      if (count[b] - start > 1) {
+        work.add(RadixRange{range.start + start, count[b] - start, range.depth + 1});
+      }
+    }
+  }
+}
+
+
+// sort items[0, n) of an integral type, using buffer (n slots) as
+// scratch space; returns the array holding the sorted keys
+template<typename T>
+T* lsd_radix_sort(T* items, T* buffer, size_t n)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  // flipping the sign bit makes signed keys order like unsigned ones
+  const U flip = std::is_signed<T>::value ? U(1) << (sizeof(T) * 8 - 1) : 0;
+  for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+    size_t count[257] = {0};
+    for (size_t i = 0; i < n; ++i) {
+      ++count[((U(items[i]) ^ flip) >> shift & 0xFF) + 1];
+    }
+    if (count[((U(items[0]) ^ flip) >> shift & 0xFF) + 1] == n) {
+      // every key has the same byte here, so the pass would do nothing
+      continue;
+    }
+    for (size_t b = 1; b < 257; ++b) {
+      count[b] += count[b - 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+      buffer[count[(U(items[i]) ^ flip) >> shift & 0xFF]++] = items[i];
+    }
+    std::swap(items, buffer);
+  }
+  return items;
+}
+
+
+// sort a list of strings in place
+inline void radix_sort(ArrayList<std::string>& list)
+{
+  size_t n = list.size();
+  if (n <= 1) {
+    return;
+  }
+  // the list's items are contiguous, so they are sorted where they are
+  std::string* buffer = new std::string[n];
+  msd_radix_sort(&list[0], buffer, n, 0);
+  delete [] buffer;
+}
+
+
+// sort a list of integers in place
+template<typename T>
+typename std::enable_if<RadixSortable<T>::value>::type
+radix_sort(ArrayList<T>& list)
+{
+  size_t n = list.size();
+  if (n <= 1) {
+    return;
+  }
+  T* buffer = new T[n];
+  T* sorted = lsd_radix_sort(&list[0], buffer, n);
+  if (sorted == buffer) {
+    // an odd number of passes left the keys in the scratch array
+    for (size_t i = 0; i < n; ++i) {
+      list[i] = buffer[i];
+    }
+  }
+  delete [] buffer;
+}
+
+
+// sort a list of keys, by radix sort when the key type allows it
+template<typename T>
+void sort_keys(ArrayList<T>& list)
+{
+  if constexpr (RadixSortable<T>::value) {
+    radix_sort(list);
+  }
+  else {
+    list.sort();
+  }
+}
+
+
+#endif
@@ -12,22 +12,35 @@
 
 #include "string.h"
 #include "collection.h"
+#include "node_pool.h"
+#include "bulk_load.h"
+#include "tree_cursor.h"
+#include "batch.h"
 #include "array_list.h"
 
 
-template<typename K, typename V>
-class RBTCollection : public Collection<K,V>
+template<typename K, typename V, template<typename> class Alloc = HeapAllocator>
+class RBTCollection final : public Collection<K,V>
 {
 public:
 
   // create an empty collection
   RBTCollection();
+
+  // create a collection holding the given pairs (see bulk_load)
+  explicit RBTCollection(const ArrayList<std::pair<K,V>>& kv_pairs);
   
   // copy constructor
-  RBTCollection(const RBTCollection<K,V>& rhs);
+  RBTCollection(const RBTCollection<K,V,Alloc>& rhs);
+
+  // move constructor (takes rhs's nodes, leaving it empty)
+  RBTCollection(RBTCollection<K,V,Alloc>&& rhs);
 
   // assignment operator
-  RBTCollection<K,V>& operator=(const RBTCollection<K,V>& rhs);
+  RBTCollection<K,V,Alloc>& operator=(const RBTCollection<K,V,Alloc>& rhs);
+
+  // move assignment operator
+  RBTCollection<K,V,Alloc>& operator=(RBTCollection<K,V,Alloc>&& rhs);
 
   // delete collection
   ~RBTCollection();
@@ -35,15 +48,35 @@ public:
   // add a new key-value pair into the collection 
   void add(const K& a_key, const V& a_val);
 
+  // add a new key-value pair, moving the key and value into the node
+  void add(K&& a_key, V&& a_val);
+
   // remove a key-value pair from the collectiona
   void remove(const K& a_key);
 
   // find and return the value associated with the key
   bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<OrderedLookup<K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
 
   // find and return each key >= k1 and <= k2 
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // call visit(key, value) for each pair with k1 <= key <= k2, in key
+  // order and without buffering; stops early once visit returns false
+  template<typename F>
+  void scan(const K& k1, const K& k2, F&& visit) const;
   
+  // batch operations over keys[0..n), without a virtual call per key.
+  // find_batch stores each key's value in vals[i] and whether it was
+  // found in found[i], returning the number found; its searches go down
+  // the tree together so their cache misses overlap (see batch.h)
+  void add_batch(const K* keys, const V* vals, size_t n);
+  size_t find_batch(const K* keys, size_t n, V* vals, bool* found) const;
+  void remove_batch(const K* keys, size_t n);
+
   // return all of the keys in the collection 
   void keys(ArrayList<K>& all_keys) const;
 
@@ -53,9 +86,29 @@ public:
   // return the number of key-value pairs in the collection
   size_t size() const;
 
+  // in-order iteration over the pairs (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
   // return the height of the tree
   size_t height() const;
 
+  // order statistics, each O(log n) using the subtree sizes:
+
+  // return the number of keys less than a_key
+  size_t rank(const K& a_key) const;
+
+  // find the i-th smallest key (counting from 0), false if i >= size()
+  bool select(size_t i, K& the_key) const;
+
+  // return the number of keys >= k1 and <= k2
+  size_t count(const K& k1, const K& k2) const;
+
+  // replace the contents with a balanced tree built from the pairs
+  // (linear time when the pairs are already sorted by key)
+  void bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs);
+
   // for testing:
 
   // check if tree satisfies the red-black tree constraints
@@ -76,6 +129,8 @@ private:
     Node* right;
     Node* parent;
     color_t color;
+    // number of nodes in the subtree rooted here
+    size_t subtree_size;
   };
 
   // root node
@@ -84,9 +139,19 @@ private:
   // number of k-v pairs stored in the collection
   size_t node_count;
 
+  // node allocator (HeapAllocator or NodePool)
+  Alloc<Node> node_alloc;
+
   // helper to empty entire hash table
   void make_empty(Node* subtree_root);
 
+  // remove every node, handing their memory back to the allocator
+  void clear();
+
+  // add helper that copies or moves the key and value into a node
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+
   // copy helper
   void copy(Node* lhs_subtree_root, const Node* rhs_subtree_root); 
     
@@ -94,6 +159,10 @@ private:
   void find(const Node* subtree_root, const K& k1, const K& k2,
             ArrayList<K>& keys) const;
 
+  // scan helper, returns false once visit has asked to stop
+  template<typename F>
+  bool scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const;
+
   // helper to build sorted list of keys (used by keys and sort)
   void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
 
@@ -109,8 +178,22 @@ private:
   // restore red-black constraints in remove
   void remove_rebalance(Node* x, bool going_right);
   
+  // bulk load helper, builds a balanced subtree from items[start, end)
+  // with the nodes at red_depth colored red
+  Node* build(const std::pair<K,V>* items, size_t start, size_t end,
+              size_t depth, size_t red_depth, Node* parent);
+
   // height helper
   size_t height(Node* subtree_root) const;
+
+  // number of nodes below (and including) subtree_root
+  static size_t subtree_size(const Node* subtree_root);
+
+  // recompute a node's size from its children
+  void update_size(Node* subtree_root);
+
+  // number of keys less than (or equal to, if inclusive) a_key
+  size_t rank(const K& a_key, bool inclusive) const;
   
   // ------------
   // for testing:
@@ -128,39 +211,53 @@ private:
 
 
 // TODO: Finish the above functions below
-template<typename K, typename V> 
-RBTCollection<K,V>::RBTCollection()
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>::RBTCollection()
   : root(nullptr), node_count(0)
 {
 
 }
 
-template<typename K, typename V> 
-RBTCollection<K,V>::RBTCollection(const RBTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>::RBTCollection(const ArrayList<std::pair<K,V>>& kv_pairs)
+  : root(nullptr), node_count(0)
+{
+  bulk_load(kv_pairs);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>::RBTCollection(const RBTCollection<K,V,Alloc>& rhs)
   : root(nullptr), node_count(0)
 {
   *this = rhs;
 }
 
-template<typename K, typename V>
-RBTCollection<K,V>& RBTCollection<K,V>::operator=(const RBTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>::RBTCollection(RBTCollection<K,V,Alloc>&& rhs)
+  : root(nullptr), node_count(0)
+{
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>& RBTCollection<K,V,Alloc>::operator=(const RBTCollection<K,V,Alloc>& rhs)
 {
   if (this != &rhs) { // protects against the self assignment case 
     node_count = 0;
 	if (root != nullptr) {
-	  make_empty(root);
-	  root = nullptr;
+	  clear();
 	}
 	// Assignment made to make the binary trees identical, with unique memory addresses
 	node_count = rhs.node_count;
 	
 	if (rhs.root != nullptr) {
 	  // Create the root node for the copy assignment
-	  root = new Node;
+	  root = node_alloc.allocate();
 	  root->key = rhs.root->key;
 	  root->value = rhs.root->value;
 	  root->color = rhs.root->color;
-	  root->parent = rhs.root->parent;
+	  root->subtree_size = rhs.root->subtree_size;
+	  root->parent = nullptr;
 	  root->left = nullptr;
 	  root->right = nullptr; 
 	  copy(root,rhs.root); 
@@ -170,25 +267,52 @@ RBTCollection<K,V>& RBTCollection<K,V>::operator=(const RBTCollection<K,V>& rhs)
 }
 
 
-template<typename K, typename V> 
-RBTCollection<K,V>::~RBTCollection()
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>::~RBTCollection()
+{
+  clear();
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+RBTCollection<K,V,Alloc>& RBTCollection<K,V,Alloc>::operator=(RBTCollection<K,V,Alloc>&& rhs)
+{
+  if (this != &rhs) { // protects against the self assignment case 
+    // Empty this tree, then trade nodes (and their allocator) with rhs
+    clear();
+    std::swap(root, rhs.root);
+    std::swap(node_count, rhs.node_count);
+    node_alloc.swap(rhs.node_alloc);
+  }
+  return *this;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::add(K&& a_key, V&& a_val)
 {
-  make_empty(root);
-  root = nullptr; 
+  add_impl(std::move(a_key), std::move(a_val));
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::add(const K& a_key, const V& a_val)
+template<typename K, typename V, template<typename> class Alloc>
+template<typename KK, typename VV>
+void RBTCollection<K,V,Alloc>::add_impl(KK&& a_key, VV&& a_val)
 {
+  COLLECTION_TIME(OP_ADD);
   
   // SPECIAL CASE: First node being added
-  Node * newNode = new Node;
-  newNode->key = a_key;
-  newNode->value = a_val;
+  Node * newNode = node_alloc.allocate();
+  newNode->key = std::forward<KK>(a_key);
+  newNode->value = std::forward<VV>(a_val);
   newNode->color = RED;
   newNode->right = nullptr;
   newNode->left = nullptr;
   newNode->parent = nullptr;
+  newNode->subtree_size = 1;
   ++node_count;
 
   Node * x = root;
@@ -197,7 +321,7 @@ void RBTCollection<K,V>::add(const K& a_key, const V& a_val)
     //  Traverse down a path to get to add node to a leaf nodes child
 	add_rebalance(x);
 	p = x;
-	if (a_key < x->key) {
+	if (newNode->key < x->key) {
 	  // The added key is smaller than the current key so traverse to the left
       x = x->left;
 	}
@@ -210,7 +334,7 @@ void RBTCollection<K,V>::add(const K& a_key, const V& a_val)
     // Root addition case
 	root = newNode;
   }
-  else if (a_key < p->key) {
+  else if (newNode->key < p->key) {
     // Key value is less than the parent so add to left subtree
 	p->left = newNode;
 	newNode->parent = p; 
@@ -220,17 +344,22 @@ void RBTCollection<K,V>::add(const K& a_key, const V& a_val)
 	p->right = newNode;
 	newNode->parent = p; 
   }
+  // Every node on the path now has one more node below it
+  for (Node * a = p; a != nullptr; a = a->parent) {
+    ++a->subtree_size;
+  }
   add_rebalance(newNode);
   root->color = BLACK;
   
 }
-template<typename K, typename V> 
-void RBTCollection<K,V>::remove(const K& a_key)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::remove(const K& a_key)
 {
+  COLLECTION_TIME(OP_REMOVE);
   // Book varible to check if the key is found
   bool found = false;
   // Create the sentinel as the fake root
-  Node * sentinel = new Node;
+  Node * sentinel = node_alloc.allocate();
   sentinel->right = root;
   sentinel->left = nullptr;
   sentinel->color = RED;
@@ -262,36 +391,38 @@ void RBTCollection<K,V>::remove(const K& a_key)
   // Either not found or sitting at the node to delete
   if (found == false) {
     // The item was not found so return
+	node_alloc.deallocate(sentinel);
 	return;
   }
   if (x->left == nullptr || x->right == nullptr) {
     // Current element has either 1 or no children
+	Node * child = x->left ? x->left : x->right;
+	if (child != nullptr) {
+	  // The child takes x's place (as a black node, keeping the black
+	  // height the same on its paths)
+	  child->parent = x->parent;
+	  child->color = BLACK;
+	}
 	if (x == root) {
-	  // Special case of adjusting a new root
-	  if (x->left) {
-	    // If the left exists, it becomes the new root
-		sentinel->right = x->left; 
-	  }
-	  else if (x->right) {
-	    // If the right exists then it will be the new root
-		sentinel->right = x->right;
-	  }
-	  else {
-	    // Removing final element in list
-		sentinel->right = nullptr;
-	  }
+	  // Special case of adjusting a new root, which is the child if
+	  // there is one, and empty when removing the final element
+	  sentinel->right = child;
 	}
 	else if (x->key < p->key) {
       // The current key is less than its parent so it must be on the left
 	  sentinel->right = root; 
-	  p->left = nullptr;
+	  p->left = child;
 	}
 	else {
 	  // The current key is greater than its parent so on the right
 	  sentinel->right = root;
-	  p->right = nullptr;
+	  p->right = child;
 	}
-	delete x;
+	// Every node above x now has one less node below it
+	for (Node * a = x->parent; a != nullptr; a = a->parent) {
+	  --a->subtree_size;
+	}
+	node_alloc.deallocate(x);
 	x = nullptr;
   }
   else {
@@ -308,17 +439,27 @@ void RBTCollection<K,V>::remove(const K& a_key)
 	sentinel->right = root;
 	// Copy s key_value into x
 	x->key = s->key;
-	x->value = x->value; 
+	x->value = s->value; 
+	// The successor has no left child, so its right child (if any)
+	// takes its place
+	if (s->right != nullptr) {
+	  s->right->parent = s->parent;
+	  s->right->color = BLACK;
+	}
 	// Remove s cases
 	if (s->key < s->parent->key) {
 	  // The key being removed is to the left
-	  s->parent->left = nullptr;
+	  s->parent->left = s->right;
 	}
 	else {
 	  // The key being removed is on the right
-	  s->parent->right = nullptr;
+	  s->parent->right = s->right;
 	}
-	delete s;
+	// Every node above s (including x) now has one less node below it
+	for (Node * a = s->parent; a != nullptr; a = a->parent) {
+	  --a->subtree_size;
+	}
+	node_alloc.deallocate(s);
 	s = nullptr;
   }
   // Now we do the dirty clean up work
@@ -327,17 +468,26 @@ void RBTCollection<K,V>::remove(const K& a_key)
 	// Set root color whenever it exists
     root->color = BLACK;
   }
-  delete sentinel;
+  node_alloc.deallocate(sentinel);
   // Decrementing node count for the removed node ?
   --node_count;
 }
 
-template<typename K, typename V> 
-bool RBTCollection<K,V>::find(const K& search_key, V& the_val) const
+template<typename K, typename V, template<typename> class Alloc>
+bool RBTCollection<K,V,Alloc>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename Q, typename>
+bool RBTCollection<K,V,Alloc>::find(const Q& search_key, V& the_val) const
 {
+  COLLECTION_TIME(OP_FIND);
   Node * curr_ptr = root;
   
   while (curr_ptr != NULL) {
+    COLLECTION_COUNT(NODES_VISITED, 1);
     // Search down a path in the binary tree to find the node
 	if (curr_ptr->key == search_key) {
       // Key has been located
@@ -357,42 +507,186 @@ bool RBTCollection<K,V>::find(const K& search_key, V& the_val) const
   return false;
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
+  COLLECTION_TIME(OP_FIND_RANGE);
   find(root,k1,k2,keys);
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::keys(ArrayList<K>& all_keys) const
 {
   keys(root,all_keys);
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::sort(ArrayList<K>& all_keys_sorted) const
 {
+  COLLECTION_TIME(OP_SORT);
   keys(all_keys_sorted);
 }
 
-template<typename K, typename V> 
-size_t RBTCollection<K,V>::size() const
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::size() const
 {
   return node_count;
 }
 
-template<typename K, typename V> 
-size_t RBTCollection<K,V>::height() const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::add_batch(const K* keys, const V* vals, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    add_impl(keys[i], vals[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::find_batch(const K* keys, size_t n, V* vals, bool* found) const
+{
+  return tree_find_batch(root, keys, n, vals, found);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::remove_batch(const K* keys, size_t n)
+{
+  // Each remove restructures the tree the next one searches, so these
+  // run one at a time (the qualified call skips the virtual dispatch)
+  for (size_t i = 0; i < n; ++i) {
+    RBTCollection<K,V,Alloc>::remove(keys[i]);
+  }
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+void RBTCollection<K,V,Alloc>::scan(const K& k1, const K& k2, F&& visit) const
+{
+  scan(root, k1, k2, visit);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+template<typename F>
+bool RBTCollection<K,V,Alloc>::scan(const Node* subtree_root, const K& k1, const K& k2, F& visit) const
+{
+  if (subtree_root == nullptr) {
+    return true;
+  }
+  // Smaller keys first, then this one, then larger keys, skipping any
+  // subtree that lies outside the range
+  if (k1 < subtree_root->key && !scan(subtree_root->left, k1, k2, visit)) {
+    return false;
+  }
+  if (!(subtree_root->key < k1) && !(k2 < subtree_root->key) &&
+      !visit(subtree_root->key, subtree_root->value)) {
+    return false;
+  }
+  if (subtree_root->key < k2) {
+    return scan(subtree_root->right, k1, k2, visit);
+  }
+  return true;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> RBTCollection<K,V,Alloc>::begin() const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> RBTCollection<K,V,Alloc>::lower_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, false));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+CollectionIterator<K,V> RBTCollection<K,V,Alloc>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new TreeCursor<K,V,Node>(root, k, true));
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::height() const
 {
   return height(root); 
 }
 
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::rank(const K& a_key) const
+{
+  return rank(a_key, false);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+bool RBTCollection<K,V,Alloc>::select(size_t i, K& the_key) const
+{
+  Node * curr_ptr = root;
+  while (curr_ptr != nullptr) {
+    // The left subtree holds the smallest keys, so skip over it (and
+    // this node) when i is past them
+    size_t left_size = subtree_size(curr_ptr->left);
+    if (i < left_size) {
+      curr_ptr = curr_ptr->left;
+    }
+    else if (i == left_size) {
+      the_key = curr_ptr->key;
+      return true;
+    }
+    else {
+      i -= left_size + 1;
+      curr_ptr = curr_ptr->right;
+    }
+  }
+  // Only reached when i >= size()
+  return false;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::count(const K& k1, const K& k2) const
+{
+  if (k2 < k1) {
+    return 0;
+  }
+  // keys <= k2 minus the keys < k1
+  return rank(k2, true) - rank(k1, false);
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::bulk_load(const ArrayList<std::pair<K,V>>& kv_pairs)
+{
+  clear();
+  size_t n = 0;
+  std::pair<K,V>* items = sorted_unique_pairs(kv_pairs, n);
+  // Splitting at the middle leaves every empty subtree on one of the
+  // last two levels. Coloring the deepest level red (when there is more
+  // than one level) gives every path the same number of black nodes.
+  size_t levels = 0;
+  for (size_t remaining = n; remaining > 0; remaining /= 2) {
+    ++levels;
+  }
+  root = build(items, 0, n, 1, levels > 1 ? levels : 0, nullptr);
+  node_count = n;
+  delete [] items;
+}
+
 //------------------------------------
 // Recursive Functions:
 //------------------------------------
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::make_empty(Node* subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::clear()
+{
+  if (!Alloc<Node>::BULK_RELEASE || !std::is_trivially_destructible<Node>::value) {
+    // Each node has to be visited to run its destructor
+    make_empty(root);
+  }
+  // A pool frees all of its slabs at once here
+  node_alloc.release();
+  root = nullptr;
+  node_count = 0;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::make_empty(Node* subtree_root)
 {
  if (!subtree_root) {
     // BASE CASE: leaf nodes hit
@@ -402,11 +696,32 @@ void RBTCollection<K,V>::make_empty(Node* subtree_root)
   make_empty(subtree_root->right); 
   subtree_root->right = nullptr;
   subtree_root->left = nullptr;
-  delete subtree_root;
+  node_alloc.deallocate(subtree_root);
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+template<typename K, typename V, template<typename> class Alloc>
+typename RBTCollection<K,V,Alloc>::Node *
+RBTCollection<K,V,Alloc>::build(const std::pair<K,V>* items, size_t start, size_t end,
+                                size_t depth, size_t red_depth, Node* parent)
+{
+  if (start >= end) {
+    // BASE CASE: empty range
+    return nullptr;
+  }
+  size_t mid = start + (end - start) / 2;
+  Node * newNode = node_alloc.allocate();
+  newNode->key = items[mid].first;
+  newNode->value = items[mid].second;
+  newNode->color = depth == red_depth ? RED : BLACK;
+  newNode->parent = parent;
+  newNode->left = build(items, start, mid, depth + 1, red_depth, newNode);
+  newNode->right = build(items, mid + 1, end, depth + 1, red_depth, newNode);
+  newNode->subtree_size = end - start;
+  return newNode;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
 {
  if(!rhs_subtree_root) { 
     // BASE CASE: all leaf nodes hit
@@ -414,22 +729,24 @@ void RBTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
   }
   
   if (rhs_subtree_root->left != nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->left->key;
     newNode->value = rhs_subtree_root->left->value;
-	newNode->parent = rhs_subtree_root->left->parent;
+	newNode->parent = lhs_subtree_root;
 	newNode->color = rhs_subtree_root->left->color;
+	newNode->subtree_size = rhs_subtree_root->left->subtree_size;
     newNode->left = nullptr;
     newNode->right = nullptr; 
     lhs_subtree_root->left = newNode;
 	copy(lhs_subtree_root->left,rhs_subtree_root->left);
   }
   if (rhs_subtree_root->right!= nullptr) {
-	Node * newNode = new Node;
+	Node * newNode = node_alloc.allocate();
     newNode->key = rhs_subtree_root->right->key;
     newNode->value = rhs_subtree_root->right->value;
-	newNode->parent = rhs_subtree_root->right->parent;
+	newNode->parent = lhs_subtree_root;
 	newNode->color = rhs_subtree_root->right->color;
+	newNode->subtree_size = rhs_subtree_root->right->subtree_size;
     newNode->left = nullptr;
     newNode->right = nullptr; 
     lhs_subtree_root->right = newNode;
@@ -437,8 +754,8 @@ void RBTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
   }
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   if (!subtree_root) {
     // Empty tree base case for leaf nodes
@@ -458,8 +775,8 @@ void RBTCollection<K,V>::find(const Node* subtree_root, const K& k1, const K& k2
   }
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
 {
   if (!subtree_root) {
     // Base case for the leaf nodes
@@ -470,9 +787,10 @@ void RBTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys)
   keys(subtree_root->right,all_keys);
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::rotate_right(Node* k2)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::rotate_right(Node* k2)
 {
+  COLLECTION_COUNT(ROTATIONS, 1);
   // Placing k1 into the k2 position
   Node * k1 = k2->left;
   // Making the k2 left subtree assigned with the k1 right subtree
@@ -501,6 +819,9 @@ void RBTCollection<K,V>::rotate_right(Node* k2)
   // Making the k1 right subtree now everything from k2
   k1->right = k2;
   k2->parent = k1;
+  // k2 is now below k1, so fix its size first
+  update_size(k2);
+  update_size(k1);
   
   if (k2 == root) {
     // If k2 is the root then we must adjust the root to k1
@@ -508,9 +829,10 @@ void RBTCollection<K,V>::rotate_right(Node* k2)
   }
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::rotate_left(Node* k2)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::rotate_left(Node* k2)
 {
+  COLLECTION_COUNT(ROTATIONS, 1);
   // Same exact process as the right rotation exxept on the opposite side
   Node * k1 = k2->right;
   k2->right = k1->left;
@@ -537,6 +859,8 @@ void RBTCollection<K,V>::rotate_left(Node* k2)
   }
   k1->left = k2;
   k2->parent = k1;
+  update_size(k2);
+  update_size(k1);
   
   if (k2 == root) {
     // Must switch root since k1 is now on a higher level than k2
@@ -544,8 +868,8 @@ void RBTCollection<K,V>::rotate_left(Node* k2)
   }
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::add_rebalance(Node* x)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::add_rebalance(Node* x)
 {
   Node * p = x->parent;
   if (x->right != nullptr && x->left != nullptr) {
@@ -592,8 +916,8 @@ void RBTCollection<K,V>::add_rebalance(Node* x)
   }	
 }
 
-template<typename K, typename V> 
-void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right)
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::remove_rebalance(Node* x, bool going_right)
 {
   // If x is RED we are done
   if (x->color == RED) {
@@ -1123,8 +1447,8 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right)
 }
  
 
-template<typename K, typename V> 
-size_t RBTCollection<K,V>::height(Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::height(Node* subtree_root) const
 {
   size_t left, right;
 
@@ -1138,20 +1462,51 @@ size_t RBTCollection<K,V>::height(Node* subtree_root) const
   }
 }
 
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::subtree_size(const Node* subtree_root)
+{
+  return subtree_root ? subtree_root->subtree_size : 0;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::update_size(Node* subtree_root)
+{
+  subtree_root->subtree_size = subtree_size(subtree_root->left) +
+    subtree_size(subtree_root->right) + 1;
+}
+
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::rank(const K& a_key, bool inclusive) const
+{
+  size_t smaller = 0;
+  Node * curr_ptr = root;
+  while (curr_ptr != nullptr) {
+    if (curr_ptr->key < a_key || (inclusive && curr_ptr->key == a_key)) {
+      // This node and its whole left subtree come before a_key
+      smaller += subtree_size(curr_ptr->left) + 1;
+      curr_ptr = curr_ptr->right;
+    }
+    else {
+      curr_ptr = curr_ptr->left;
+    }
+  }
+  return smaller;
+}
+
 
 //----------------------------------------------------------------------
 // Provided Helper Functions:
 //----------------------------------------------------------------------
 
-template<typename K, typename V>
-bool RBTCollection<K,V>::valid_rbt() const
+template<typename K, typename V, template<typename> class Alloc>
+bool RBTCollection<K,V,Alloc>::valid_rbt() const
 {
   return !root or (root->color == BLACK and valid_rbt(root));
 }
 
 
-template<typename K, typename V>
-bool RBTCollection<K,V>::valid_rbt(Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+bool RBTCollection<K,V,Alloc>::valid_rbt(Node* subtree_root) const
 {
   if (!subtree_root)
     return true;
@@ -1168,8 +1523,8 @@ bool RBTCollection<K,V>::valid_rbt(Node* subtree_root) const
 }
 
 
-template<typename K, typename V>
-size_t RBTCollection<K,V>::black_node_height(Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+size_t RBTCollection<K,V,Alloc>::black_node_height(Node* subtree_root) const
 {
   if (!subtree_root)
     return 1;
@@ -1183,15 +1538,15 @@ size_t RBTCollection<K,V>::black_node_height(Node* subtree_root) const
 }
 
 
-template<typename K, typename V>
-void RBTCollection<K,V>::print() const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::print() const
 {
   print_tree("", root);
 }
 
 
-template<typename K, typename V>
-void RBTCollection<K,V>::print_tree(std::string indent, Node* subtree_root) const
+template<typename K, typename V, template<typename> class Alloc>
+void RBTCollection<K,V,Alloc>::print_tree(std::string indent, Node* subtree_root) const
 {
   if (!subtree_root)
     return;
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------
+// FILE: static_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Compile-time (static) front end to the collections. Code that
+//  works through a Collection<K,V>& pays a virtual call per operation,
+//  which also keeps the compiler from inlining small operations like a
+//  hash table find. Code can instead be templated on the collection
+//  type: is_collection checks (at compile time) that a type implements
+//  the Collection interface, and StaticCollection forwards each call
+//  straight to the concrete type's function with no virtual dispatch.
+//----------------------------------------------------------------------
+
+#ifndef STATIC_COLLECTION_H
+#define STATIC_COLLECTION_H
+
+#include <type_traits>
+#include "array_list.h"
+#include "collection.h"
+
+
+// true when C derives from Collection<C::key_type, C::value_type>
+template<typename C, typename = void>
+struct is_collection : std::false_type {};
+
+template<typename C>
+struct is_collection<C, std::void_t<typename C::key_type, typename C::value_type>>
+  : std::is_base_of<Collection<typename C::key_type, typename C::value_type>, C> {};
+
+
+// Same operations as Collection, bound at compile time. Holds a
+// reference to the collection, so it is cheap to pass by value.
+template<typename C>
+class StaticCollection
+{
+  static_assert(is_collection<C>::value,
+                "StaticCollection needs a type implementing Collection");
+  static_assert(!std::is_abstract<C>::value,
+                "StaticCollection needs a concrete collection type");
+
+public:
+  typedef typename C::key_type key_type;
+  typedef typename C::value_type value_type;
+  typedef key_type K;
+  typedef value_type V;
+
+  explicit StaticCollection(C& a_collection) : collection(a_collection) {}
+
+  // the qualified (C::) calls are never dispatched through the vtable
+  void add(const K& a_key, const V& a_val) { collection.C::add(a_key, a_val); }
+  void add(K&& a_key, V&& a_val) { collection.C::add(std::move(a_key), std::move(a_val)); }
+  void remove(const K& a_key) { collection.C::remove(a_key); }
+  bool find(const K& search_key, V& the_val) const { return collection.C::find(search_key, the_val); }
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const { collection.C::find(k1, k2, keys); }
+  void keys(ArrayList<K>& all_keys) const { collection.C::keys(all_keys); }
+  void sort(ArrayList<K>& all_keys_sorted) const { collection.C::sort(all_keys_sorted); }
+  size_t size() const { return collection.C::size(); }
+  CollectionIterator<K,V> begin() const { return collection.C::begin(); }
+  CollectionIterator<K,V> end() const { return CollectionIterator<K,V>(); }
+  CollectionIterator<K,V> lower_bound(const K& k) const { return collection.C::lower_bound(k); }
+  CollectionIterator<K,V> upper_bound(const K& k) const { return collection.C::upper_bound(k); }
+
+  // the underlying collection (for its type-specific functions)
+  C& get() const { return collection; }
+
+private:
+  C& collection;
+};
+
+
+// make a StaticCollection, deducing the collection type
+template<typename C>
+StaticCollection<C> static_collection(C& a_collection)
+{
+  return StaticCollection<C>(a_collection);
+}
+
+
+#endif
@@ -0,0 +1,559 @@
+//----------------------------------------------------------------------
+// FILE: swiss_table_collection.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Implements an open-addressing hash table in the style of a
+//  "Swiss table". Every slot has a one byte control value holding
+//  either an empty/deleted marker or 7 bits of the key's hash. Slots
+//  are probed a group (16 control bytes) at a time, using SSE2 to
+//  compare all 16 control bytes against the hash in one instruction,
+//  so most lookups touch one control group and one key slot instead
+//  of walking a chain of heap allocated nodes.
+//----------------------------------------------------------------------
+
+#ifndef SWISS_TABLE_COLLECTION_H
+#define SWISS_TABLE_COLLECTION_H
+
+#include <functional>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "array_list.h"
+#include "collection.h"
+#include "radix_sort.h"
+#include "key_hash.h"
+
+
+template<typename K,typename V>
+class SwissTableCollection final : public Collection<K,V>
+{
+public:
+  SwissTableCollection();
+  SwissTableCollection(const SwissTableCollection<K,V>& rhs);
+  SwissTableCollection(SwissTableCollection<K,V>&& rhs);
+  ~SwissTableCollection();
+  SwissTableCollection& operator=(const SwissTableCollection<K,V>& rhs);
+  SwissTableCollection& operator=(SwissTableCollection<K,V>&& rhs);
+
+  void add(const K& a_key, const V& a_val);
+  void add(K&& a_key, V&& a_val);
+  void remove(const K& a_key);
+  bool find(const K& search_key, V& the_val) const;
+  // find using any key type comparable with K (e.g., a string_view or
+  // C string for string keys) without first building a K
+  template<typename Q, typename = typename std::enable_if<HashedLookup<KeyHash<K>,K,Q>::value>::type>
+  bool find(const Q& search_key, V& the_val) const;
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+  void keys(ArrayList<K>& all_keys) const;
+  void sort(ArrayList<K>& all_keys_sorted) const;
+  size_t size() const;
+
+  // "statistics" functions
+
+  // number of slots in the table
+  size_t capacity() const;
+  // fraction of slots holding a key-value pair
+  double load_factor() const;
+  // average number of groups probed to find a stored key
+  double avg_probe_length() const;
+
+  // iteration in slot order (see Collection)
+  CollectionIterator<K,V> begin() const;
+  CollectionIterator<K,V> lower_bound(const K& k) const;
+  CollectionIterator<K,V> upper_bound(const K& k) const;
+
+private:
+  // control byte values (full slots hold the low 7 hash bits, 0..127)
+  static const signed char EMPTY = -128;
+  static const signed char DELETED = -2;
+  // number of control bytes probed at once
+  static const size_t GROUP_WIDTH = 16;
+
+  // control bytes, one per slot
+  signed char* ctrl;
+  // key and value slot arrays (parallel to ctrl)
+  K* slot_keys;
+  V* slot_values;
+  // number of slots (always a multiple of GROUP_WIDTH and a power of two)
+  size_t table_capacity;
+  // number of key-value pairs stored
+  size_t length;
+  // number of DELETED (tombstone) slots
+  size_t deleted;
+
+  KeyHash<K> hash_fun; // K- based hash function object
+
+  // scramble the hash code so both the group index and the 7 bit tag
+  // are well distributed, even for identity hashes (e.g., integers)
+  static uint64_t mix(size_t code);
+  // group to start probing from
+  size_t home_group(uint64_t mixed) const;
+  // 7 bit tag stored in the control byte
+  static signed char tag(uint64_t mixed);
+  // bit mask of the slots in the group whose control byte equals c
+  static unsigned match(const signed char* group, signed char c);
+  // bit mask of the slots in the group that are EMPTY or DELETED
+  static unsigned match_empty_or_deleted(const signed char* group);
+  // index of the lowest set bit in a (non-zero) mask
+  static unsigned lowest_bit(unsigned mask);
+  // returns the slot holding the key, or table_capacity if not found
+  template<typename Q>
+  size_t find_slot(const Q& search_key) const;
+  // returns a free slot along the probe sequence of the mixed hash
+  size_t free_slot(uint64_t mixed) const;
+  // allocate empty arrays for the given capacity
+  void allocate(size_t new_capacity);
+  // release the arrays
+  void release();
+  // grow (or clean out tombstones) and reinsert every pair
+  void resize_and_rehash(size_t new_capacity);
+  // add helper that copies or moves the key and value into a slot
+  template<typename KK, typename VV>
+  void add_impl(KK&& a_key, VV&& a_val);
+
+  // cursor over the full slots
+  class Cursor : public CollectionCursor<K,V> {
+  public:
+    explicit Cursor(const SwissTableCollection<K,V>& a_table)
+      : table(a_table), index(0) { skip_free(); }
+    bool valid() const { return index < table.table_capacity; }
+    const K& key() const { return table.slot_keys[index]; }
+    const V& value() const { return table.slot_values[index]; }
+    void next() { ++index; skip_free(); }
+    CollectionCursor<K,V>* clone() const { return new Cursor(*this); }
+  private:
+    const SwissTableCollection<K,V>& table;
+    size_t index;
+    // move past EMPTY and DELETED slots (full control bytes are >= 0)
+    void skip_free() {
+      while (index < table.table_capacity && table.ctrl[index] < 0) {
+        ++index;
+      }
+    }
+  };
+};
+
+
+template<typename K,typename V>
+SwissTableCollection<K,V>::SwissTableCollection()
+  : ctrl(nullptr), slot_keys(nullptr), slot_values(nullptr),
+    table_capacity(0), length(0), deleted(0)
+{
+  allocate(GROUP_WIDTH);
+}
+
+template<typename K,typename V>
+SwissTableCollection<K,V>::SwissTableCollection(const SwissTableCollection<K,V>& rhs)
+  : ctrl(nullptr), slot_keys(nullptr), slot_values(nullptr),
+    table_capacity(0), length(0), deleted(0)
+{
+  // Defer to the assignment operator
+  *this = rhs;
+}
+
+template<typename K,typename V>
+SwissTableCollection<K,V>::SwissTableCollection(SwissTableCollection<K,V>&& rhs)
+  : SwissTableCollection()
+{
+  // Defer to the move assignment operator
+  *this = std::move(rhs);
+}
+
+template<typename K,typename V>
+SwissTableCollection<K,V>::~SwissTableCollection()
+{
+  release();
+}
+
+template<typename K,typename V>
+SwissTableCollection<K,V>& SwissTableCollection<K,V>::operator=(const SwissTableCollection<K,V>& rhs)
+{
+  if (this != &rhs) { // protects against self-assignment case
+    release();
+    allocate(rhs.table_capacity);
+    // Control bytes and slots can be copied over position by position
+    // since both tables have the same capacity
+    for (size_t i = 0; i < table_capacity; ++i) {
+      ctrl[i] = rhs.ctrl[i];
+      if (ctrl[i] >= 0) {
+        slot_keys[i] = rhs.slot_keys[i];
+        slot_values[i] = rhs.slot_values[i];
+      }
+    }
+    length = rhs.length;
+    deleted = rhs.deleted;
+  }
+  return *this;
+}
+
+template<typename K,typename V>
+SwissTableCollection<K,V>& SwissTableCollection<K,V>::operator=(SwissTableCollection<K,V>&& rhs)
+{
+  if (this != &rhs) { // protects against self-assignment case
+    // Trade arrays with rhs, which then frees ours
+    std::swap(ctrl, rhs.ctrl);
+    std::swap(slot_keys, rhs.slot_keys);
+    std::swap(slot_values, rhs.slot_values);
+    std::swap(table_capacity, rhs.table_capacity);
+    std::swap(length, rhs.length);
+    std::swap(deleted, rhs.deleted);
+  }
+  return *this;
+}
+
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::add(const K& a_key, const V& a_val)
+{
+  add_impl(a_key, a_val);
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::add(K&& a_key, V&& a_val)
+{
+  add_impl(std::move(a_key), std::move(a_val));
+}
+
+template<typename K,typename V>
+template<typename KK, typename VV>
+void SwissTableCollection<K,V>::add_impl(KK&& a_key, VV&& a_val)
+{
+  COLLECTION_TIME(OP_ADD);
+  // Keep at most 7/8 of the slots in use (counting tombstones) so
+  // every probe sequence is guaranteed to reach an EMPTY slot
+  if ((length + deleted + 1) * 8 > table_capacity * 7) {
+    if (length * 16 < table_capacity * 7) {
+      // Mostly tombstones, so clean them out without growing
+      resize_and_rehash(table_capacity);
+    }
+    else {
+      resize_and_rehash(table_capacity * 2);
+    }
+  }
+  uint64_t mixed = mix(hash_fun(a_key));
+  size_t index = free_slot(mixed);
+  if (ctrl[index] == DELETED) {
+    // Reusing a tombstone
+    --deleted;
+  }
+  ctrl[index] = tag(mixed);
+  slot_keys[index] = std::forward<KK>(a_key);
+  slot_values[index] = std::forward<VV>(a_val);
+  ++length;
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::remove(const K& a_key)
+{
+  COLLECTION_TIME(OP_REMOVE);
+  size_t index = find_slot(a_key);
+  if (index == table_capacity) {
+    // Key not found so do nothing
+    return;
+  }
+  const signed char* group = ctrl + (index - index % GROUP_WIDTH);
+  if (match(group, EMPTY)) {
+    // The group was never full, so no probe sequence continued past
+    // it and the slot can go straight back to EMPTY
+    ctrl[index] = EMPTY;
+  }
+  else {
+    // Later keys may have probed past this group, leave a tombstone
+    ctrl[index] = DELETED;
+    ++deleted;
+  }
+  // Release anything the key and value own
+  slot_keys[index] = K();
+  slot_values[index] = V();
+  --length;
+}
+
+template<typename K,typename V>
+bool SwissTableCollection<K,V>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+template<typename K,typename V>
+template<typename Q, typename>
+bool SwissTableCollection<K,V>::find(const Q& search_key, V& the_val) const
+{
+  COLLECTION_TIME(OP_FIND);
+  size_t index = find_slot(search_key);
+  if (index == table_capacity) {
+    return false;
+  }
+  the_val = slot_values[index];
+  return true;
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  COLLECTION_TIME(OP_FIND_RANGE);
+  for (size_t i = 0; i < table_capacity; ++i) {
+    if (ctrl[i] >= 0 && slot_keys[i] >= k1 && slot_keys[i] <= k2) {
+      keys.add(slot_keys[i]);
+    }
+  }
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::keys(ArrayList<K>& all_keys) const
+{
+  for (size_t i = 0; i < table_capacity; ++i) {
+    if (ctrl[i] >= 0) {
+      all_keys.add(slot_keys[i]);
+    }
+  }
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  COLLECTION_TIME(OP_SORT);
+  keys(all_keys_sorted);
+  sort_keys(all_keys_sorted);
+}
+
+template<typename K,typename V>
+size_t SwissTableCollection<K,V>::size() const
+{
+  return length;
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> SwissTableCollection<K,V>::begin() const
+{
+  return CollectionIterator<K,V>(new Cursor(*this));
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> SwissTableCollection<K,V>::lower_bound(const K& k) const
+{
+  // Unordered, so every pair has to be checked against the bound
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, false));
+}
+
+template<typename K,typename V>
+CollectionIterator<K,V> SwissTableCollection<K,V>::upper_bound(const K& k) const
+{
+  return CollectionIterator<K,V>(new BoundedCursor<K,V>(new Cursor(*this), k, true));
+}
+
+template<typename K,typename V>
+size_t SwissTableCollection<K,V>::capacity() const
+{
+  return table_capacity;
+}
+
+template<typename K,typename V>
+double SwissTableCollection<K,V>::load_factor() const
+{
+  return static_cast<double>(length) / table_capacity;
+}
+
+template<typename K,typename V>
+double SwissTableCollection<K,V>::avg_probe_length() const
+{
+  if (length == 0) {
+    return 0;
+  }
+  size_t num_groups = table_capacity / GROUP_WIDTH;
+  size_t total = 0;
+  for (size_t i = 0; i < table_capacity; ++i) {
+    if (ctrl[i] < 0) {
+      continue;
+    }
+    // Count the groups visited before reaching the slot's group
+    uint64_t mixed = mix(hash_fun(slot_keys[i]));
+    size_t g = home_group(mixed);
+    size_t probes = 1;
+    for (size_t step = 1; g != i / GROUP_WIDTH; ++step) {
+      g = (g + step) & (num_groups - 1);
+      ++probes;
+    }
+    total += probes;
+  }
+  return static_cast<double>(total) / length;
+}
+
+
+// HELPER FUNCTIONS
+
+template<typename K,typename V>
+uint64_t SwissTableCollection<K,V>::mix(size_t code)
+{
+  // Fibonacci hashing: multiply by 2^64 / golden ratio
+  uint64_t mixed = static_cast<uint64_t>(code) * 0x9E3779B97F4A7C15ULL;
+  return mixed ^ (mixed >> 32);
+}
+
+template<typename K,typename V>
+size_t SwissTableCollection<K,V>::home_group(uint64_t mixed) const
+{
+  // The tag uses the low 7 bits, so index groups with the rest
+  return static_cast<size_t>(mixed >> 7) & (table_capacity / GROUP_WIDTH - 1);
+}
+
+template<typename K,typename V>
+signed char SwissTableCollection<K,V>::tag(uint64_t mixed)
+{
+  return static_cast<signed char>(mixed & 0x7F);
+}
+
+template<typename K,typename V>
+unsigned SwissTableCollection<K,V>::match(const signed char* group, signed char c)
+{
+#ifdef __SSE2__
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(c), bytes)));
+#else
+  unsigned mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+    if (group[i] == c) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+template<typename K,typename V>
+unsigned SwissTableCollection<K,V>::match_empty_or_deleted(const signed char* group)
+{
+#ifdef __SSE2__
+  // EMPTY and DELETED are the only control bytes with the sign bit set
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<unsigned>(_mm_movemask_epi8(bytes));
+#else
+  unsigned mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+    if (group[i] < 0) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+template<typename K,typename V>
+unsigned SwissTableCollection<K,V>::lowest_bit(unsigned mask)
+{
+#ifdef __GNUC__
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+  unsigned bit = 0;
+  while (!(mask & 1u)) {
+    mask >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+template<typename K,typename V>
+template<typename Q>
+size_t SwissTableCollection<K,V>::find_slot(const Q& search_key) const
+{
+  uint64_t mixed = mix(hash_fun(search_key));
+  signed char t = tag(mixed);
+  size_t group_mask = table_capacity / GROUP_WIDTH - 1;
+  size_t g = home_group(mixed);
+  // Triangular probing visits every group once when the group count
+  // is a power of two
+  for (size_t step = 1; step <= group_mask + 1; ++step) {
+    const signed char* group = ctrl + g * GROUP_WIDTH;
+    unsigned candidates = match(group, t);
+    while (candidates) {
+      unsigned i = lowest_bit(candidates);
+      COLLECTION_COUNT(NODES_VISITED, 1);
+      if (slot_keys[g * GROUP_WIDTH + i] == search_key) {
+        // Found the search key!
+        return g * GROUP_WIDTH + i;
+      }
+      candidates &= candidates - 1;
+    }
+    if (match(group, EMPTY)) {
+      // An EMPTY slot ends every probe sequence passing through here
+      return table_capacity;
+    }
+    g = (g + step) & group_mask;
+  }
+  return table_capacity;
+}
+
+template<typename K,typename V>
+size_t SwissTableCollection<K,V>::free_slot(uint64_t mixed) const
+{
+  size_t group_mask = table_capacity / GROUP_WIDTH - 1;
+  size_t g = home_group(mixed);
+  for (size_t step = 1; ; ++step) {
+    unsigned mask = match_empty_or_deleted(ctrl + g * GROUP_WIDTH);
+    if (mask) {
+      return g * GROUP_WIDTH + lowest_bit(mask);
+    }
+    g = (g + step) & group_mask;
+  }
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::allocate(size_t new_capacity)
+{
+  table_capacity = new_capacity;
+  ctrl = new signed char[table_capacity];
+  slot_keys = new K[table_capacity];
+  slot_values = new V[table_capacity];
+  for (size_t i = 0; i < table_capacity; ++i) {
+    ctrl[i] = EMPTY;
+  }
+  length = 0;
+  deleted = 0;
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::release()
+{
+  delete [] ctrl;
+  delete [] slot_keys;
+  delete [] slot_values;
+  ctrl = nullptr;
+  slot_keys = nullptr;
+  slot_values = nullptr;
+  table_capacity = 0;
+  length = 0;
+  deleted = 0;
+}
+
+template<typename K,typename V>
+void SwissTableCollection<K,V>::resize_and_rehash(size_t new_capacity)
+{
+  COLLECTION_COUNT(REHASHES, 1);
+  signed char* old_ctrl = ctrl;
+  K* old_keys = slot_keys;
+  V* old_values = slot_values;
+  size_t old_capacity = table_capacity;
+
+  allocate(new_capacity);
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] < 0) {
+      continue;
+    }
+    // No duplicates or tombstones in the new table, so the first free
+    // slot along the probe sequence is where the pair belongs
+    uint64_t mixed = mix(hash_fun(old_keys[i]));
+    size_t index = free_slot(mixed);
+    ctrl[index] = tag(mixed);
+    slot_keys[index] = std::move(old_keys[i]);
+    slot_values[index] = std::move(old_values[i]);
+    ++length;
+  }
+  delete [] old_ctrl;
+  delete [] old_keys;
+  delete [] old_values;
+}
+
+
+#endif
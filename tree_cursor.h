@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------
+// FILE: tree_cursor.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: In-order cursor shared by the binary search tree collections.
+//  The cursor keeps the path of nodes still to be visited on a stack
+//  (each node whose left subtree is being walked), so moving to the
+//  next key is O(1) amortized and no parent pointers are needed.
+//----------------------------------------------------------------------
+
+#ifndef TREE_CURSOR_H
+#define TREE_CURSOR_H
+
+#include "array_list.h"
+#include "collection.h"
+
+
+// Node needs key, value, left, and right members
+template<typename K, typename V, typename Node>
+class TreeCursor : public CollectionCursor<K,V>
+{
+public:
+  // positioned at the smallest key
+  explicit TreeCursor(const Node* root);
+  // positioned at the first key >= bound (> bound when strict)
+  TreeCursor(const Node* root, const K& bound, bool strict);
+
+  bool valid() const;
+  const K& key() const;
+  const V& value() const;
+  void next();
+  CollectionCursor<K,V>* clone() const;
+
+protected:
+  // nodes still to visit, the current node on top
+  ArrayList<const Node*> path;
+
+  // push a node and then its chain of left children
+  void push_left(const Node* subtree_root);
+};
+
+
+template<typename K, typename V, typename Node>
+TreeCursor<K,V,Node>::TreeCursor(const Node* root)
+{
+  push_left(root);
+}
+
+template<typename K, typename V, typename Node>
+TreeCursor<K,V,Node>::TreeCursor(const Node* root, const K& bound, bool strict)
+{
+  // Every node we go left at is inside the bound and comes after the
+  // nodes below it, so it stays on the path
+  const Node* ptr = root;
+  while (ptr != nullptr) {
+    if (strict ? bound < ptr->key : !(ptr->key < bound)) {
+      path.add(ptr);
+      ptr = ptr->left;
+    }
+    else {
+      ptr = ptr->right;
+    }
+  }
+}
+
+template<typename K, typename V, typename Node>
+bool TreeCursor<K,V,Node>::valid() const
+{
+  return path.size() > 0;
+}
+
+template<typename K, typename V, typename Node>
+const K& TreeCursor<K,V,Node>::key() const
+{
+  return path[path.size() - 1]->key;
+}
+
+template<typename K, typename V, typename Node>
+const V& TreeCursor<K,V,Node>::value() const
+{
+  return path[path.size() - 1]->value;
+}
+
+template<typename K, typename V, typename Node>
+void TreeCursor<K,V,Node>::next()
+{
+  const Node* curr = path[path.size() - 1];
+  path.remove(path.size() - 1);
+  // The successor is the leftmost node of the right subtree, or the
+  // nearest ancestor already on the path
+  push_left(curr->right);
+}
+
+template<typename K, typename V, typename Node>
+CollectionCursor<K,V>* TreeCursor<K,V,Node>::clone() const
+{
+  return new TreeCursor<K,V,Node>(*this);
+}
+
+template<typename K, typename V, typename Node>
+void TreeCursor<K,V,Node>::push_left(const Node* subtree_root)
+{
+  while (subtree_root != nullptr) {
+    path.add(subtree_root);
+    subtree_root = subtree_root->left;
+  }
+}
+
+
+#endif
@@ -0,0 +1,377 @@
+//----------------------------------------------------------------------
+// FILE: workload.h
+// NAME: Matthew Moore
+// DATE: October, 2026
+// DESC: Workload generator for the performance tests, after the Yahoo
+//  Cloud Serving Benchmark (YCSB). A workload loads a number of
+//  records (keys inserted in sequential, reverse, or random order),
+//  then runs a stream of reads, updates, inserts, and scans in a given
+//  mix. The records operated on follow a uniform, Zipfian (a few keys
+//  get most of the traffic), hotspot (a fixed fraction of the keys gets
+//  a fixed fraction of the traffic), or latest (recent inserts are the
+//  most popular) distribution. Every key and operation is generated up
+//  front from a seed, so the same workload can drive each collection
+//  type, and running it records the throughput and a latency histogram
+//  per kind of operation.
+//----------------------------------------------------------------------
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <chrono>
+#include <cmath>
+#include <stdint.h>
+#include <string>
+#include "array_list.h"
+#include "instrumentation.h"
+
+
+// the kinds of operations: a find, a remove and re-add with a new
+// value, an add of a new key, and a find range
+enum WorkloadOperation {
+  WORKLOAD_READ, WORKLOAD_UPDATE, WORKLOAD_INSERT, WORKLOAD_SCAN, WORKLOAD_OPERATION_COUNT
+};
+
+// how the records operated on are picked
+enum RequestDistribution { UNIFORM, ZIPFIAN, HOTSPOT, LATEST };
+
+// the order keys are inserted in (by key order)
+enum InsertOrder { SEQUENTIAL, REVERSE, RANDOM };
+
+
+struct WorkloadSpec
+{
+  // records added before the operations run, and operations run
+  size_t record_count = 100000;
+  size_t operation_count = 100000;
+  // fractions of the operations of each kind (summing to 1)
+  double read_fraction = 1;
+  double update_fraction = 0;
+  double insert_fraction = 0;
+  double scan_fraction = 0;
+  RequestDistribution distribution = UNIFORM;
+  InsertOrder insert_order = RANDOM;
+  // letters per key (made longer if too short to give every key its
+  // own string)
+  size_t key_length = 8;
+  // scans cover 1 to max_scan_length keys (uniformly)
+  size_t max_scan_length = 100;
+  // Zipfian skew (YCSB uses 0.99)
+  double zipf_theta = 0.99;
+  // hotspot: hot_op_fraction of the operations go to the first
+  // hot_set_fraction of the records
+  double hot_set_fraction = 0.2;
+  double hot_op_fraction = 0.8;
+  uint64_t seed = 1;
+};
+
+// the YCSB core workloads: A is 50/50 reads and updates, B is 95/5
+// reads and updates, C is read only, D is 95/5 reads and inserts of
+// the latest records, and E is 95/5 short scans and inserts
+WorkloadSpec ycsb_workload(char name, RequestDistribution distribution = ZIPFIAN);
+
+
+// one generated operation, with keys given by their position in key
+// order (scans cover keys key to last_key)
+struct WorkloadOp
+{
+  WorkloadOperation op;
+  size_t key;
+  size_t last_key;
+
+  // (ArrayList elements must be ordered) by key
+  bool operator<(const WorkloadOp& rhs) const { return key < rhs.key; }
+};
+
+
+// per kind and overall latency (in nanoseconds), with the throughput
+struct WorkloadResult
+{
+  LatencyHistogram latency[WORKLOAD_OPERATION_COUNT];
+  LatencyHistogram overall;
+  double seconds = 0;
+  double ops_per_sec = 0;
+};
+
+
+// splitmix64, so workloads are the same on every platform
+class WorkloadRandom
+{
+public:
+  explicit WorkloadRandom(uint64_t seed) : state(seed) {}
+  uint64_t next();
+  // uniform in [0, 1)
+  double next_double() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+  // uniform in [0, n)
+  size_t next_below(size_t n) { return static_cast<size_t>(next_double() * n); }
+
+private:
+  uint64_t state;
+};
+
+
+// Zipfian ranks in [0, n), rank 0 the most popular (Gray et al.,
+// "Quickly Generating Billion-Record Synthetic Databases", as in YCSB).
+// The item count can grow, which costs O(new items).
+class ZipfianGenerator
+{
+public:
+  ZipfianGenerator(size_t n, double theta);
+  size_t next(WorkloadRandom& random) const;
+  // grow the item count to n (n can only increase)
+  void grow(size_t n);
+
+private:
+  size_t items;
+  double theta;
+  double alpha;
+  double zeta2;
+  double zetan;
+  double eta;
+};
+
+
+class Workload
+{
+public:
+  explicit Workload(const WorkloadSpec& a_spec);
+
+  const WorkloadSpec& spec() const { return workload_spec; }
+  // the key at a position in key order
+  const std::string& key(size_t position) const { return keys[position]; }
+  // position (in key order) of the ith key inserted, loads first
+  size_t inserted(size_t i) const { return insert_positions[i]; }
+  const ArrayList<WorkloadOp>& operations() const { return ops; }
+
+  // add the records (the value of each is its insert number), then
+  // run the operations, timing each one
+  template<typename C>
+  void load(C& collection) const;
+  template<typename C>
+  void run(C& collection, WorkloadResult& result) const;
+
+private:
+  WorkloadSpec workload_spec;
+  ArrayList<std::string> keys;
+  ArrayList<size_t> insert_positions;
+  ArrayList<WorkloadOp> ops;
+
+  // the number of an existing record (in insert order) to operate on
+  // when count records exist
+  size_t pick(WorkloadRandom& random, ZipfianGenerator& zipf, size_t count) const;
+};
+
+
+inline WorkloadSpec ycsb_workload(char name, RequestDistribution distribution)
+{
+  WorkloadSpec spec;
+  spec.distribution = distribution;
+  if (name == 'A') {
+    spec.read_fraction = 0.5;
+    spec.update_fraction = 0.5;
+  }
+  else if (name == 'B') {
+    spec.read_fraction = 0.95;
+    spec.update_fraction = 0.05;
+  }
+  else if (name == 'D') {
+    spec.read_fraction = 0.95;
+    spec.insert_fraction = 0.05;
+    spec.distribution = LATEST;
+  }
+  else if (name == 'E') {
+    spec.read_fraction = 0;
+    spec.scan_fraction = 0.95;
+    spec.insert_fraction = 0.05;
+  }
+  // otherwise C, all reads
+  return spec;
+}
+
+
+inline uint64_t WorkloadRandom::next()
+{
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+
+inline ZipfianGenerator::ZipfianGenerator(size_t n, double a_theta)
+  : items(0), theta(a_theta), alpha(1.0 / (1.0 - a_theta)),
+    zeta2(1.0 + std::pow(0.5, a_theta)), zetan(0), eta(0)
+{
+  grow(n);
+}
+
+inline void ZipfianGenerator::grow(size_t n)
+{
+  for (size_t i = items + 1; i <= n; ++i) {
+    zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+  }
+  items = n;
+  eta = (1.0 - std::pow(2.0 / items, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+}
+
+inline size_t ZipfianGenerator::next(WorkloadRandom& random) const
+{
+  double u = random.next_double();
+  double uz = u * zetan;
+  if (uz < 1.0) {
+    return 0;
+  }
+  if (uz < zeta2) {
+    return 1;
+  }
+  size_t rank = static_cast<size_t>(items * std::pow(eta * u - eta + 1, alpha));
+  return rank < items ? rank : items - 1;
+}
+
+
+inline Workload::Workload(const WorkloadSpec& a_spec)
+  : workload_spec(a_spec)
+{
+  WorkloadSpec& s = workload_spec;
+  WorkloadRandom random(s.seed);
+  // Generate the operation kinds first, to know how many keys there are
+  ArrayList<WorkloadOperation> kinds(s.operation_count);
+  size_t inserts = 0;
+  for (size_t i = 0; i < s.operation_count; ++i) {
+    double u = random.next_double();
+    WorkloadOperation kind = WORKLOAD_READ;
+    if (s.record_count + inserts == 0) {
+      // nothing to read yet
+      kind = WORKLOAD_INSERT;
+    }
+    else if (u >= s.read_fraction) {
+      u -= s.read_fraction;
+      kind = u < s.update_fraction ? WORKLOAD_UPDATE :
+             u < s.update_fraction + s.insert_fraction ? WORKLOAD_INSERT : WORKLOAD_SCAN;
+    }
+    kinds.add(kind);
+    if (kind == WORKLOAD_INSERT) {
+      ++inserts;
+    }
+  }
+  // Keys in key order spell their position in base 26
+  size_t total = s.record_count + inserts;
+  size_t min_length = 1;
+  for (size_t n = 26; n < total; n *= 26) {
+    ++min_length;
+  }
+  if (s.key_length < min_length) {
+    s.key_length = min_length;
+  }
+  keys = ArrayList<std::string>(total);
+  for (size_t i = 0; i < total; ++i) {
+    std::string key(s.key_length, 'A');
+    size_t n = i;
+    for (size_t j = s.key_length; j > 0 && n > 0; --j, n /= 26) {
+      key[j - 1] = static_cast<char>('A' + n % 26);
+    }
+    keys.add(key);
+  }
+  insert_positions = ArrayList<size_t>(total);
+  for (size_t i = 0; i < total; ++i) {
+    insert_positions.add(s.insert_order == REVERSE ? total - 1 - i : i);
+  }
+  if (s.insert_order == RANDOM && total > 1) {
+    // Fisher-Yates shuffle
+    for (size_t i = total - 1; i > 0; --i) {
+      std::swap(insert_positions[i], insert_positions[random.next_below(i + 1)]);
+    }
+  }
+  // Then the keys of each operation
+  ZipfianGenerator zipf(s.record_count > 0 ? s.record_count : 1, s.zipf_theta);
+  size_t count = s.record_count;
+  ops = ArrayList<WorkloadOp>(s.operation_count);
+  for (size_t i = 0; i < s.operation_count; ++i) {
+    WorkloadOp op;
+    op.op = kinds[i];
+    if (op.op == WORKLOAD_INSERT) {
+      op.key = insert_positions[count++];
+      if (s.distribution == ZIPFIAN || s.distribution == LATEST) {
+        zipf.grow(count);
+      }
+    }
+    else {
+      op.key = insert_positions[pick(random, zipf, count)];
+    }
+    op.last_key = op.key;
+    if (op.op == WORKLOAD_SCAN) {
+      op.last_key = op.key + random.next_below(s.max_scan_length);
+      if (op.last_key >= total) {
+        op.last_key = total - 1;
+      }
+    }
+    ops.add(op);
+  }
+}
+
+inline size_t Workload::pick(WorkloadRandom& random, ZipfianGenerator& zipf, size_t count) const
+{
+  const WorkloadSpec& s = workload_spec;
+  if (s.distribution == ZIPFIAN) {
+    return zipf.next(random);
+  }
+  if (s.distribution == LATEST) {
+    return count - 1 - zipf.next(random);
+  }
+  if (s.distribution == HOTSPOT) {
+    size_t hot = static_cast<size_t>(count * s.hot_set_fraction);
+    if (hot == 0) {
+      hot = 1;
+    }
+    if (random.next_double() < s.hot_op_fraction || hot == count) {
+      return random.next_below(hot);
+    }
+    return hot + random.next_below(count - hot);
+  }
+  return random.next_below(count);
+}
+
+template<typename C>
+void Workload::load(C& collection) const
+{
+  for (size_t i = 0; i < workload_spec.record_count; ++i) {
+    collection.add(keys[insert_positions[i]], static_cast<int>(i));
+  }
+}
+
+template<typename C>
+void Workload::run(C& collection, WorkloadResult& result) const
+{
+  using namespace std::chrono;
+  ArrayList<std::string> scanned;
+  int val = 0;
+  size_t next_insert = workload_spec.record_count;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const WorkloadOp& op = ops[i];
+    const std::string& key = keys[op.key];
+    auto op_start = steady_clock::now();
+    if (op.op == WORKLOAD_READ) {
+      collection.find(key, val);
+    }
+    else if (op.op == WORKLOAD_UPDATE) {
+      collection.remove(key);
+      collection.add(key, static_cast<int>(i));
+    }
+    else if (op.op == WORKLOAD_INSERT) {
+      collection.add(key, static_cast<int>(next_insert++));
+    }
+    else {
+      scanned = ArrayList<std::string>();
+      collection.find(key, keys[op.last_key], scanned);
+    }
+    uint64_t ns = duration_cast<nanoseconds>(steady_clock::now() - op_start).count();
+    result.latency[op.op].record(ns);
+    result.overall.record(ns);
+  }
+  result.seconds = duration<double>(steady_clock::now() - start).count();
+  result.ops_per_sec = result.seconds > 0 ? ops.size() / result.seconds : 0;
+}
+
+
+#endif